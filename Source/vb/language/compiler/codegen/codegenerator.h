@@ -115,6 +115,18 @@ struct CODE_ADDRESS
     unsigned int        uOffset;            // offset into code block
 };
 
+//-------------------------------------------------------------------------------------------------
+//
+// An instruction decoded from the code buffer of a block
+//
+struct IL_INSTRUCTION
+{
+    unsigned int        uStart;             // offset of the instruction in the code buffer
+    unsigned int        uEnd;               // offset of the instruction that follows
+    OPCODE              opcode;             // short and macro forms are decoded as the general form
+    unsigned int        uIndex;             // local or argument index, for CEE_LDLOC, CEE_STLOC, CEE_LDARG and CEE_STARG
+};
+
 //-------------------------------------------------------------------------------------------------
 //
 // A code address in a list of locations for the Resume table
@@ -415,6 +427,7 @@ private:
     static const signed           s_OpcodeStkEffPop[];
     static const unsigned char    s_OpcodeLen[];
     static const unsigned char    s_OpcodeCode[];
+    static const unsigned char    s_OpcodeOperandSize[];
 
     static const unsigned short   s_SxopComp[];
     static const unsigned short   s_SxopCompUnsigned[];
@@ -523,7 +536,12 @@ private:
     bool WithinFunction();
     void CollateSwitchTable(CODE_BLOCK * pcblkSwitch);
     void OptimizeGeneratedIL();
+    void ThreadBranches();
+    bool CanThreadBranchThrough(CODE_BLOCK *pcblk);
     void OptimizeBranches();
+    void RemoveRedundantInstructions();
+    void RemoveRedundantInstructions(CODE_BLOCK *pcblk, const OPCODE *pOpcodeMap, _In_count_(cAddresses) CODE_ADDRESS **ppAddresses, unsigned cAddresses, IL_INSTRUCTION *pInstructions);
+    bool DecodeInstruction(CODE_BLOCK *pcblk, unsigned uOffset, const OPCODE *pOpcodeMap, _Out_ IL_INSTRUCTION *pInstruction);
     void MarkLiveBlocks(CODE_BLOCK *pcblk);
     unsigned long CalculateBlockAddresses();
     void EmitEHClauses();
@@ -628,6 +646,11 @@ private:
     void GenerateCatch(ILTree::CatchBlock *ptreeCatch);
     void GenerateFinally(ILTree::PILNode ptree);
     void GenerateSelect(ILTree::PILNode ptree);
+    CODE_BLOCK *CreateSelectCaseBlocks(ILTree::SelectBlock *Select);
+    void GenerateSelectHashDispatch(ILTree::SelectBlock *Select);
+    void GenerateSelectSparseDispatch(ILTree::SelectBlock *Select);
+    void GenerateSelectSparseSearch(ILTree::SelectBlock *Select, unsigned *Clusters, unsigned FirstCluster, unsigned ClusterCount, CODE_BLOCK **CaseBlocks, CODE_BLOCK *pcblkDefault);
+    void GenerateSelectSparseCluster(ILTree::SelectBlock *Select, unsigned FirstRange, unsigned RangeCount, CODE_BLOCK **CaseBlocks, CODE_BLOCK *pcblkDefault);
     void GenerateEndSelect(ILTree::PILNode ptree);
     void GenerateCase(ILTree::PILNode ptree);
     void GenerateResume(ILTree::PILNode ptree);
@@ -310,6 +310,53 @@ const unsigned char CodeGenerator::s_OpcodeCode[] =
     #undef OPDEF
 };
 
+// The size of the operand of a switch depends on its number of targets.
+// Code buffers with a switch in them aren't decoded.
+const unsigned char VariableOperandSize = 0xFF;
+
+#define InlineNone          0
+#define ShortInlineVar      1
+#define ShortInlineI        1
+#define ShortInlineBrTarget 1
+#define InlineVar           2
+#define InlineI             4
+#define ShortInlineR        4
+#define InlineBrTarget      4
+#define InlineMethod        4
+#define InlineField         4
+#define InlineType          4
+#define InlineString        4
+#define InlineSig           4
+#define InlineTok           4
+#define InlineI8            8
+#define InlineR             8
+#define InlineSwitch        VariableOperandSize
+
+const unsigned char CodeGenerator::s_OpcodeOperandSize[] =
+{
+    #define OPDEF(c,nam,pop,push,oper,opcod,len,b1,b2,flow) (oper),
+    #include "opcode.def"
+    #undef OPDEF
+};
+
+#undef InlineNone
+#undef ShortInlineVar
+#undef ShortInlineI
+#undef ShortInlineBrTarget
+#undef InlineVar
+#undef InlineI
+#undef ShortInlineR
+#undef InlineBrTarget
+#undef InlineMethod
+#undef InlineField
+#undef InlineType
+#undef InlineString
+#undef InlineSig
+#undef InlineTok
+#undef InlineI8
+#undef InlineR
+#undef InlineSwitch
+
 /*========================================================================
 
 Routines used to emit into code buffers
@@ -1113,6 +1160,10 @@ void CodeGenerator::OptimizeGeneratedIL
     CSingleListIter<CODE_BLOCK> Iter(&m_cblkCodeList);
     CODE_BLOCK * pcblk;
 
+    // Thread branches first so that blocks which only forwarded a branch
+    // are left unreachable and get removed below.
+    ThreadBranches();
+
     MarkLiveBlocks(m_cblkCodeList.GetFirst());
 
     VSASSERT(m_tryList.NumberOfEntries() == m_tryholderEncounteredList.NumberOfEntries(),
@@ -1273,6 +1324,601 @@ void CodeGenerator::OptimizeGeneratedIL
     }
 
     OptimizeBranches();
+
+    // Runs last because OptimizeBranches can turn a branch into a pop that
+    // removes the value loaded for it.
+    RemoveRedundantInstructions();
+}
+
+//========================================================================
+// Can a branch to this block be redirected to wherever the block itself
+// branches to?  The block must be empty and end in an unconditional
+// branch or a return.  It also must not be the entry of a Try, because the
+// only way into a Try is through its first instruction, nor an await code
+// address, which the PDB needs to find in a live block.
+//========================================================================
+
+bool CodeGenerator::CanThreadBranchThrough
+(
+    CODE_BLOCK *pcblk
+)
+{
+    if (pcblk->usCodeSize != 0 ||
+        (pcblk->opcodeJump != CEE_BR_S && pcblk->opcodeJump != CEE_RET))
+    {
+        return false;
+    }
+
+    CSingleListIter<TRY_BLOCK> IterTry(&m_tryList);
+    TRY_BLOCK * ptry;
+
+    while (ptry = IterTry.Next())
+    {
+        // Empty blocks at the start of the Try share its address.
+        for (CODE_BLOCK *pcblkEntry = ptry->pcblkTry; pcblkEntry; pcblkEntry = pcblkEntry->Next())
+        {
+            if (pcblkEntry == pcblk)
+            {
+                return false;
+            }
+
+            if (pcblkEntry->usCodeSize != 0 || pcblkEntry->opcodeJump != CEE_NOP)
+            {
+                break;
+            }
+        }
+    }
+
+    for (ULONG i = 0; i < m_AwaitYieldOffsets.Count(); i++)
+    {
+        if (m_AwaitYieldOffsets.Element(i).pcblk == pcblk)
+        {
+            return false;
+        }
+    }
+
+    for (ULONG i = 0; i < m_AwaitResumeOffsets.Count(); i++)
+    {
+        if (m_AwaitResumeOffsets.Element(i).pcblk == pcblk)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//========================================================================
+// Redirect branches that land on a chain of empty blocks, each of which
+// only branches on to the next, straight to the end of the chain:
+//
+// br x                   br z
+// ...                    ...
+// x: br y      INTO      x: br y
+// ...                    ...
+// y: br z                y: br z
+//
+// An unconditional branch to an empty block that returns becomes a
+// return itself.  The blocks skipped over are removed later if nothing
+// else reaches them.
+//========================================================================
+
+void CodeGenerator::ThreadBranches
+(
+)
+{
+    // Bounds the chains followed, which also protects against an empty
+    // infinite loop (e.g. "Do : Loop").
+    const unsigned MaxThreadedBranches = 8;
+
+    CSingleListIter<CODE_BLOCK> Iter(&m_cblkCodeList);
+    CODE_BLOCK * pcblk;
+
+    while (pcblk = Iter.Next())
+    {
+        if (pcblk->opcodeJump != CEE_BR_S && !IsConditionalBranch(pcblk->opcodeJump))
+        {
+            continue;
+        }
+
+        for (unsigned Hops = 0; Hops < MaxThreadedBranches; Hops++)
+        {
+            CODE_BLOCK *pcblkDest = pcblk->pcblkJumpDest;
+
+            if (pcblkDest == pcblk || !CanThreadBranchThrough(pcblkDest))
+            {
+                break;
+            }
+
+            if (pcblkDest->opcodeJump == CEE_RET)
+            {
+                // A conditional branch can't return.
+                if (pcblk->opcodeJump == CEE_BR_S)
+                {
+                    pcblk->opcodeJump = CEE_RET;
+                    pcblk->pcblkJumpDest = NULL;
+                }
+
+                break;
+            }
+
+            pcblk->pcblkJumpDest = pcblkDest->pcblkJumpDest;
+        }
+    }
+}
+
+//========================================================================
+// Loads that only push a value, without side effects.
+//========================================================================
+
+static bool IsRemovableLoad
+(
+    OPCODE opcode
+)
+{
+    switch (opcode)
+    {
+        case CEE_DUP:
+        case CEE_LDLOC:
+        case CEE_LDLOCA:
+        case CEE_LDARG:
+        case CEE_LDARGA:
+        case CEE_LDNULL:
+        case CEE_LDC_I4:
+        case CEE_LDC_I8:
+        case CEE_LDC_R4:
+        case CEE_LDC_R8:
+        case CEE_LDSTR:
+            return true;
+    }
+
+    return false;
+}
+
+static bool IsRedundantPair
+(
+    const IL_INSTRUCTION *pFirst,
+    const IL_INSTRUCTION *pSecond
+)
+{
+    switch (pSecond->opcode)
+    {
+        case CEE_POP:
+            return IsRemovableLoad(pFirst->opcode);
+
+        case CEE_STLOC:
+            return pFirst->opcode == CEE_LDLOC && pFirst->uIndex == pSecond->uIndex;
+
+        case CEE_STARG:
+            return pFirst->opcode == CEE_LDARG && pFirst->uIndex == pSecond->uIndex;
+    }
+
+    return false;
+}
+
+//========================================================================
+// Is one of the addresses, which are sorted by offset, strictly between
+// uStart and uEnd?
+//========================================================================
+
+static bool HasCodeAddressWithin
+(
+    _In_count_(cAddresses) CODE_ADDRESS **ppAddresses,
+    unsigned cAddresses,
+    unsigned uStart,
+    unsigned uEnd
+)
+{
+    unsigned iLow = 0;
+    unsigned iHigh = cAddresses;
+
+    while (iLow < iHigh)
+    {
+        unsigned iMid = iLow + (iHigh - iLow) / 2;
+
+        if (ppAddresses[iMid]->uOffset <= uStart)
+        {
+            iLow = iMid + 1;
+        }
+        else
+        {
+            iHigh = iMid;
+        }
+    }
+
+    return iLow < cAddresses && ppAddresses[iLow]->uOffset < uEnd;
+}
+
+static int _cdecl CompareCodeAddresses
+(
+    const void *elem1,
+    const void *elem2
+)
+{
+    const CODE_ADDRESS *pAddress1 = *(const CODE_ADDRESS **)elem1;
+    const CODE_ADDRESS *pAddress2 = *(const CODE_ADDRESS **)elem2;
+
+    if (pAddress1->pcblk != pAddress2->pcblk)
+    {
+        return pAddress1->pcblk < pAddress2->pcblk ? -1 : 1;
+    }
+
+    if (pAddress1->uOffset != pAddress2->uOffset)
+    {
+        return pAddress1->uOffset < pAddress2->uOffset ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static void CollectScopeAddresses
+(
+    BlockScope *pScope,
+    DynamicArray<CODE_ADDRESS *> *pAddresses
+)
+{
+    CSingleListIter<BlockScope> IterScopes(&pScope->ChildScopeList);
+    BlockScope * ChildScope;
+
+    while (ChildScope = IterScopes.Next())
+    {
+        CollectScopeAddresses(ChildScope, pAddresses);
+    }
+
+    pAddresses->AddElement(&pScope->OpenAddress);
+    pAddresses->AddElement(&pScope->CloseAddress);
+}
+
+//========================================================================
+// Remove pairs of instructions that leave the stack, the locals and the
+// arguments as they were:
+//
+// dup                    ldloc x                ldloc x
+// pop           ,        pop           and      stloc x
+//
+// and the same for arguments.  A load of a constant, null, a string or
+// an address followed by a pop is removed too, as is a load followed by
+// the pop that OptimizeBranches leaves in place of a branch.  Removing a
+// pair can turn the instructions around it into a pair, which is then
+// removed as well.
+//
+// The line table, scopes, resume table and await offsets record offsets
+// into the code buffers.  A pair is kept if any of them lands inside it,
+// and the offsets after a removed pair are moved back.
+//========================================================================
+
+void CodeGenerator::RemoveRedundantInstructions
+(
+)
+{
+    CSingleListIter<CODE_BLOCK> Iter(&m_cblkCodeList);
+    CODE_BLOCK * pcblk;
+    unsigned cbLargestBlock = 0;
+
+    while (pcblk = Iter.Next())
+    {
+        if (pcblk->usCodeSize > cbLargestBlock)
+        {
+            cbLargestBlock = pcblk->usCodeSize;
+        }
+    }
+
+    if (cbLargestBlock == 0)
+    {
+        return;
+    }
+
+    // Collect the code addresses, sorted by block and then offset.
+    DynamicArray<CODE_ADDRESS *> Addresses;
+
+    for (LINETBL *pltbl = m_pltblLineTbl; pltbl < m_pltblCurrent; pltbl++)
+    {
+        Addresses.AddElement(&pltbl->codeaddr);
+    }
+
+    for (ULONG i = 0; i < m_AwaitYieldOffsets.Count(); i++)
+    {
+        Addresses.AddElement(&m_AwaitYieldOffsets.Element(i));
+    }
+
+    for (ULONG i = 0; i < m_AwaitResumeOffsets.Count(); i++)
+    {
+        Addresses.AddElement(&m_AwaitResumeOffsets.Element(i));
+    }
+
+    CSingleListIter<RESUME_ADDRESS> IterResume(&m_cadrResumeList);
+    RESUME_ADDRESS * presaddr;
+
+    while (presaddr = IterResume.Next())
+    {
+        Addresses.AddElement(&presaddr->codeaddr);
+    }
+
+    if (m_Project->GeneratePDB())
+    {
+        CollectScopeAddresses(m_MethodScope, &Addresses);
+    }
+
+    // The resume table is a switch table made from the resume addresses.
+    Iter.Reset();
+    while (pcblk = Iter.Next())
+    {
+        if (pcblk->opcodeJump == CEE_SWITCH)
+        {
+            for (unsigned long i = 0; i < pcblk->pswTable->cEntries; i++)
+            {
+                Addresses.AddElement(&pcblk->pswTable->pcodeaddrs[i]);
+            }
+        }
+    }
+
+    qsort(Addresses.Array(), Addresses.Count(), sizeof(CODE_ADDRESS *), CompareCodeAddresses);
+
+    // Map the opcode bytes back to opcodes: one byte opcodes first,
+    // followed by the opcodes after the 0xFE prefix.
+    OPCODE OpcodeMap[512];
+
+    for (unsigned i = 0; i < _countof(OpcodeMap); i++)
+    {
+        OpcodeMap[i] = CEE_COUNT;
+    }
+
+    for (unsigned i = 0; i < CEE_COUNT; i++)
+    {
+        if (s_OpcodeLen[i] == 1)
+        {
+            OpcodeMap[s_OpcodeCode[i]] = (OPCODE)i;
+        }
+        else if (s_OpcodeLen[i] == 2)
+        {
+            OpcodeMap[256 + s_OpcodeCode[i]] = (OPCODE)i;
+        }
+    }
+
+    // Every instruction is at least one byte long.
+    IL_INSTRUCTION *pInstructions = (IL_INSTRUCTION *)m_pnra->Alloc(VBMath::Multiply(
+        cbLargestBlock,
+        sizeof(IL_INSTRUCTION)));
+
+    CODE_ADDRESS **ppAddresses = Addresses.Array();
+    unsigned cAddresses = Addresses.Count();
+
+    Iter.Reset();
+    while (pcblk = Iter.Next())
+    {
+        unsigned iFirst = 0;
+        unsigned iHigh = cAddresses;
+
+        while (iFirst < iHigh)
+        {
+            unsigned iMid = iFirst + (iHigh - iFirst) / 2;
+
+            if (ppAddresses[iMid]->pcblk < pcblk)
+            {
+                iFirst = iMid + 1;
+            }
+            else
+            {
+                iHigh = iMid;
+            }
+        }
+
+        unsigned iEnd = iFirst;
+
+        while (iEnd < cAddresses && ppAddresses[iEnd]->pcblk == pcblk)
+        {
+            iEnd++;
+        }
+
+        RemoveRedundantInstructions(pcblk, OpcodeMap, ppAddresses + iFirst, iEnd - iFirst, pInstructions);
+    }
+}
+
+void CodeGenerator::RemoveRedundantInstructions
+(
+    CODE_BLOCK *pcblk,
+    const OPCODE *pOpcodeMap,
+    _In_count_(cAddresses) CODE_ADDRESS **ppAddresses,
+    unsigned cAddresses,
+    IL_INSTRUCTION *pInstructions
+)
+{
+    unsigned cInstructions = 0;
+    bool fRemoved = false;
+
+    for (unsigned uOffset = 0; uOffset < pcblk->usCodeSize; )
+    {
+        IL_INSTRUCTION *pInstruction = &pInstructions[cInstructions];
+
+        if (!DecodeInstruction(pcblk, uOffset, pOpcodeMap, pInstruction))
+        {
+            // Leave code that can't be stepped through as it is.
+            return;
+        }
+
+        uOffset = pInstruction->uEnd;
+
+        if (cInstructions > 0 &&
+            IsRedundantPair(&pInstructions[cInstructions - 1], pInstruction) &&
+            !HasCodeAddressWithin(ppAddresses, cAddresses, pInstructions[cInstructions - 1].uStart, pInstruction->uEnd))
+        {
+            cInstructions--;
+            fRemoved = true;
+        }
+        else
+        {
+            cInstructions++;
+        }
+    }
+
+    if (pcblk->opcodeJump == CEE_POP &&
+        cInstructions > 0 &&
+        IsRemovableLoad(pInstructions[cInstructions - 1].opcode) &&
+        !HasCodeAddressWithin(
+            ppAddresses,
+            cAddresses,
+            pInstructions[cInstructions - 1].uStart,
+            pcblk->usCodeSize + CBytesOpcode(CEE_POP)))
+    {
+        cInstructions--;
+        pcblk->opcodeJump = CEE_NOP;
+        fRemoved = true;
+    }
+
+    if (!fRemoved)
+    {
+        return;
+    }
+
+    // Move the instructions that are left to the front of the buffer. An
+    // address is never inside a kept instruction or a removed pair, so its
+    // new offset is the size of the instructions kept before it.
+    unsigned cbOldCode = pcblk->usCodeSize;
+    unsigned cbCode = 0;
+    unsigned iAddress = 0;
+
+    for (unsigned i = 0; i < cInstructions; i++)
+    {
+        IL_INSTRUCTION *pInstruction = &pInstructions[i];
+        unsigned cbInstruction = pInstruction->uEnd - pInstruction->uStart;
+
+        while (iAddress < cAddresses && ppAddresses[iAddress]->uOffset <= pInstruction->uStart)
+        {
+            ppAddresses[iAddress++]->uOffset = cbCode;
+        }
+
+        memmove(pcblk->pbCodeBuffer + cbCode, pcblk->pbCodeBuffer + pInstruction->uStart, cbInstruction);
+        cbCode += cbInstruction;
+    }
+
+    // The rest are at the end of the code, or past it (e.g. the close of
+    // the method scope, after the final ret).
+    for (; iAddress < cAddresses; iAddress++)
+    {
+        CODE_ADDRESS *pAddress = ppAddresses[iAddress];
+
+        pAddress->uOffset = pAddress->uOffset > cbOldCode ?
+            cbCode + (pAddress->uOffset - cbOldCode) :
+            cbCode;
+    }
+
+    pcblk->usCodeSize = (unsigned short)cbCode;
+}
+
+//========================================================================
+// Decode the instruction at uOffset in the code buffer of a block.
+// Returns false if it is not a complete instruction of a fixed size.
+//========================================================================
+
+bool CodeGenerator::DecodeInstruction
+(
+    CODE_BLOCK *pcblk,
+    unsigned uOffset,
+    const OPCODE *pOpcodeMap,
+    _Out_ IL_INSTRUCTION *pInstruction
+)
+{
+    const unsigned char *pbCode = pcblk->pbCodeBuffer;
+    unsigned cbCode = pcblk->usCodeSize;
+    unsigned uOperand = uOffset + 1;
+    OPCODE opcode;
+
+    if (pbCode[uOffset] == 0xFE)
+    {
+        if (uOperand >= cbCode)
+        {
+            return false;
+        }
+
+        opcode = pOpcodeMap[256 + pbCode[uOperand]];
+        uOperand++;
+    }
+    else
+    {
+        opcode = pOpcodeMap[pbCode[uOffset]];
+    }
+
+    if (opcode == CEE_COUNT ||
+        s_OpcodeOperandSize[opcode] == VariableOperandSize ||
+        uOperand + s_OpcodeOperandSize[opcode] > cbCode)
+    {
+        return false;
+    }
+
+    pInstruction->uStart = uOffset;
+    pInstruction->uEnd = uOperand + s_OpcodeOperandSize[opcode];
+    pInstruction->opcode = opcode;
+    pInstruction->uIndex = 0;
+
+    switch (opcode)
+    {
+        case CEE_LDLOC_0:
+        case CEE_LDLOC_1:
+        case CEE_LDLOC_2:
+        case CEE_LDLOC_3:
+            pInstruction->opcode = CEE_LDLOC;
+            pInstruction->uIndex = opcode - CEE_LDLOC_0;
+            break;
+
+        case CEE_STLOC_0:
+        case CEE_STLOC_1:
+        case CEE_STLOC_2:
+        case CEE_STLOC_3:
+            pInstruction->opcode = CEE_STLOC;
+            pInstruction->uIndex = opcode - CEE_STLOC_0;
+            break;
+
+        case CEE_LDARG_0:
+        case CEE_LDARG_1:
+        case CEE_LDARG_2:
+        case CEE_LDARG_3:
+            pInstruction->opcode = CEE_LDARG;
+            pInstruction->uIndex = opcode - CEE_LDARG_0;
+            break;
+
+        case CEE_LDLOC_S:
+        case CEE_STLOC_S:
+        case CEE_LDARG_S:
+        case CEE_STARG_S:
+            pInstruction->opcode =
+                opcode == CEE_LDLOC_S ? CEE_LDLOC :
+                opcode == CEE_STLOC_S ? CEE_STLOC :
+                opcode == CEE_LDARG_S ? CEE_LDARG :
+                CEE_STARG;
+            pInstruction->uIndex = pbCode[uOperand];
+            break;
+
+        case CEE_LDLOC:
+        case CEE_STLOC:
+        case CEE_LDARG:
+        case CEE_STARG:
+            pInstruction->uIndex = pbCode[uOperand] | (pbCode[uOperand + 1] << 8);
+            break;
+
+        case CEE_LDLOCA_S:
+            pInstruction->opcode = CEE_LDLOCA;
+            break;
+
+        case CEE_LDARGA_S:
+            pInstruction->opcode = CEE_LDARGA;
+            break;
+
+        case CEE_LDC_I4_M1:
+        case CEE_LDC_I4_0:
+        case CEE_LDC_I4_1:
+        case CEE_LDC_I4_2:
+        case CEE_LDC_I4_3:
+        case CEE_LDC_I4_4:
+        case CEE_LDC_I4_5:
+        case CEE_LDC_I4_6:
+        case CEE_LDC_I4_7:
+        case CEE_LDC_I4_8:
+        case CEE_LDC_I4_S:
+            pInstruction->opcode = CEE_LDC_I4;
+            break;
+    }
+
+    return true;
 }
 
 bool
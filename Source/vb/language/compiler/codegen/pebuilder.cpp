@@ -5333,6 +5333,9 @@ bool PEBuilder::GenerateCodeForContainer
             
                 NorlsAllocator nraCodeGen (NORLSLOC);
 
+                // The hydration queue and the evaluation stack release their nodes as code is generated.
+                nraCodeGen.EnableRecycling();
+
                 pProc = pCurCodeGenInfo.m_pProc;
 
                 // If the current procedure is a partial method declaration, don't emit
@@ -5619,9 +5622,19 @@ bool PEBuilder::CompileMethodsOfContainer
 )
 {
     bool fAborted = false;
+
+    // Binding and generating code for the methods one at a time creates and
+    // frees many short lived allocators (per method, and per statement in the
+    // semantic analyzer).  Let their pages cycle through this thread's cache
+    // instead of the page heap lock.  It must outlive the allocators below.
+    PageHeap::ThreadPageCache pageCache(g_pvbNorlsManager->GetPageHeap());
+
     NorlsAllocator nraBoundTrees(NORLSLOC);
     DynamicArray<CodeGenInfo> codeGenInfos;
 
+    // Collection nodes and iterators released while binding are reused.
+    nraBoundTrees.EnableRecycling();
+
     // Open transaction on transient symbol store so that changes can be rolled back on Abort
     m_Transients.StartTransaction();
 
@@ -635,6 +635,27 @@ ILTree::PILNode ptreeStmtCur    // SB_CASE
             }
         }
     }
+    else if (ptreeSelect->uFlags & (SBF_SELECT_HASH | SBF_SELECT_SPARSE))
+    {
+        // The dispatch emitted by GenerateSelect branches straight to the code
+        // block of each Case, so only the previous Case needs to be closed off.
+        //
+        if (ptreeSelect->AsSelectBlock().ptreeChild != ptreeStmtCur)
+        {
+            VSASSERT(ptreeSelect->AsSelectBlock().EndBlock,
+                       "GenerateCase: SELECT must have a block end code block.");
+
+            // Add a Resume entry to protect against fall-through from the previous Case block.
+            UpdateResumeTable(ptreeStmtCur->AsStatement().ResumeIndex, false);
+            EndCodeBuffer(CEE_BR_S, ptreeSelect->AsSelectBlock().EndBlock);
+        }
+
+        VSASSERT(ptreeStmtCur->AsCaseBlock().EntryBlock, "GenerateCase: code block for CASE doesn't exist");
+
+        SetAsCurrentCodeBlock(ptreeStmtCur->AsCaseBlock().EntryBlock);
+        UpdateLineTable(ptreeStmtCur);
+        InsertNOP();
+    }
     else
     {
         ILTree::PILNode ptreeChild;
@@ -906,6 +927,14 @@ ILTree::PILNode ptreeStmtCur    // SB_SELECT
 
         SetAsCurrentCodeBlock(0);
     }
+    else if (Select->uFlags & SBF_SELECT_SPARSE)
+    {
+        GenerateSelectSparseDispatch(Select);
+    }
+    else if (Select->uFlags & SBF_SELECT_HASH)
+    {
+        GenerateSelectHashDispatch(Select);
+    }
     else
     {
         // Generate the select assignment statement
@@ -913,6 +942,569 @@ ILTree::PILNode ptreeStmtCur    // SB_SELECT
     }
 }
 
+//========================================================================
+// Give every Case of a Select that dispatches directly to its cases a
+// code block of its own.  Returns the block that values matching no
+// Case branch to.
+//========================================================================
+
+CODE_BLOCK *CodeGenerator::CreateSelectCaseBlocks
+(
+    ILTree::SelectBlock *Select
+)
+{
+    CODE_BLOCK *pcblkDefault = Select->EndBlock;
+
+    for (ILTree::Statement *CurrentStatement = Select->Child;
+         CurrentStatement && CurrentStatement->bilop == SB_CASE;
+         CurrentStatement = CurrentStatement->Next)
+    {
+        CurrentStatement->AsCaseBlock().EntryBlock = NewCodeBlock();
+
+        if (CurrentStatement->uFlags & SBF_CASE_ISELSE)
+        {
+            pcblkDefault = CurrentStatement->AsCaseBlock().EntryBlock;
+        }
+    }
+
+    return pcblkDefault;
+}
+
+//========================================================================
+// Hash of a Case label, computed the same way as the IL emitted by
+// GenerateSelectHashDispatch computes the hash of the selector
+// (32 bit FNV-1a over the UTF-16 code units).
+//========================================================================
+
+static const unsigned SelectHashOffsetBasis = 0x811C9DC5;
+static const unsigned SelectHashPrime = 16777619;
+
+static unsigned
+HashSelectCaseLabel
+(
+    _In_count_(Length) const WCHAR *Spelling,
+    size_t Length
+)
+{
+    unsigned Hash = SelectHashOffsetBasis;
+
+    for (size_t i = 0; i < Length; i++)
+    {
+        Hash = (Hash ^ Spelling[i]) * SelectHashPrime;
+    }
+
+    return Hash;
+}
+
+struct SelectHashLabel
+{
+    const WCHAR *Spelling;
+    size_t Length;
+    unsigned Hash;
+    CODE_BLOCK *Target;
+    SelectHashLabel *Next;      // next label in the same bucket, in Case order
+};
+
+//========================================================================
+// Generate the dispatch of a Select on a String whose Cases are all
+// string constants compared in binary mode.
+//
+// Rather than comparing the selector against every label in turn, the
+// selector is hashed once and a SWITCH on the low bits of the hash
+// selects a bucket.  Each bucket compares the full hash and then the
+// string of only the labels that fall into it, in Case order, so the
+// first matching Case still wins.
+//
+//   VB Code                                   COM+ pseudocode
+//   ---------------------------------         ----------------------------------
+//   Select Case s                             temp = s
+//                                             hash = FNV-1a(temp)   (Nothing hashes as "")
+//                                             switch (hash & mask)
+//                                             branch CaseElse       (FallThrough cblk)
+//                                             bucket n:
+//                                               if hash <> h1 then branch next
+//                                               if CompareString(temp, "a") = 0 then branch Case "a"
+//                                             next:
+//                                               ...
+//                                               branch CaseElse
+//     Case "a"                                                      (Case cblk)
+//       <do something>                        ...
+//========================================================================
+
+void CodeGenerator::GenerateSelectHashDispatch
+(
+    ILTree::SelectBlock *Select
+)
+{
+    CODE_BLOCK *pcblkDefault = CreateSelectCaseBlocks(Select);
+
+    unsigned long LabelCount = 0;
+
+    for (ILTree::Statement *CurrentStatement = Select->Child;
+         CurrentStatement && CurrentStatement->bilop == SB_CASE;
+         CurrentStatement = CurrentStatement->Next)
+    {
+        if (CurrentStatement->uFlags & SBF_CASE_ISELSE)
+        {
+            continue;
+        }
+
+        for (ILTree::CASELIST *CaseClause = CurrentStatement->AsCaseBlock().BoundCaseList;
+             CaseClause;
+             CaseClause = CaseClause->Next)
+        {
+            LabelCount++;
+        }
+    }
+
+    VSASSERT(LabelCount > 0, "GenerateSelectHashDispatch: hashed Select must have labels.");
+
+    // Use a power of two number of buckets, about one per label.
+    unsigned long BucketCount = 1;
+
+    while (BucketCount < LabelCount)
+    {
+        BucketCount <<= 1;
+    }
+
+    SelectHashLabel **Buckets = m_pnra->AllocArray<SelectHashLabel *>(BucketCount);
+    SelectHashLabel **BucketTails = m_pnra->AllocArray<SelectHashLabel *>(BucketCount);
+    SelectHashLabel *Labels = m_pnra->AllocArray<SelectHashLabel>(LabelCount);
+
+    unsigned long LabelIndex = 0;
+
+    for (ILTree::Statement *CurrentStatement = Select->Child;
+         CurrentStatement && CurrentStatement->bilop == SB_CASE;
+         CurrentStatement = CurrentStatement->Next)
+    {
+        if (CurrentStatement->uFlags & SBF_CASE_ISELSE)
+        {
+            continue;
+        }
+
+        for (ILTree::CASELIST *CaseClause = CurrentStatement->AsCaseBlock().BoundCaseList;
+             CaseClause;
+             CaseClause = CaseClause->Next)
+        {
+            VSASSERT(CaseClause->LowBound->bilop == SX_CNS_STR &&
+                     !CaseClause->IsRange &&
+                     CaseClause->RelationalOpcode == SX_EQ,
+                     "GenerateSelectHashDispatch: unexpected conditions for use of hash table");
+
+            SelectHashLabel *Label = &Labels[LabelIndex++];
+
+            Label->Spelling = CaseClause->LowBound->AsStringConstant().Spelling;
+            Label->Length = CaseClause->LowBound->AsStringConstant().Length;
+            Label->Hash = HashSelectCaseLabel(Label->Spelling, Label->Length);
+            Label->Target = CurrentStatement->AsCaseBlock().EntryBlock;
+            Label->Next = NULL;
+
+            unsigned long Bucket = Label->Hash & (BucketCount - 1);
+
+            // A repeated label can never be reached, so don't test it again.
+            bool IsDuplicate = false;
+
+            for (SelectHashLabel *Existing = Buckets[Bucket]; Existing; Existing = Existing->Next)
+            {
+                if (Existing->Hash == Label->Hash &&
+                    Existing->Length == Label->Length &&
+                    memcmp(Existing->Spelling, Label->Spelling, Label->Length * sizeof(WCHAR)) == 0)
+                {
+                    IsDuplicate = true;
+                    break;
+                }
+            }
+
+            if (IsDuplicate)
+            {
+                continue;
+            }
+
+            if (BucketTails[Bucket])
+            {
+                BucketTails[Bucket]->Next = Label;
+            }
+            else
+            {
+                Buckets[Bucket] = Label;
+            }
+
+            BucketTails[Bucket] = Label;
+        }
+    }
+
+    SWITCH_TABLE *SwitchTable = AllocSwitchTable(BucketCount);
+
+    SwitchTable->cEntries = BucketCount;
+    SwitchTable->LowVal = 0;
+    SwitchTable->HiVal = BucketCount - 1;
+    SwitchTable->pcblkFallThrough = NewCodeBlock();
+    SwitchTable->pcblkCaseElse = (pcblkDefault != Select->EndBlock) ? pcblkDefault : NULL;
+
+    Select->SwitchTable = SwitchTable;
+
+    // Generate the select assignment statement
+    GenerateRvalue(Select->SelectorCapture);
+
+    BCSYM *Int32Type = GetSymbolForVtype(t_i4);
+    BCSYM_Variable *HashTemporary = CreateCodeGenTemporary(Int32Type);
+    BCSYM_Variable *IndexTemporary = CreateCodeGenTemporary(Int32Type);
+
+    StartHiddenIL();
+
+    // hash = offset basis; Nothing is left with the hash of "", which it also compares equal to.
+    CODE_BLOCK *pcblkHashed = NewCodeBlock();
+
+    GenerateLiteralInt((__int32)SelectHashOffsetBasis);
+    GenerateStoreLocal(HashTemporary->GetLocalSlot());
+
+    GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+    EndCodeBuffer(CEE_BRFALSE_S, pcblkHashed, t_ref);
+
+    CODE_BLOCK *pcblkLoopBody = NewCodeBlock();
+    CODE_BLOCK *pcblkLoopTest = NewCodeBlock();
+
+    SetAsCurrentCodeBlock(0);
+    GenerateLiteralInt(0);
+    GenerateStoreLocal(IndexTemporary->GetLocalSlot());
+    EndCodeBuffer(CEE_BR_S, pcblkLoopTest);
+
+    // hash = (hash Xor temp.Chars(index)) * prime
+    SetAsCurrentCodeBlock(pcblkLoopBody);
+    GenerateLoadLocal(HashTemporary->GetLocalSlot(), Int32Type);
+    GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+    GenerateLoadLocal(IndexTemporary->GetLocalSlot(), Int32Type);
+    GenerateCallToRuntimeHelper(StringCharsMember, GetSymbolForVtype(t_char), &Select->Loc);
+    EmitOpcode(CEE_XOR, Int32Type);
+    GenerateLiteralInt((__int32)SelectHashPrime);
+    EmitOpcode(CEE_MUL, Int32Type);
+    GenerateStoreLocal(HashTemporary->GetLocalSlot());
+
+    GenerateLoadLocal(IndexTemporary->GetLocalSlot(), Int32Type);
+    GenerateLiteralInt(1);
+    EmitOpcode(CEE_ADD, Int32Type);
+    GenerateStoreLocal(IndexTemporary->GetLocalSlot());
+
+    // while index < temp.Length
+    SetAsCurrentCodeBlock(pcblkLoopTest);
+    GenerateLoadLocal(IndexTemporary->GetLocalSlot(), Int32Type);
+    GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+    GenerateCallToRuntimeHelper(StringLengthMember, Int32Type, &Select->Loc);
+    EndCodeBuffer(CEE_BLT_S, pcblkLoopBody, t_i4);
+
+    SetAsCurrentCodeBlock(pcblkHashed);
+    GenerateLoadLocal(HashTemporary->GetLocalSlot(), Int32Type);
+    GenerateLiteralInt((__int32)(BucketCount - 1));
+    EmitOpcode(CEE_AND, Int32Type);
+
+    // ENC requires a remappable point before each switch (VSW#205252).
+    InsertENCRemappablePoint(Int32Type);
+
+    StartHiddenIL();
+    EndCodeBuffer(CEE_SWITCH, SwitchTable); // CEE_SWITCH does not push any values.
+
+    // Every bucket has an entry, so the fall through is only there to satisfy the switch.
+    SetAsCurrentCodeBlock(SwitchTable->pcblkFallThrough);
+    EndCodeBuffer(CEE_BR_S, pcblkDefault);
+
+    for (unsigned long Bucket = 0; Bucket < BucketCount; Bucket++)
+    {
+        if (!Buckets[Bucket])
+        {
+            SwitchTable->pcodeaddrs[Bucket].pcblk = pcblkDefault;
+            continue;
+        }
+
+        SetAsCurrentCodeBlock(0);
+        SwitchTable->pcodeaddrs[Bucket].pcblk = m_pcblkCurrent;
+
+        for (SelectHashLabel *Label = Buckets[Bucket]; Label; Label = Label->Next)
+        {
+            CODE_BLOCK *pcblkNextLabel = NewCodeBlock();
+
+            GenerateLoadLocal(HashTemporary->GetLocalSlot(), Int32Type);
+            GenerateLiteralInt((__int32)Label->Hash);
+            EndCodeBuffer(CEE_BNE_UN_S, pcblkNextLabel, t_i4);
+            SetAsCurrentCodeBlock(0);
+
+            // The binary comparison treats Nothing as "", just like the IF list would.
+            GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+            GenerateLiteralStr(Label->Spelling, Label->Length);
+            GenerateLiteralInt(COMPLUS_FALSE);
+
+            if (m_Project->GetVBRuntimeKind() == EmbeddedRuntime)
+            {
+                GenerateCallToRuntimeHelper(EmbeddedCompareStringMember, Int32Type, &Select->Loc);
+            }
+            else
+            {
+                GenerateCallToRuntimeHelper(CompareStringMember, Int32Type, &Select->Loc);
+            }
+
+            EndCodeBuffer(CEE_BRFALSE_S, Label->Target, t_i4);
+
+            SetAsCurrentCodeBlock(pcblkNextLabel);
+        }
+
+        EndCodeBuffer(CEE_BR_S, pcblkDefault);
+    }
+
+    m_pCodeGenTemporaryManager->FreeTemporary(IndexTemporary);
+    m_pCodeGenTemporaryManager->FreeTemporary(HashTemporary);
+}
+
+//========================================================================
+// Generate the dispatch of a Select on an integral value whose Cases are
+// constants too spread out for a single SWITCH table.
+//
+// Semantics has sorted the values of the cases and partitioned them into
+// clusters (see Semantics::RecommendSparseSwitchTable).  A balanced binary
+// search on the lowest value of each cluster selects the cluster, which
+// then dispatches through its own SWITCH table, or through a direct
+// comparison if it holds a single value or range.
+//
+//   VB Code                                   COM+ pseudocode
+//   ---------------------------------         ----------------------------------
+//   Select Case i                             temp = i
+//                                             if temp >= 1000 then branch upper
+//                                             switch (temp - 1)   (Case 1, 2, 3, 5)
+//                                             branch CaseElse
+//                                           upper:
+//                                             switch (temp - 1000)   (Case 1000 To 1003)
+//                                             branch CaseElse
+//     Case 1, 2                                                     (Case cblk)
+//       <do something>                        ...
+//========================================================================
+
+void CodeGenerator::GenerateSelectSparseDispatch
+(
+    ILTree::SelectBlock *Select
+)
+{
+    VSASSERT(Select->CaseRanges && Select->CaseRangeCount > 0,
+             "GenerateSelectSparseDispatch: sparse Select must have case values.");
+
+    CODE_BLOCK *pcblkDefault = CreateSelectCaseBlocks(Select);
+
+    // Map the ordinals of the cases to their code blocks.
+    unsigned CaseCount = 0;
+
+    for (ILTree::Statement *CurrentStatement = Select->Child;
+         CurrentStatement && CurrentStatement->bilop == SB_CASE;
+         CurrentStatement = CurrentStatement->Next)
+    {
+        CaseCount++;
+    }
+
+    CODE_BLOCK **CaseBlocks = m_pnra->AllocArray<CODE_BLOCK *>(CaseCount);
+    unsigned CaseIndex = 0;
+
+    for (ILTree::Statement *CurrentStatement = Select->Child;
+         CurrentStatement && CurrentStatement->bilop == SB_CASE;
+         CurrentStatement = CurrentStatement->Next)
+    {
+        CaseBlocks[CaseIndex++] = CurrentStatement->AsCaseBlock().EntryBlock;
+    }
+
+    // Collect the first range of each cluster.
+    unsigned ClusterCount = 0;
+
+    for (unsigned RangeIndex = 0; RangeIndex < Select->CaseRangeCount; RangeIndex++)
+    {
+        if (Select->CaseRanges[RangeIndex].StartsCluster)
+        {
+            ClusterCount++;
+        }
+    }
+
+    VSASSERT(Select->CaseRanges[0].StartsCluster, "GenerateSelectSparseDispatch: first value must start a cluster.");
+
+    // One extra entry marks the end of the last cluster.
+    unsigned *Clusters = m_pnra->AllocArray<unsigned>(ClusterCount + 1);
+    unsigned ClusterIndex = 0;
+
+    for (unsigned RangeIndex = 0; RangeIndex < Select->CaseRangeCount; RangeIndex++)
+    {
+        if (Select->CaseRanges[RangeIndex].StartsCluster)
+        {
+            Clusters[ClusterIndex++] = RangeIndex;
+        }
+    }
+
+    Clusters[ClusterCount] = Select->CaseRangeCount;
+
+    // Generate the select assignment statement
+    GenerateRvalue(Select->SelectorCapture);
+
+    StartHiddenIL();
+    GenerateSelectSparseSearch(Select, Clusters, 0, ClusterCount, CaseBlocks, pcblkDefault);
+}
+
+void CodeGenerator::GenerateSelectSparseSearch
+(
+    ILTree::SelectBlock *Select,
+    unsigned *Clusters,
+    unsigned FirstCluster,
+    unsigned ClusterCount,
+    CODE_BLOCK **CaseBlocks,
+    CODE_BLOCK *pcblkDefault
+)
+{
+    if (ClusterCount == 1)
+    {
+        GenerateSelectSparseCluster(
+            Select,
+            Clusters[FirstCluster],
+            Clusters[FirstCluster + 1] - Clusters[FirstCluster],
+            CaseBlocks,
+            pcblkDefault);
+
+        return;
+    }
+
+    Vtypes vtype = Select->SelectorCapture->AsExpressionWithChildren().Right->vtype;
+    bool Is64Bit = vtype == t_i8 || vtype == t_ui8;
+
+    unsigned LowerCount = ClusterCount / 2;
+    unsigned MiddleCluster = FirstCluster + LowerCount;
+    CODE_BLOCK *pcblkUpper = NewCodeBlock();
+
+    // if temp >= lowest value of the middle cluster then search the upper half
+    GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+    GenerateLiteralInt(Select->CaseRanges[Clusters[MiddleCluster]].Low, Is64Bit);
+    EndCodeBuffer(IsUnsignedType(vtype) ? CEE_BGE_UN_S : CEE_BGE_S, pcblkUpper, vtype);
+
+    SetAsCurrentCodeBlock(0);
+    GenerateSelectSparseSearch(Select, Clusters, FirstCluster, LowerCount, CaseBlocks, pcblkDefault);
+
+    SetAsCurrentCodeBlock(pcblkUpper);
+    GenerateSelectSparseSearch(Select, Clusters, MiddleCluster, ClusterCount - LowerCount, CaseBlocks, pcblkDefault);
+}
+
+void CodeGenerator::GenerateSelectSparseCluster
+(
+    ILTree::SelectBlock *Select,
+    unsigned FirstRange,
+    unsigned RangeCount,
+    CODE_BLOCK **CaseBlocks,
+    CODE_BLOCK *pcblkDefault
+)
+{
+    Vtypes vtype = Select->SelectorCapture->AsExpressionWithChildren().Right->vtype;
+    bool Is64Bit = vtype == t_i8 || vtype == t_ui8;
+    OPCODE BranchIfLess = IsUnsignedType(vtype) ? CEE_BLT_UN_S : CEE_BLT_S;
+    OPCODE BranchIfGreater = IsUnsignedType(vtype) ? CEE_BGT_UN_S : CEE_BGT_S;
+
+    ILTree::SelectCaseRange *First = &Select->CaseRanges[FirstRange];
+    ILTree::SelectCaseRange *Last = &Select->CaseRanges[FirstRange + RangeCount - 1];
+
+    if (RangeCount == 1)
+    {
+        // A lone value or range is compared directly.
+        GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+        GenerateLiteralInt(First->Low, Is64Bit);
+
+        if (First->Low == First->High)
+        {
+            EndCodeBuffer(CEE_BEQ_S, CaseBlocks[First->CaseIndex], vtype);
+        }
+        else
+        {
+            EndCodeBuffer(BranchIfLess, pcblkDefault, vtype);
+
+            SetAsCurrentCodeBlock(0);
+            GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+            GenerateLiteralInt(First->High, Is64Bit);
+            EndCodeBuffer(IsUnsignedType(vtype) ? CEE_BLE_UN_S : CEE_BLE_S, CaseBlocks[First->CaseIndex], vtype);
+        }
+
+        SetAsCurrentCodeBlock(0);
+        EndCodeBuffer(CEE_BR_S, pcblkDefault);
+        return;
+    }
+
+    unsigned __int64 CountOfEntries = (unsigned __int64)Last->High - (unsigned __int64)First->Low + 1;
+
+    VSASSERT(CountOfEntries > 0 && CountOfEntries <= INT_MAX, "GenerateSelectSparseCluster: cluster too large for a switch table.");
+
+#pragma warning(disable:22005) // Semantics has bounded the size of the cluster
+    SWITCH_TABLE *SwitchTable = AllocSwitchTable((unsigned long)CountOfEntries);
+
+    SwitchTable->cEntries = (unsigned long)CountOfEntries;
+#pragma warning(default:22005) // Semantics has bounded the size of the cluster
+    SwitchTable->LowVal = First->Low;
+    SwitchTable->HiVal = Last->High;
+    SwitchTable->pcblkFallThrough = NewCodeBlock();
+
+    for (ILTree::SelectCaseRange *Range = First; Range <= Last; Range++)
+    {
+        for (unsigned __int64 Value = (unsigned __int64)Range->Low; ; Value++)
+        {
+            RecordSwitchTableEntry(SwitchTable, Value - (unsigned __int64)First->Low, CaseBlocks[Range->CaseIndex]);
+
+            if (Value == (unsigned __int64)Range->High)
+            {
+                break;
+            }
+        }
+    }
+
+    // The gaps between the values of the cluster go to the default.
+    for (unsigned long Entry = 0; Entry < SwitchTable->cEntries; Entry++)
+    {
+        if (!SwitchTable->pcodeaddrs[Entry].pcblk)
+        {
+            SwitchTable->pcodeaddrs[Entry].pcblk = pcblkDefault;
+        }
+    }
+
+    // As for a single SWITCH table, an I8 or UI8 value must be range checked
+    // before it is truncated to I4.
+    //
+    if (Is64Bit)
+    {
+        GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+        GenerateLiteralInt(SwitchTable->HiVal, true);
+        EndCodeBuffer(BranchIfGreater, pcblkDefault, vtype);
+
+        SetAsCurrentCodeBlock(0);
+        GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+        GenerateLiteralInt(SwitchTable->LowVal, true);
+        EndCodeBuffer(BranchIfLess, pcblkDefault, vtype);
+
+        SetAsCurrentCodeBlock(0);
+    }
+
+    GenerateLoadOrElseLoadLocal(Select->LiftedSelectorTemporary, Select->SelectorTemporary);
+
+    if (SwitchTable->LowVal != 0)
+    {
+        GenerateLiteralInt(SwitchTable->LowVal, Is64Bit);
+        EmitOpcode(CEE_SUB, GetSymbolForVtype(vtype));
+    }
+
+    Vtypes vtypeNormalization = vtype;
+    if (vtype == t_i8)
+    {
+        vtypeNormalization = t_i4;
+        EmitOpcode(CEE_CONV_I4, GetSymbolForVtype(vtypeNormalization));
+    }
+    else if (vtype == t_ui8)
+    {
+        vtypeNormalization = t_ui4;
+        EmitOpcode(CEE_CONV_U4, GetSymbolForVtype(vtypeNormalization));
+    }
+
+    // ENC requires a remappable point before each switch (VSW#205252).
+    InsertENCRemappablePoint(GetSymbolForVtype(vtypeNormalization));
+
+    StartHiddenIL();
+    EndCodeBuffer(CEE_SWITCH, SwitchTable); // CEE_SWITCH does not push any values.
+
+    SetAsCurrentCodeBlock(SwitchTable->pcblkFallThrough);
+    EndCodeBuffer(CEE_BR_S, pcblkDefault);
+}
+
 //========================================================================
 // Does the block end processing (patching jumps) for all control constructs.
 //========================================================================
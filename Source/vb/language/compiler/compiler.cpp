@@ -1852,6 +1852,15 @@ STDMETHODIMP Compiler::Compile
         CompilerProject **rgpProjects = pCurrentSetOfProjectsToCompile->Array();
         unsigned iProject;
 
+#if !IDE
+        // If every source project's inputs still match its build cache, the
+        // outputs on disk are current and there is nothing to do for this host.
+        if (IsUpToDateWithBuildCache(rgpProjects, cProjects))
+        {
+            continue;
+        }
+#endif !IDE
+
         // Walk the list of projects and build them.
 
         // Clear the error cache
@@ -1901,6 +1910,10 @@ STDMETHODIMP Compiler::Compile
             {
                 rgpProjects[iProject]->FinishCompile();
             }
+
+#if !IDE
+            SaveBuildCaches(rgpProjects, cProjects);
+#endif !IDE
         }
     }
 
@@ -1922,6 +1935,72 @@ Error:
     RRETURN( hr );
 }
 
+#if !IDE
+//============================================================================
+// Are the outputs of all the source projects in the compilation list
+// current according to their incremental build caches?
+//============================================================================
+bool Compiler::IsUpToDateWithBuildCache
+(
+    _In_count_(cProjects) CompilerProject **rgpProjects,
+    unsigned cProjects
+)
+{
+    bool fFoundSourceProject = false;
+
+    for (unsigned iProject = 0; iProject < cProjects; iProject++)
+    {
+        CompilerProject *pProject = rgpProjects[iProject];
+
+        if (pProject->IsMetaData())
+        {
+            continue;
+        }
+
+        if (!pProject->UseBuildCache())
+        {
+            return false;
+        }
+
+        IncrementalBuildCache cache(pProject);
+
+        if (!cache.IsUpToDate())
+        {
+            return false;
+        }
+
+        fFoundSourceProject = true;
+    }
+
+    return fFoundSourceProject;
+}
+
+//============================================================================
+// Records the build caches of the source projects that were just written to
+// disk.  The list is in dependency order, so each project sees the surface
+// fingerprints that its source references have just recorded.
+//============================================================================
+void Compiler::SaveBuildCaches
+(
+    _In_count_(cProjects) CompilerProject **rgpProjects,
+    unsigned cProjects
+)
+{
+    for (unsigned iProject = 0; iProject < cProjects; iProject++)
+    {
+        CompilerProject *pProject = rgpProjects[iProject];
+
+        if (!pProject->IsMetaData() &&
+            pProject->UseBuildCache() &&
+            pProject->CompiledSuccessfully())
+        {
+            IncrementalBuildCache cache(pProject);
+            cache.Save();
+        }
+    }
+}
+#endif !IDE
+
 // Compiles all projects under one host to Bound state.
 // This does not belong to IVbCompiler. Since our expression valuator
 // needs to initialize mscorlib.dll and microsoft.visualbasic.dll in
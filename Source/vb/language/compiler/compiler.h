@@ -933,6 +933,21 @@ public:
         DynamicArray<CompilerProject *> *pPreferredProjects = NULL
     );
 
+#if !IDE
+    // Incremental build cache support for the command-line compiler.
+    bool IsUpToDateWithBuildCache
+    (
+        _In_count_(cProjects) CompilerProject **rgpProjects,
+        unsigned cProjects
+    );
+
+    void SaveBuildCaches
+    (
+        _In_count_(cProjects) CompilerProject **rgpProjects,
+        unsigned cProjects
+    );
+#endif !IDE
+
     CompilerIdeCriticalSection& GetMetaImportCritSec()
     {
         return m_csMetaImport;
@@ -28,7 +28,7 @@ FileLeakDetection s_FileLeakDetection;
 
 CompilerFile::CompilerFile(Compiler *pCompiler)
     : m_ErrorTable(pCompiler, NULL, NULL)
-    , m_nraSymbols(NORLSLOC)
+    , m_nraSymbols(NORLSLOC, g_pvbNorlsManager->GetSymbolPageHeap())
     , m_pCompiler(pCompiler)
     , m_cs(CS_MAX)
     , m_isUnlinkedFromProject(false)
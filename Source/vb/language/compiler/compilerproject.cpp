@@ -304,6 +304,201 @@ NorlsAllocator * ExtensionMethodNameLookupCache::GetNorlsAllocator()
     return m_cache.GetNorlsAllocator();
 }
 
+//============================================================================
+// LookupCache
+//============================================================================
+
+C_ASSERT(sizeof(LookupKey) % sizeof(size_t) == 0);
+
+LookupCache::LookupCache(NorlsAllocator *pAllocator) :
+    m_cache(pAllocator, 256)
+{
+}
+
+unsigned LookupCache::KeyOperations::hash(const LookupKey *pKey)
+{
+    // Keys are zero initialized and compared bytewise, so hashing the
+    // words of the key is consistent with comparing them.
+    const size_t *pWords = reinterpret_cast<const size_t *>(pKey);
+    size_t Hash = 0;
+
+    for (size_t i = 0; i < sizeof(LookupKey) / sizeof(size_t); i++)
+    {
+        Hash = MixCacheHash(Hash, pWords[i]);
+    }
+
+    return FoldCacheHash(Hash);
+}
+
+bool LookupCache::KeyOperations::equals
+(
+    const LookupKey *pKey1,
+    const LookupKey *pKey2
+)
+{
+    return memcmp(pKey1, pKey2, sizeof(LookupKey)) == 0;
+}
+
+bool LookupCache::Find
+(
+    const LookupKey *pKey,
+    _Out_ BCSYM_NamedRoot **ppResult,
+    _Out_ BCSYM_GenericBinding **ppGenericBindingContext
+)
+{
+    Result Cached;
+
+    if (m_cache.Find(pKey, &Cached))
+    {
+        *ppResult = Cached.Symbol;
+        *ppGenericBindingContext = Cached.GenericBindingContext;
+        return true;
+    }
+
+    *ppResult = NULL;
+    *ppGenericBindingContext = NULL;
+    return false;
+}
+
+void LookupCache::Insert
+(
+    const LookupKey *pKey,
+    BCSYM_NamedRoot *pResult,
+    BCSYM_GenericBinding *pGenericBindingContext
+)
+{
+    Result Cached;
+    Cached.Symbol = pResult;
+    Cached.GenericBindingContext = pGenericBindingContext;
+
+    m_cache.Insert(pKey, Cached);
+}
+
+//============================================================================
+// ConversionClassificationCache
+//============================================================================
+
+ConversionClassificationCache::ConversionClassificationCache(NorlsAllocator *pAllocator) :
+    m_cache(pAllocator, 512)
+{
+}
+
+unsigned ConversionClassificationCache::KeyOperations::hash(const Key *pKey)
+{
+    size_t Hash = MixCacheHash((size_t)pKey->TargetType, pKey->Flags);
+    Hash = MixCacheHash(Hash, (size_t)pKey->SourceType);
+
+    return FoldCacheHash(Hash);
+}
+
+bool ConversionClassificationCache::KeyOperations::equals
+(
+    const Key *pKey1,
+    const Key *pKey2
+)
+{
+    return
+        pKey1->TargetType == pKey2->TargetType &&
+        pKey1->SourceType == pKey2->SourceType &&
+        pKey1->Flags == pKey2->Flags;
+}
+
+bool ConversionClassificationCache::Find
+(
+    BCSYM *pTargetType,
+    BCSYM *pSourceType,
+    unsigned Flags,
+    _Out_ Classification *pResult
+)
+{
+    Key CacheKey;
+    CacheKey.TargetType = pTargetType;
+    CacheKey.SourceType = pSourceType;
+    CacheKey.Flags = Flags;
+
+    return m_cache.Find(&CacheKey, pResult);
+}
+
+void ConversionClassificationCache::Insert
+(
+    BCSYM *pTargetType,
+    BCSYM *pSourceType,
+    unsigned Flags,
+    const Classification &Result
+)
+{
+    Key CacheKey;
+    CacheKey.TargetType = pTargetType;
+    CacheKey.SourceType = pSourceType;
+    CacheKey.Flags = Flags;
+
+    m_cache.Insert(&CacheKey, Result);
+}
+
+//============================================================================
+// OverloadGroupIndexCache
+//============================================================================
+
+OverloadGroupIndexCache::OverloadGroupIndexCache(NorlsAllocator *pAllocator) :
+    m_cache(pAllocator, 256)
+{
+}
+
+unsigned OverloadGroupIndexCache::KeyOperations::hash(const Key *pKey)
+{
+    size_t Hash = MixCacheHash((size_t)pKey->FirstMember, pKey->ArgumentCount);
+    Hash = MixCacheHash(Hash, pKey->TypeArgumentCount);
+
+    return FoldCacheHash(Hash);
+}
+
+bool OverloadGroupIndexCache::KeyOperations::equals
+(
+    const Key *pKey1,
+    const Key *pKey2
+)
+{
+    return
+        pKey1->FirstMember == pKey2->FirstMember &&
+        pKey1->ArgumentCount == pKey2->ArgumentCount &&
+        pKey1->TypeArgumentCount == pKey2->TypeArgumentCount;
+}
+
+OverloadGroupIndex * OverloadGroupIndexCache::Find
+(
+    BCSYM_NamedRoot *pFirstMember,
+    unsigned ArgumentCount,
+    unsigned TypeArgumentCount
+)
+{
+    Key CacheKey;
+    CacheKey.FirstMember = pFirstMember;
+    CacheKey.ArgumentCount = ArgumentCount;
+    CacheKey.TypeArgumentCount = TypeArgumentCount;
+
+    OverloadGroupIndex *pIndex;
+
+    return m_cache.Find(&CacheKey, &pIndex) ? pIndex : NULL;
+}
+
+OverloadGroupIndex * OverloadGroupIndexCache::Insert
+(
+    BCSYM_NamedRoot *pFirstMember,
+    unsigned ArgumentCount,
+    unsigned TypeArgumentCount,
+    OverloadGroupIndex *pIndex
+)
+{
+    ThrowIfNull(pFirstMember);
+
+    Key CacheKey;
+    CacheKey.FirstMember = pFirstMember;
+    CacheKey.ArgumentCount = ArgumentCount;
+    CacheKey.TypeArgumentCount = TypeArgumentCount;
+
+    return m_cache.Insert(&CacheKey, pIndex);
+}
+
 CompilationCaches::CompilationCaches():
     m_nrlsCachedData(NORLSLOC),
     m_LookupCache(&m_nrlsCachedData),
@@ -395,7 +590,7 @@ void CompilationCaches::ValidateCaches(int  cacheType /*= 0*/)
     
     if (cacheType  & CompCacheType_LookUp)
     {
-        m_LookupCache.ValidateNodes();
+        m_LookupCache.ValidateEntries();
     }
     if (cacheType  & CompCacheType_Extension)
     {
@@ -430,19 +625,19 @@ bool AllocatorLifeTimeOk(NorlsAllocator *pRecordedAlloc, NorlsAllocator *pCompCa
 #endif NRLSTRACK
 
 
-template<> void LookupTree::ValidateNodes(void)
+void LookupCache::ValidateEntries(void)
 {
 #if NRLSTRACK
-    LookupTree::Iterator oLookupTreeIterator(this);
-    LookupNode *pLookupNode;
+    cache_type::Iterator iterator(&m_cache);
+    cache_type::Entry *pEntry;
 
-    for (long i = 0 ; (pLookupNode = oLookupTreeIterator.Next()) ; i++)
+    while ((pEntry = iterator.Next()) != NULL)
     {
-        if (pLookupNode->Result)
+        if (pEntry->Value.Symbol)
         {
-            if (!AllocatorLifeTimeOk(pLookupNode->Result->GetRecordedAllocator(), m_pNoReleaseAllocator))
+            if (!AllocatorLifeTimeOk(pEntry->Value.Symbol->GetRecordedAllocator(), m_cache.GetNorlsAllocator()))
             {
-                VSASSERT(false,"LookupTree Wrong allocator");
+                VSASSERT(false,"LookupCache Wrong allocator");
             }
         }
     }
@@ -525,28 +720,29 @@ template<> void NamespaceRingTree::ValidateNodes(void)
 
 #define TEMPBUFSIZE   2048* sizeof(WCHAR)      
 
-CComBSTR  LookupTree::GetNodeDump(_In_opt_ bool fOutputDebugWindow)
+CComBSTR  LookupCache::GetEntryDump(_In_opt_ bool fOutputDebugWindow)
 {
     CComBSTR bstrResult;
     WCHAR szBuffer[TEMPBUFSIZE];
 
-    LookupTree::Iterator oLookupTreeIterator(this);
-    LookupNode *pLookupNode;
-    
-    for (long i = 0 ; (pLookupNode = oLookupTreeIterator.Next()) ; i++)
+    cache_type::Iterator iterator(&m_cache);
+    cache_type::Entry *pEntry;
+    long i = 0;
+
+    while ((pEntry = iterator.Next()) != NULL)
     {
         StringBuffer sb;
-        if (pLookupNode->Result)
+        if (pEntry->Value.Symbol)
         {
             sb.AppendString(L"Found '");
-            pLookupNode->Result->GetBasicRep(GetCompilerPackage(), NULL, &sb);
+            pEntry->Value.Symbol->GetBasicRep(GetCompilerPackage(), NULL, &sb);
             sb.AppendString(L"'");
         }
 
-        StringCchPrintfW(szBuffer, sizeof(szBuffer), L" %4d  Sym='%ws'  Prj=(%ws): Scope=' %ws'%ws\r\n", i, 
-            pLookupNode->key.Name->m_spelling.m_str,
-            pLookupNode->key.m_pProject->GetFileNameWithNoPath(),
-            static_cast<Namespace *>( pLookupNode->key.Scope)->GetSimpleName(),
+        StringCchPrintfW(szBuffer, sizeof(szBuffer), L" %4d  Sym='%ws'  Prj=(%ws): Scope=' %ws'%ws\r\n", i++, 
+            pEntry->Key.Name->m_spelling.m_str,
+            pEntry->Key.m_pProject->GetFileNameWithNoPath(),
+            static_cast<Namespace *>( pEntry->Key.Scope)->GetSimpleName(),
             sb.GetString()
             );
 
@@ -686,8 +882,8 @@ CComBSTR NamespaceRingTree::GetNodeDump(_In_opt_ bool fOutputDebugWindow)
 void CompilationCaches::DumpStats()
 {
     DebPrintf("Lookup  ");
-    m_LookupCache.DumpTreeStats();
-    m_LookupCache.GetNodeDump(true);
+    m_LookupCache.DumpStats();
+    m_LookupCache.GetEntryDump(true);
         
     DebPrintf("ExtMthd ");
     m_ExtensionMethodLookupCache.m_cache.DumpTreeStats();
@@ -701,7 +897,7 @@ void CompilationCaches::DumpStats()
     m_MergedNamespaceCache.DumpTreeStats();
     m_MergedNamespaceCache.GetNodeDump(true);
 
-    m_LookupCache.ClearTreeStats();
+    m_LookupCache.ClearStats();
     m_ExtensionMethodLookupCache.m_cache.ClearTreeStats();
     m_LiftedOperatorCache.m_cache.ClearTreeStats();
     m_MergedNamespaceCache.ClearTreeStats();
@@ -759,7 +955,7 @@ CompilerProject::CompilerProject(Compiler * pCompiler)
 : m_ErrorTable(pCompiler, this, NULL)
 , m_norlsHashTables(NORLSLOC)
 , m_Friends(&m_norlsHashTables)
-, m_nraSymbols(NORLSLOC)
+, m_nraSymbols(NORLSLOC, g_pvbNorlsManager->GetSymbolPageHeap())
 , m_ShouldImportPrivates(true) // default to the safe setting (import everything)
 , m_CheckedAllMetadataFilesForAccessibility(false)
 
@@ -855,6 +1051,8 @@ CompilerProject::CompilerProject(Compiler * pCompiler)
 ,m_ImportsCache(&m_nrlsLookupCaches)
 ,m_ExtensionMethodLookupCache(&m_nrlsLookupCaches)
 ,m_LiftedOperatorCache(&m_nrlsLookupCaches)
+,m_ConversionCache(&m_nrlsLookupCaches)
+,m_OverloadGroupCache(&m_nrlsLookupCaches)
 ,m_SourceFileCache(pCompiler)
 ,m_LangVersion(LANGUAGE_CURRENT)
 ,m_PotentiallyEmbedsPiaTypes(false)
@@ -870,6 +1068,8 @@ CompilerProject::CompilerProject(Compiler * pCompiler)
 
 #if !IDE 
     m_pReferredToEmbeddableInteropType = NULL;
+    m_fUseBuildCache = false;
+    m_BuildCacheOptionsHash = 0;
 #endif
 
     m_subsystemVersion.major = 0;
@@ -2637,6 +2837,11 @@ STDMETHODIMP CompilerProject::SetCompilerOptionsInternal
 
         m_bIsHighEntropyVA = pCompilerOptions->bHighEntropyVA;
 
+#if !IDE
+        // Whether the build cache is used at all is up to the host, see SetUseBuildCache.
+        m_BuildCacheOptionsHash = IncrementalBuildCache::HashCompilerOptions(pCompilerOptions);
+#endif !IDE
+
         if (!pCompilerOptions->wszSubsystemVersion)
         {
             bool fIsArmOrAppContainerExeOrWinMDObj = (MapStringToPlatformKind(pCompilerOptions->wszPlatformType) == Platform_ARM || pCompilerOptions->OutputType == OUTPUT_AppContainerEXE || pCompilerOptions->OutputType == OUTPUT_WinMDObj);
@@ -7864,6 +8069,8 @@ void CompilerProject::ClearParseTreeCaches()
     SourceFileView* pFileView;
     while ( pfile = sfi.Next() )
     {
+        pfile->GetMethodBodyParseCache()->Clear();
+
         pFileView = pfile->GetSourceFileView();
         if (pFileView)
         {
@@ -12910,6 +13117,22 @@ WCHAR *CompilerProject::ProjectLevelImportsList::GetOriginalImportStringByIndex(
     return pCurrentImportInfo->m_OriginalImportString;
 }
 
+#if !IDE
+UINT64 CompilerProject::ProjectLevelImportsList::GetImportsHash()
+{
+    UINT64 Hash = 0;
+
+    for (ProjectLevelImportInfo *pCurrentImportInfo = m_pProjectLevelImportInfos;
+         pCurrentImportInfo;
+         pCurrentImportInfo = pCurrentImportInfo->m_Next)
+    {
+        Hash = IncrementalBuildCache::HashString(Hash, pCurrentImportInfo->m_OriginalImportString);
+    }
+
+    return Hash;
+}
+#endif !IDE
+
 /* End - Implementation for ProjectLevelImportsList */
 
 WARNING_LEVEL CompilerProject::GetWarningLevel
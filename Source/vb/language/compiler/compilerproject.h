@@ -432,37 +432,248 @@ struct LookupKey
     CompilerProject *m_pProject;
 };
 
-struct LookupKeyOperations :
-    public SimpleKeyOperationsT<LookupKey>
+//============================================================================
+// Cache of the results of name lookups in namespaces. Entries are kept in
+// an OpenAddressingCacheT, so lookups take no lock.
+//
+// Clear drops all entries at once; their storage is reclaimed when the
+// owner frees the allocator, as it does when compilation state is lost.
+//============================================================================
+class LookupCache
+{
+public:
+    LookupCache(NorlsAllocator *pAllocator);
+
+    NorlsAllocator * GetNorlsAllocator()
+    {
+        return m_cache.GetNorlsAllocator();
+    }
+
+    bool Find
+    (
+        const LookupKey *pKey,
+        _Out_ BCSYM_NamedRoot **ppResult,
+        _Out_ BCSYM_GenericBinding **ppGenericBindingContext
+    );
+
+    // Adds the result of a lookup. If the key is already present the
+    // existing result is kept.
+    void Insert
+    (
+        const LookupKey *pKey,
+        BCSYM_NamedRoot *pResult,
+        BCSYM_GenericBinding *pGenericBindingContext
+    );
+
+    void Clear()
+    {
+        m_cache.Clear();
+    }
+
+    void ClearStats()
+    {
+        m_cache.ClearStats();
+    }
+
+#if DEBUG
+    CComBSTR GetEntryDump(_In_opt_ bool fOutputDebugWindow); // dump the contents into a string
+    void ValidateEntries();     // assert on the entries
+    void DumpStats()
+    {
+        m_cache.DumpStats();
+    }
+#endif DEBUG
+
+private:
+    struct Result
+    {
+        BCSYM_NamedRoot *Symbol;
+        BCSYM_GenericBinding *GenericBindingContext;
+    };
+
+    struct KeyOperations
+    {
+        static unsigned hash(const LookupKey *pKey);
+        static bool equals(const LookupKey *pKey1, const LookupKey *pKey2);
+    };
+
+    typedef OpenAddressingCacheT<LookupKey, Result, KeyOperations> cache_type;
+
+    cache_type m_cache;
+};
+
+//============================================================================
+// Cache of conversion classifications between pairs of types.
+//
+// Overload resolution classifies the conversions between the same pairs of
+// types over and over again. Only types that are canonical symbols are
+// cached (see Semantics::ClassifyConversion), so the pair of symbol
+// pointers identifies the conversion. The cache is cleared together with
+// LookupCache when compilation state is lost.
+//============================================================================
+class ConversionClassificationCache
 {
-    int compare(const LookupKey *pKey1, const LookupKey *pKey2)
+public:
+    // The outputs of a classification. Conversion and RelaxationLevel hold
+    // a ConversionClass and a DelegateRelaxationLevel, which are declared
+    // with Semantics.
+    struct Classification
+    {
+        BCSYM_Proc *OperatorMethod;
+        unsigned char Conversion;
+        unsigned char RelaxationLevel;
+        bool ConsideredOperatorMethods;     // OperatorMethod is meaningful
+        bool OperatorMethodIsLifted;
+        bool RequiresUnliftedAccessToNullableValue;
+        bool IsNarrowingDueToAmbiguity;
+    };
+
+    // Flags that, together with the types, make up the key.
+    enum KeyFlags
+    {
+        ConsiderConversionsOnNullableBool = 0x1,
+        IgnoreOperatorMethod = 0x2
+    };
+
+    ConversionClassificationCache(NorlsAllocator *pAllocator);
+
+    bool Find
+    (
+        BCSYM *pTargetType,
+        BCSYM *pSourceType,
+        unsigned Flags,
+        _Out_ Classification *pResult
+    );
+
+    void Insert
+    (
+        BCSYM *pTargetType,
+        BCSYM *pSourceType,
+        unsigned Flags,
+        const Classification &Result
+    );
+
+    void Clear()
+    {
+        m_cache.Clear();
+    }
+
+#if DEBUG
+    void DumpStats()
     {
-        return memcmp(pKey1, pKey2, sizeof(LookupKey));
+        m_cache.DumpStats();
+        m_cache.ClearStats();
     }
+#endif DEBUG
+
+private:
+    struct Key
+    {
+        BCSYM *TargetType;
+        BCSYM *SourceType;
+        unsigned Flags;
+    };
+
+    struct KeyOperations
+    {
+        static unsigned hash(const Key *pKey);
+        static bool equals(const Key *pKey1, const Key *pKey2);
+    };
+
+    typedef OpenAddressingCacheT<Key, Classification, KeyOperations> cache_type;
+
+    cache_type m_cache;
 };
 
-struct LookupNode :
-    public RedBlackNodeBaseT<LookupKey>
+//============================================================================
+// The members of a method group in one container that overload resolution
+// walks for a given number of arguments and type arguments, with the
+// parameter counts it checks first. Members that are not procedures are
+// left out.
+//
+// The members that can take the counts come first, then the ones that
+// cannot, each part in declaration order. Once overload resolution knows
+// that some member was rejected for its counts, it only walks the first
+// part.
+//============================================================================
+struct OverloadGroupIndex
 {
-    BCSYM_NamedRoot *Result;
-    BCSYM_GenericBinding *GenericBindingContext;
+    struct Entry
+    {
+        BCSYM_NamedRoot *Member;    // may be an alias of the procedure
+        unsigned RequiredParameterCount;
+        unsigned MaximumParameterCount;
+        bool HasParamArray;
+    };
+
+    unsigned EntryCount;
+    unsigned ApplicableEntryCount;  // entries that can take the counts
+    Entry Entries[1];
 };
 
-struct LookupNodeOperations :
-    public EmptyNodeOperationsT<LookupNode>
+//============================================================================
+// Cache of the overload group indexes of method groups, keyed by the first
+// member of the group and the argument and type argument counts of the
+// call. Cleared together with LookupCache.
+//============================================================================
+class OverloadGroupIndexCache
 {
-    void copy(LookupNode *pNodeDest, const LookupNode *pNodeSrc)
+public:
+    OverloadGroupIndexCache(NorlsAllocator *pAllocator);
+
+    NorlsAllocator * GetNorlsAllocator()
     {
-        pNodeDest->Result = pNodeSrc->Result;
-        pNodeDest->GenericBindingContext = pNodeSrc->GenericBindingContext;
+        return m_cache.GetNorlsAllocator();
     }
-};
 
-typedef RedBlackTreeT<
-    LookupKey,
-    LookupKeyOperations,
-    LookupNode,
-    LookupNodeOperations> LookupTree;
+    OverloadGroupIndex * Find
+    (
+        BCSYM_NamedRoot *pFirstMember,
+        unsigned ArgumentCount,
+        unsigned TypeArgumentCount
+    );
+
+    // Adds the index of a method group. If the group already has an index
+    // for the counts that one is kept and returned.
+    OverloadGroupIndex * Insert
+    (
+        BCSYM_NamedRoot *pFirstMember,
+        unsigned ArgumentCount,
+        unsigned TypeArgumentCount,
+        OverloadGroupIndex *pIndex
+    );
+
+    void Clear()
+    {
+        m_cache.Clear();
+    }
+
+#if DEBUG
+    void DumpStats()
+    {
+        m_cache.DumpStats();
+        m_cache.ClearStats();
+    }
+#endif DEBUG
+
+private:
+    struct Key
+    {
+        BCSYM_NamedRoot *FirstMember;
+        unsigned ArgumentCount;
+        unsigned TypeArgumentCount;
+    };
+
+    struct KeyOperations
+    {
+        static unsigned hash(const Key *pKey);
+        static bool equals(const Key *pKey1, const Key *pKey2);
+    };
+
+    typedef OpenAddressingCacheT<Key, OverloadGroupIndex *, KeyOperations> cache_type;
+
+    cache_type m_cache;
+};
 
 // Merging of the namespace symbols happens at the compilerhost level. While calculating the
 // merged hash of a namespace ring, only symbols in the current CompilerHost are added to this
@@ -552,7 +763,7 @@ public:
     ~CompilationCaches();
 
 
-    LookupTree *GetLookupCache()
+    LookupCache *GetLookupCache()
     {
         return &m_LookupCache;
     }
@@ -582,7 +793,7 @@ public:
 #endif DEBUG
 
 private:
-    LookupTree m_LookupCache;
+    LookupCache m_LookupCache;
     ExtensionMethodNameLookupCache m_ExtensionMethodLookupCache;
     LiftedUserDefinedOperatorCache m_LiftedOperatorCache;
     NamespaceRingTree m_MergedNamespaceCache;
@@ -2733,10 +2944,41 @@ private:
 
     SubsystemVersion m_subsystemVersion;
 
+#if !IDE
+    // Whether the output is skipped when the incremental build cache says
+    // that it is up to date, and the hash of the options it is keyed on.
+    bool m_fUseBuildCache;
+    UINT64 m_BuildCacheOptionsHash;
+
+    friend class IncrementalBuildCache;
+#endif !IDE
+
 public:
 
     bool IsHighEntropyVA(){ return m_bIsHighEntropyVA;}
 
+#if !IDE
+    bool UseBuildCache()
+    {
+        return m_fUseBuildCache && !m_fMetaData;
+    }
+
+    // The incremental build cache is off unless the host opts in for the
+    // project. It is separate from the compiler options so that hosts that
+    // do not know about it never skip writing their outputs.
+    void SetUseBuildCache(bool fUseBuildCache)
+    {
+        m_fUseBuildCache = fUseBuildCache;
+    }
+
+    // Project-level imports are not part of the compiler options, so
+    // they are folded in here.
+    UINT64 GetBuildCacheOptionsHash()
+    {
+        return m_BuildCacheOptionsHash ^ m_Imports.GetImportsHash();
+    }
+#endif !IDE
+
     SubsystemVersion GetSubsystemVersion() { return m_subsystemVersion; }
 		
     bool IsDefaultVBRuntime();
@@ -3001,6 +3243,11 @@ private:
 
         WCHAR *GetOriginalImportStringByIndex(unsigned Index);
 
+#if !IDE
+        // Hash of the import strings, for the incremental build cache.
+        UINT64 GetImportsHash();
+#endif !IDE
+
       private:
         struct ProjectLevelImportInfo
         {
@@ -3352,7 +3599,7 @@ public:
         return &m_ExtensionMethodExistsCache;
     }
 
-    LookupTree *GetLookupCache()
+    LookupCache *GetLookupCache()
     {
         return &m_LookupCache;
     }
@@ -3367,12 +3614,33 @@ public:
         return &m_LiftedOperatorCache;
     }
 
+    ConversionClassificationCache * GetConversionCache()
+    {
+        return &m_ConversionCache;
+    }
+
+    OverloadGroupIndexCache * GetOverloadGroupCache()
+    {
+        return &m_OverloadGroupCache;
+    }
+
     void ClearLookupCaches()
     {
+#if DEBUG
+        if (VSFSWITCH(fCompCaches))
+        {
+            DebPrintf("Convrsn ");
+            m_ConversionCache.DumpStats();
+            DebPrintf("OvrldGrp ");
+            m_OverloadGroupCache.DumpStats();
+        }
+#endif DEBUG
         m_LookupCache.Clear();
         m_ImportsCache.Clear();
         m_ExtensionMethodLookupCache.Clear();
         m_LiftedOperatorCache.Clear();
+        m_ConversionCache.Clear();
+        m_OverloadGroupCache.Clear();
         m_nrlsLookupCaches.FreeHeap();   
     }
 
@@ -3414,7 +3682,7 @@ public:
 private:
     NorlsAllocator m_nrlsLookupCaches;
 
-    LookupTree m_LookupCache;
+    LookupCache m_LookupCache;
     ResolvedImportsTree m_ImportsCache;
     ExtensionMethodNameLookupCache m_ExtensionMethodLookupCache;
     // When metadata is loaded, every method that has the extension attribute is added to this cache.  This cache is not used to speed up extension
@@ -3424,6 +3692,8 @@ private:
     // Note, this cache does not return the extension method symbol, it only answers whether the project contains an extension method with this name.
     HashSet<STRING_INFO*> m_ExtensionMethodExistsCache; // Entry for existence of an extension method with the name    
     LiftedUserDefinedOperatorCache m_LiftedOperatorCache;
+    ConversionClassificationCache m_ConversionCache;
+    OverloadGroupIndexCache m_OverloadGroupCache;
 
     // The declaration type refs are populated when going to Declared state.
     HashSet<BCSYM*> m_DeclarationPiaTypeRefCache;
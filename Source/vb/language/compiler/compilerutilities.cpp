@@ -1453,12 +1453,48 @@ HRESULT ParseCodeBlock(
 
         BCSYM_Container *pProjectLevelCondCompScope = pSourceFile ? pSourceFile->GetProject()->GetProjectLevelCondCompScope() : NULL;
 
-        IfFailGo(methodBodyParser.ParseMethodBody(&tsBody,
-            perrortable,
-            pProjectLevelCondCompScope,
-            pConditionalCompilationConstants,
-            MethodBodyKind,
-            pptree));
+        // Bodies whose text is unchanged since they were last parsed cleanly are
+        // expanded from the file's cache instead of being parsed again.
+        MethodBodyParseCache *pBodyCache = NULL;
+        MethodBodyParseCache::BodyKey BodyCacheKey = { NULL };
+
+        if (pSourceFile && pptree && MethodBodyParseCache::IsCacheable(wszText, cchText))
+        {
+            pBodyCache = pSourceFile->GetMethodBodyParseCache();
+            MethodBodyParseCache::MakeKey(
+                wszText,
+                cchText,
+                pCodeBlock->m_lBegColumn,
+                MethodBodyKind,
+                methodDeclKind,
+                IsXMLDocOn,
+                pSourceFile->GetProject()->GetCompilingLanguageVersion(),
+                &BodyCacheKey);
+
+            *pptree = pBodyCache->TryExpand(BodyCacheKey, pCodeBlock->m_lBegLine, pnra);
+        }
+
+        if (pBodyCache == NULL || *pptree == NULL)
+        {
+            unsigned DiagnosticCount = perrortable ? perrortable->GetErrorCount() + perrortable->GetWarningCount() : 0;
+
+            IfFailGo(methodBodyParser.ParseMethodBody(&tsBody,
+                perrortable,
+                pProjectLevelCondCompScope,
+                pConditionalCompilationConstants,
+                MethodBodyKind,
+                pptree));
+
+            // Only bodies that produced no diagnostics are cached, since the
+            // diagnostics would not be reported again when the body is reused.
+            if (pBodyCache &&
+                *pptree &&
+                perrortable &&
+                DiagnosticCount == perrortable->GetErrorCount() + perrortable->GetWarningCount())
+            {
+                pBodyCache->Add(BodyCacheKey, pCodeBlock->m_lBegLine, *pptree);
+            }
+        }
 
         // if the method definition is necesary for method signature location, reparse it.
         if (pProcBlock && pptree && *pptree)
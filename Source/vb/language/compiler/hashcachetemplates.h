@@ -0,0 +1,299 @@
+//-------------------------------------------------------------------------------------------------
+//
+//  Copyright (c) Microsoft Corporation.  All rights reserved.
+//
+//  Open Addressing Cache Template.
+//
+//-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//============================================================================
+// Hash helpers for KeyOperations of OpenAddressingCacheT. Keys made of
+// pointers and small integers are hashed by mixing their words in turn and
+// folding the result once at the end.
+//============================================================================
+inline size_t MixCacheHash(size_t Hash, size_t Word)
+{
+    return (Hash ^ Word) * (size_t)0x9E3779B97F4A7C15ui64;
+}
+
+inline unsigned FoldCacheHash(size_t Hash)
+{
+#ifdef _WIN64
+    Hash ^= Hash >> 32;
+#endif
+
+    return (unsigned)Hash;
+}
+
+//============================================================================
+// OpenAddressingCacheT:
+//
+//      Hash table with open addressing and linear probing, for caches that
+//      are read much more often than they are written.
+//
+//      Lookups take no lock: an entry is published by storing its hash after
+//      the rest of it, and a table that is outgrown stays in place on the
+//      cache's allocator, so a reader still probing it remains valid. Inserts
+//      are serialized.
+//
+//      Clear drops all entries at once; their storage is reclaimed when the
+//      owner frees the allocator.
+//
+//      KeyOperations supplies:
+//          static unsigned hash(const KeyType *pKey);
+//          static bool equals(const KeyType *pKey1, const KeyType *pKey2);
+//============================================================================
+template <typename KeyType, typename ValueType, typename KeyOperations>
+class OpenAddressingCacheT
+{
+public:
+    struct Entry
+    {
+        volatile unsigned Hash;     // 0 until the entry is published
+        KeyType Key;
+        ValueType Value;
+    };
+
+private:
+    struct Table
+    {
+        unsigned Mask;              // capacity - 1; capacity is a power of 2
+        Entry Entries[1];
+    };
+
+public:
+    //========================================================================
+    // Visits the published entries of the table that is current when the
+    // iterator is created.
+    //========================================================================
+    class Iterator
+    {
+    public:
+        Iterator(OpenAddressingCacheT *pCache) :
+            m_pTable(pCache->m_pTable),
+            m_iEntry(0)
+        {
+        }
+
+        Entry * Next()
+        {
+            while (m_pTable && m_iEntry <= m_pTable->Mask)
+            {
+                Entry *pEntry = &m_pTable->Entries[m_iEntry++];
+
+                if (pEntry->Hash != 0)
+                {
+                    return pEntry;
+                }
+            }
+
+            return NULL;
+        }
+
+    private:
+        Table *m_pTable;
+        unsigned m_iEntry;
+    };
+
+    OpenAddressingCacheT
+    (
+        NorlsAllocator *pAllocator,
+        unsigned InitialCapacity
+    ) :
+        m_pAllocator(pAllocator),
+        m_InitialCapacity(InitialCapacity),
+        m_pTable(NULL),
+        m_cEntries(0),
+        m_cHits(0),
+        m_cMisses(0)
+    {
+        ThrowIfNull(pAllocator);
+        VSASSERT(InitialCapacity > 1 && (InitialCapacity & (InitialCapacity - 1)) == 0,
+            "The capacity of the table must be a power of 2");
+    }
+
+    NorlsAllocator * GetNorlsAllocator()
+    {
+        return m_pAllocator;
+    }
+
+    bool Find
+    (
+        const KeyType *pKey,
+        _Out_ ValueType *pValue
+    )
+    {
+        Table *pTable = m_pTable;
+
+        if (pTable)
+        {
+            Entry *pEntry = Probe(pTable, pKey, HashKey(pKey));
+
+            if (pEntry->Hash != 0)
+            {
+                m_cHits++;
+                *pValue = pEntry->Value;
+                return true;
+            }
+        }
+
+        m_cMisses++;
+        return false;
+    }
+
+    // Adds an entry. If the key is already present the existing value is
+    // kept. Returns the value in the table.
+    ValueType Insert
+    (
+        const KeyType *pKey,
+        const ValueType &Value
+    )
+    {
+        CTinyGate gate(&m_InsertLock);
+
+        // Keep the table at most half full so probe sequences stay short.
+        if (!m_pTable || (m_cEntries + 1) * 2 > m_pTable->Mask + 1)
+        {
+            Grow();
+        }
+
+        unsigned Hash = HashKey(pKey);
+        Entry *pEntry = Probe(m_pTable, pKey, Hash);
+
+        if (pEntry->Hash != 0)
+        {
+            return pEntry->Value;
+        }
+
+        pEntry->Key = *pKey;
+        pEntry->Value = Value;
+
+        // Publish the entry to lookups on other threads.
+        MemoryBarrier();
+        pEntry->Hash = Hash;
+        m_cEntries++;
+
+        return Value;
+    }
+
+    void Clear()
+    {
+        CTinyGate gate(&m_InsertLock);
+
+        m_pTable = NULL;
+        m_cEntries = 0;
+    }
+
+    unsigned GetEntryCount()
+    {
+        return m_cEntries;
+    }
+
+    unsigned GetCapacity()
+    {
+        Table *pTable = m_pTable;
+        return pTable ? pTable->Mask + 1 : 0;
+    }
+
+    // Statistics. These are not synchronized and are approximate when
+    // several threads use the cache.
+    unsigned GetHitCount()
+    {
+        return m_cHits;
+    }
+
+    unsigned GetMissCount()
+    {
+        return m_cMisses;
+    }
+
+    void ClearStats()
+    {
+        m_cHits = 0;
+        m_cMisses = 0;
+    }
+
+#if DEBUG
+    void DumpStats()
+    {
+        DebPrintf("Entries=%u Capacity=%u Hits=%u Misses=%u\n",
+            m_cEntries,
+            GetCapacity(),
+            m_cHits,
+            m_cMisses);
+    }
+#endif DEBUG
+
+private:
+    static unsigned HashKey(const KeyType *pKey)
+    {
+        unsigned Hash = KeyOperations::hash(pKey);
+
+        // 0 marks an empty entry.
+        return Hash ? Hash : 1;
+    }
+
+    // Returns the entry holding the key, or the empty entry where it belongs.
+    static Entry * Probe
+    (
+        Table *pTable,
+        const KeyType *pKey,
+        unsigned Hash
+    )
+    {
+        for (unsigned i = Hash & pTable->Mask; ; i = (i + 1) & pTable->Mask)
+        {
+            Entry *pEntry = &pTable->Entries[i];
+            unsigned EntryHash = pEntry->Hash;
+
+            if (EntryHash == 0 ||
+                (EntryHash == Hash && KeyOperations::equals(&pEntry->Key, pKey)))
+            {
+                return pEntry;
+            }
+        }
+    }
+
+    Table * AllocateTable(unsigned Capacity)
+    {
+        Table *pTable = (Table *)m_pAllocator->Alloc(
+            VBMath::Add(sizeof(Table), VBMath::Multiply(sizeof(Entry), Capacity - 1)));
+
+        pTable->Mask = Capacity - 1;
+        return pTable;
+    }
+
+    void Grow()
+    {
+        Table *pOldTable = m_pTable;
+        Table *pNewTable = AllocateTable(pOldTable ? (pOldTable->Mask + 1) * 2 : m_InitialCapacity);
+
+        if (pOldTable)
+        {
+            for (unsigned i = 0; i <= pOldTable->Mask; i++)
+            {
+                Entry *pOldEntry = &pOldTable->Entries[i];
+
+                if (pOldEntry->Hash != 0)
+                {
+                    *Probe(pNewTable, &pOldEntry->Key, pOldEntry->Hash) = *pOldEntry;
+                }
+            }
+        }
+
+        // The old table is left intact for lookups that are still probing it.
+        MemoryBarrier();
+        m_pTable = pNewTable;
+    }
+
+    NorlsAllocator *m_pAllocator;
+    unsigned m_InitialCapacity;
+    Table * volatile m_pTable;
+    unsigned m_cEntries;
+    CTinyLock m_InsertLock;
+
+    unsigned m_cHits;
+    unsigned m_cMisses;
+};
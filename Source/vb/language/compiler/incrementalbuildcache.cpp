@@ -0,0 +1,665 @@
+//-------------------------------------------------------------------------------------------------
+//
+//  Copyright (c) Microsoft Corporation.  All rights reserved.
+//
+//  Content-hash based incremental build cache for the command-line compiler.
+//
+//-------------------------------------------------------------------------------------------------
+
+#include "StdAfx.h"
+
+#if !IDE
+
+#define BUILD_CACHE_EXTENSION WIDE(".vbcache")
+
+IncrementalBuildCache::IncrementalBuildCache(_In_ CompilerProject * pProject) :
+    m_pCompiler(pProject->GetCompiler()),
+    m_pProject(pProject),
+    m_fInputsComputed(false),
+    m_SourcesHash(0),
+    m_ReferencesHash(0)
+{
+    VSASSERT(!pProject->IsMetaData(), "Metadata projects are never built!");
+}
+
+//============================================================================
+// Does the cache file of the project match its current inputs and output?
+//============================================================================
+bool IncrementalBuildCache::IsUpToDate()
+{
+    STRING *pstrPEName = m_pProject->GetPEName();
+    CacheRecord record;
+    CacheRecord current;
+
+    // Every output the options ask for must still be the one that was built,
+    // not just the assembly; a missing or rewritten PDB or XML doc file means
+    // the project has to be compiled again.
+    if (!pstrPEName ||
+        m_pProject->OutputIsNone() ||
+        !ReadRecord(GetCacheFileName(m_pCompiler, pstrPEName), &record) ||
+        !GetOutputTimestamps(&current) ||
+        CompareFileTime(&current.OutputTimestamp, &record.OutputTimestamp) != 0 ||
+        CompareFileTime(&current.PdbTimestamp, &record.PdbTimestamp) != 0 ||
+        CompareFileTime(&current.XMLDocTimestamp, &record.XMLDocTimestamp) != 0)
+    {
+        return false;
+    }
+
+    if (record.OptionsHash != m_pProject->GetBuildCacheOptionsHash() || !ComputeInputs())
+    {
+        return false;
+    }
+
+    return record.SourcesHash == m_SourcesHash &&
+           record.ReferencesHash == m_ReferencesHash;
+}
+
+//============================================================================
+// Records the inputs and the public surface of a project that was
+// successfully compiled to disk.
+//============================================================================
+void IncrementalBuildCache::Save()
+{
+    STRING *pstrPEName = m_pProject->GetPEName();
+
+    if (!pstrPEName || m_pProject->OutputIsNone())
+    {
+        return;
+    }
+
+    STRING *pstrCacheFileName = GetCacheFileName(m_pCompiler, pstrPEName);
+    CacheRecord record;
+
+    memset(&record, 0, sizeof(record));
+
+    // If any of the inputs cannot be hashed, leave no cache behind so that the
+    // next build does not mistake a stale record for an up-to-date one.
+    if (!ComputeInputs() || !GetOutputTimestamps(&record))
+    {
+        DeleteFileW(pstrCacheFileName);
+        return;
+    }
+
+    // Source references have been rebuilt since IsUpToDate looked at them.
+    m_ReferencesHash = ComputeReferencesHash();
+
+    record.Signature = CacheSignature;
+    record.Version = CacheVersion;
+    record.OptionsHash = m_pProject->GetBuildCacheOptionsHash();
+    record.SourcesHash = m_SourcesHash;
+    record.ReferencesHash = m_ReferencesHash;
+    record.SurfaceFingerprint = ComputeSurfaceFingerprint();
+
+    HANDLE hFile = CreateFileW(
+        pstrCacheFileName,
+        GENERIC_WRITE,
+        0, NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        DWORD BytesWritten = 0;
+        bool ShouldDeleteFile =
+            !WriteFile(hFile, &record, sizeof(record), &BytesWritten, NULL) ||
+            BytesWritten != sizeof(record);
+
+        CloseHandle(hFile);
+
+        if (ShouldDeleteFile)
+        {
+            DeleteFileW(pstrCacheFileName);
+        }
+    }
+}
+
+//============================================================================
+// Gets the public surface fingerprint recorded for a previously built assembly.
+// The record is only trusted if the assembly has not been rewritten since.
+//============================================================================
+bool IncrementalBuildCache::TryGetSurfaceFingerprint
+(
+    Compiler * pCompiler,
+    _In_z_ STRING * pstrAssemblyPath,
+    _Out_ UINT64 * pFingerprint
+)
+{
+    CacheRecord record;
+    FILETIME timeAssembly;
+
+    *pFingerprint = 0;
+
+    if (!ReadRecord(GetCacheFileName(pCompiler, pstrAssemblyPath), &record) ||
+        !GetLastWriteTime(pstrAssemblyPath, &timeAssembly) ||
+        CompareFileTime(&timeAssembly, &record.OutputTimestamp) != 0)
+    {
+        return false;
+    }
+
+    *pFingerprint = record.SurfaceFingerprint;
+    return true;
+}
+
+//============================================================================
+// Folds the options that affect the generated output into a hash.
+//============================================================================
+UINT64 IncrementalBuildCache::HashCompilerOptions
+(
+    _In_ VbCompilerOptions * pCompilerOptions
+)
+{
+    CRC64 crc;
+
+    crc.Update(&pCompilerOptions->OutputType);
+    crc.Update(&pCompilerOptions->bDelaySign);
+    crc.Update(&pCompilerOptions->bGeneratePdbOnly);
+    crc.Update(&pCompilerOptions->bGenerateSymbolInfo);
+    crc.Update(&pCompilerOptions->bHighEntropyVA);
+    crc.Update(&pCompilerOptions->bNoStandardLibs);
+    crc.Update(&pCompilerOptions->bOptimize);
+    crc.Update(&pCompilerOptions->bOptionCompareText);
+    crc.Update(&pCompilerOptions->bOptionExplicitOff);
+    crc.Update(&pCompilerOptions->bOptionInferOff);
+    crc.Update(&pCompilerOptions->bOptionStrictOff);
+    crc.Update(&pCompilerOptions->bRemoveIntChecks);
+    crc.Update(&pCompilerOptions->dwAlign);
+    crc.Update(&pCompilerOptions->dwDefaultCodePage);
+    crc.Update(&pCompilerOptions->dwLoadAddress);
+    crc.Update(&pCompilerOptions->langVersion);
+    crc.Update(&pCompilerOptions->vbRuntimeKind);
+    crc.Update(&pCompilerOptions->WarningLevel);
+
+    if (pCompilerOptions->cWarnItems && pCompilerOptions->warningsLevelTable)
+    {
+        crc.Update(
+            pCompilerOptions->warningsLevelTable,
+            pCompilerOptions->cWarnItems * sizeof(pCompilerOptions->warningsLevelTable[0]));
+    }
+
+    UINT64 Hash = crc;
+
+    Hash = HashString(Hash, pCompilerOptions->wszCondComp);
+    Hash = HashString(Hash, pCompilerOptions->wszDefaultNamespace);
+    Hash = HashString(Hash, pCompilerOptions->wszExeName);
+    Hash = HashString(Hash, pCompilerOptions->wszIconFile);
+    Hash = HashString(Hash, pCompilerOptions->wszOutputPath);
+    Hash = HashString(Hash, pCompilerOptions->wszPlatformType);
+    Hash = HashString(Hash, pCompilerOptions->wszSpecifiedVBRuntime);
+    Hash = HashString(Hash, pCompilerOptions->wszStartup);
+    Hash = HashString(Hash, pCompilerOptions->wszStrongNameContainer);
+    Hash = HashString(Hash, pCompilerOptions->wszStrongNameKeyFile);
+    Hash = HashString(Hash, pCompilerOptions->wszSubsystemVersion);
+    Hash = HashString(Hash, pCompilerOptions->wszUacManifestFile);
+    Hash = HashString(Hash, pCompilerOptions->wszWin32ResFile);
+    Hash = HashString(Hash, pCompilerOptions->wszXMLDocName);
+
+    return Hash;
+}
+
+UINT64 IncrementalBuildCache::HashString
+(
+    UINT64 Seed,
+    _In_opt_z_ const WCHAR * wszValue
+)
+{
+    CRC64 crc(Seed);
+
+    if (wszValue)
+    {
+        crc.Update(wszValue, (unsigned)(wcslen(wszValue) * sizeof(WCHAR)));
+    }
+
+    // Terminate every value so that adjacent strings cannot alias each other.
+    crc.Update((BYTE)0);
+    crc.Update((BYTE)0);
+
+    return crc;
+}
+
+STRING * IncrementalBuildCache::GetCacheFileName
+(
+    Compiler * pCompiler,
+    _In_z_ STRING * pstrAssemblyPath
+)
+{
+    return pCompiler->ConcatStrings(pstrAssemblyPath, BUILD_CACHE_EXTENSION);
+}
+
+bool IncrementalBuildCache::ReadRecord
+(
+    _In_z_ STRING * pstrCacheFileName,
+    _Out_ CacheRecord * pRecord
+)
+{
+    bool fRead = false;
+
+    memset(pRecord, 0, sizeof(*pRecord));
+
+    HANDLE hFile = CreateFileW(
+        pstrCacheFileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        DWORD BytesRead = 0;
+
+        fRead = ReadFile(hFile, pRecord, sizeof(*pRecord), &BytesRead, NULL) &&
+                BytesRead == sizeof(*pRecord) &&
+                pRecord->Signature == CacheSignature &&
+                pRecord->Version == CacheVersion;
+
+        CloseHandle(hFile);
+    }
+
+    return fRead;
+}
+
+bool IncrementalBuildCache::GetLastWriteTime
+(
+    _In_z_ const WCHAR * wszFileName,
+    _Out_ FILETIME * pTime
+)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+    if (!GetFileAttributesExW(wszFileName, GetFileExInfoStandard, &attributes))
+    {
+        memset(pTime, 0, sizeof(FILETIME));
+        return false;
+    }
+
+    *pTime = attributes.ftLastWriteTime;
+    return true;
+}
+
+//============================================================================
+// Folds the name, length and timestamp of a file that is read while
+// emitting the assembly into a hash, so that editing the file in place
+// invalidates the cache.  No file name hashes like an empty one.  Fails if
+// the file cannot be found.
+//============================================================================
+bool IncrementalBuildCache::HashInputFile
+(
+    UINT64 Seed,
+    _In_opt_z_ const WCHAR * wszFileName,
+    _Out_ UINT64 * pHash
+)
+{
+    CRC64 crc(HashString(Seed, wszFileName));
+
+    if (wszFileName && wszFileName[0])
+    {
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+        if (!GetFileAttributesExW(wszFileName, GetFileExInfoStandard, &attributes))
+        {
+            *pHash = 0;
+            return false;
+        }
+
+        crc.Update(&attributes.nFileSizeHigh);
+        crc.Update(&attributes.nFileSizeLow);
+        crc.Update(&attributes.ftLastWriteTime);
+    }
+
+    *pHash = crc;
+    return true;
+}
+
+//============================================================================
+// Gets the timestamps of the assembly and of the PDB and XML doc files that
+// the options ask for.  Outputs that are not generated get a zero timestamp.
+// Fails if any of the generated outputs is missing.
+//============================================================================
+bool IncrementalBuildCache::GetOutputTimestamps(_Out_ CacheRecord * pRecord)
+{
+    STRING *pstrPEName = m_pProject->GetPEName();
+
+    memset(&pRecord->OutputTimestamp, 0, sizeof(FILETIME));
+    memset(&pRecord->PdbTimestamp, 0, sizeof(FILETIME));
+    memset(&pRecord->XMLDocTimestamp, 0, sizeof(FILETIME));
+
+    if (!GetLastWriteTime(pstrPEName, &pRecord->OutputTimestamp))
+    {
+        return false;
+    }
+
+    if (m_pProject->GeneratePDB())
+    {
+        WCHAR drive[_MAX_DRIVE];
+        WCHAR dir[_MAX_DIR];
+        size_t SizeOfPEName = StringPool::StringLength(pstrPEName);
+
+        TEMPBUF(fname, WCHAR *, (SizeOfPEName+1)*sizeof(WCHAR));
+        IfNullThrow(fname);
+        // Make sure there's enough room for .pdb
+        TEMPBUF(wszPdbName, WCHAR *, (SizeOfPEName+5)*sizeof(WCHAR));
+        IfNullThrow(wszPdbName);
+
+        _wsplitpath_s(pstrPEName, drive, _countof(drive), dir, _countof(dir), fname, SizeOfPEName+1, NULL,0);
+
+#pragma warning (push)
+#pragma warning (disable:6387) // NULL check for wszPdbName is above
+        _wmakepath_s(wszPdbName, SizeOfPEName+5, drive, dir, fname, L".pdb");
+#pragma warning (pop)
+
+        if (!GetLastWriteTime(wszPdbName, &pRecord->PdbTimestamp))
+        {
+            return false;
+        }
+    }
+
+    if (m_pProject->IsXMLDocCommentsOn() &&
+        !GetLastWriteTime(m_pProject->GetXMLDocFileName(), &pRecord->XMLDocTimestamp))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool IncrementalBuildCache::ComputeInputs()
+{
+    if (!m_fInputsComputed)
+    {
+        if (!ComputeSourcesHash(&m_SourcesHash))
+        {
+            return false;
+        }
+
+        m_ReferencesHash = ComputeReferencesHash();
+        m_fInputsComputed = true;
+    }
+
+    return true;
+}
+
+//============================================================================
+// Hashes the content of every source file, the location and timestamp of
+// every resource, and the length and timestamp of the Win32 resource, icon,
+// strong name key and manifest files of the project.
+//============================================================================
+bool IncrementalBuildCache::ComputeSourcesHash(_Out_ UINT64 * pHash)
+{
+    BYTE rgbFileHash[CRYPT_HASHSIZE];
+    UINT64 Hash = 0;
+    SourceFile *pSourceFile;
+
+    *pHash = 0;
+
+    SourceFileIterator files(m_pProject);
+    while (pSourceFile = files.Next())
+    {
+        if (!pSourceFile->GetTextFile() ||
+            FAILED(pSourceFile->GetTextFile()->GetCryptHash(rgbFileHash, CRYPT_HASHSIZE)))
+        {
+            return false;
+        }
+
+        CRC64 crc(HashString(Hash, pSourceFile->GetFileName()));
+        crc.Update(rgbFileHash, sizeof(rgbFileHash));
+        Hash = crc;
+    }
+
+    for (ULONG i = 0; i < m_pProject->m_daResources.Count(); i++)
+    {
+        Resource *pResource = &m_pProject->m_daResources.Array()[i];
+        FILETIME timeResource;
+
+        if (!GetLastWriteTime(pResource->m_pstrFile, &timeResource))
+        {
+            return false;
+        }
+
+        CRC64 crc(HashString(HashString(Hash, pResource->m_pstrFile), pResource->m_pstrName));
+        crc.Update(&pResource->m_fPublic);
+        crc.Update(&pResource->m_fEmbed);
+        crc.Update(&timeResource);
+        Hash = crc;
+    }
+
+    // A key file named by an AssemblyKeyFile attribute is only known once the
+    // project has been compiled, after IsUpToDate has run, so such projects
+    // are not cached.
+    if (m_pProject->m_fKeyFileFromAttr ||
+        !HashInputFile(Hash, m_pProject->m_pstrWin32ResourceFile, &Hash) ||
+        !HashInputFile(Hash, m_pProject->m_pstrWin32IconFile, &Hash) ||
+        !HashInputFile(Hash, m_pProject->m_pstrUacManifestFile, &Hash) ||
+        !HashInputFile(Hash, m_pProject->m_pstrProjectSettingForKeyFileName, &Hash))
+    {
+        return false;
+    }
+
+    *pHash = Hash;
+    return true;
+}
+
+//============================================================================
+// Hashes the identity of every referenced assembly.  Assemblies that were
+// built with a cache contribute their surface fingerprint, so rebuilding
+// them without changing their public surface does not invalidate us.
+//============================================================================
+UINT64 IncrementalBuildCache::ComputeReferencesHash()
+{
+    UINT64 Hash = 0;
+    CompilerProject *pReferencedProject;
+
+    ReferenceIterator references(m_pProject);
+    while (pReferencedProject = references.Next())
+    {
+        STRING *pstrAssemblyPath =
+            pReferencedProject->IsMetaData() ?
+                pReferencedProject->GetFileName() :
+                pReferencedProject->GetPEName();
+        UINT64 SurfaceFingerprint = 0;
+
+        CRC64 crc(HashString(Hash, pReferencedProject->GetAssemblyIdentity()->GetAssemblyName()));
+
+        if (pstrAssemblyPath &&
+            TryGetSurfaceFingerprint(m_pCompiler, pstrAssemblyPath, &SurfaceFingerprint))
+        {
+            crc.Update(&SurfaceFingerprint);
+        }
+        else if (pReferencedProject->IsMetaData())
+        {
+            crc.Update(pReferencedProject->GetAssemblyIdentity()->GetMVID());
+        }
+        // A source reference without a cache is rebuilt in this compilation
+        // anyway, so its name alone is enough; it records its fingerprint
+        // before we record ours.
+
+        Hash = crc;
+    }
+
+    return Hash;
+}
+
+//============================================================================
+// Computes an order independent fingerprint of the identity of the project
+// and of the declarations and attributes that are visible to other
+// assemblies.  Method bodies, private members and the order of declarations
+// do not contribute to it.
+//============================================================================
+UINT64 IncrementalBuildCache::ComputeSurfaceFingerprint()
+{
+    UINT64 Fingerprint = ComputeIdentityHash();
+    bool fContainsExtensionMethods = false;
+    StringBuffer Buffer;
+    SourceFile *pSourceFile;
+
+    SourceFileIterator files(m_pProject);
+    while (pSourceFile = files.Next())
+    {
+        if (pSourceFile->ContainsExtensionMethods())
+        {
+            fContainsExtensionMethods = true;
+        }
+
+        // Assembly and module level attributes live on the root namespace.
+        if (pSourceFile->GetRootNamespace())
+        {
+            Fingerprint += HashAttributes(pSourceFile->GetRootNamespace(), NULL, &Buffer) * 7;
+        }
+
+        AllContainersInFileInOrderIterator containers(pSourceFile);
+        BCSYM_Container *pContainer;
+
+        while (pContainer = containers.Next())
+        {
+            if (pContainer->IsNamespace() || !IsVisibleOutsideAssembly(pContainer))
+            {
+                continue;
+            }
+
+            Fingerprint += HashSymbol(pContainer, pContainer->GetContainer(), &Buffer);
+            Fingerprint += HashAttributes(pContainer, pContainer->GetContainer(), &Buffer) * 11;
+
+            if (pContainer->IsClass())
+            {
+                BCSYM *pBase = pContainer->PClass()->GetBaseClass();
+
+                if (pBase && !pBase->IsBad())
+                {
+                    Fingerprint += HashSymbol(pBase, pContainer, &Buffer) * 3;
+                }
+            }
+
+            for (BCSYM_Implements *pImplements = pContainer->GetFirstImplements();
+                 pImplements;
+                 pImplements = pImplements->GetNext())
+            {
+                Fingerprint += HashSymbol(pImplements->GetRoot(), pContainer, &Buffer) * 5;
+            }
+
+            BCITER_CHILD members(pContainer);
+            BCSYM_NamedRoot *pMember;
+
+            while (pMember = members.GetNext())
+            {
+                if (!pMember->IsContainer() && pMember->IsOrCouldBePublic())
+                {
+                    Fingerprint += HashSymbol(pMember, pContainer, &Buffer);
+                    Fingerprint += HashAttributes(pMember, pContainer, &Buffer) * 13;
+                }
+            }
+        }
+    }
+
+    // The extension attribute is emitted on the assembly without being applied in source.
+    if (fContainsExtensionMethods)
+    {
+        Fingerprint += 17;
+    }
+
+    return Fingerprint;
+}
+
+//============================================================================
+// Hashes the full identity of the assembly: name, version, culture, public
+// key and assembly flags.  Dependents bind to all of these, so a change to
+// any of them must invalidate them even if no declaration changed.
+//============================================================================
+UINT64 IncrementalBuildCache::ComputeIdentityHash()
+{
+    AssemblyIdentity *pIdentity = m_pProject->GetAssemblyIdentity();
+
+    CRC64 crc(HashString(0, pIdentity->GetAssemblyInfoString()));
+
+    int AssemblyFlags = pIdentity->GetAssemblyFlags();
+    crc.Update(&AssemblyFlags);
+
+    if (pIdentity->GetPublicKeySize() != 0)
+    {
+        crc.Update(pIdentity->GetPublicKeyBlob(), (unsigned)pIdentity->GetPublicKeySize());
+    }
+
+    return crc;
+}
+
+UINT64 IncrementalBuildCache::HashSymbol
+(
+    BCSYM * pSymbol,
+    BCSYM_Container * pContext,
+    _Inout_ StringBuffer * pBuffer
+)
+{
+    pBuffer->Clear();
+    pSymbol->GetBasicRep(m_pCompiler, pContext, pBuffer);
+
+    CRC64 crc(pBuffer->GetString(), (unsigned)pBuffer->GetByteLength());
+
+    if (pSymbol->IsNamedRoot())
+    {
+        ACCESS Access = pSymbol->PNamedRoot()->GetAccess();
+        crc.Update(&Access);
+
+        if (pContext)
+        {
+            STRING *pstrContext = pContext->GetQualifiedName();
+            crc.Update(pstrContext, (unsigned)(StringPool::StringLength(pstrContext) * sizeof(WCHAR)));
+        }
+    }
+
+    return crc;
+}
+
+//============================================================================
+// Computes an order independent hash of the attributes applied to a symbol:
+// the attribute type, its arguments and its target.
+//============================================================================
+UINT64 IncrementalBuildCache::HashAttributes
+(
+    BCSYM * pSymbol,
+    BCSYM_Container * pContext,
+    _Inout_ StringBuffer * pBuffer
+)
+{
+    UINT64 Hash = 0;
+    BCITER_ApplAttrs attributes(pSymbol);
+    BCSYM_ApplAttr *pApplAttr;
+
+    while (pApplAttr = attributes.GetNext())
+    {
+        BCSYM *pAttributeClass = pApplAttr->GetAttributeSymbol();
+
+        if (pApplAttr->IsBadApplAttr() || !pAttributeClass || pAttributeClass->IsBad())
+        {
+            continue;
+        }
+
+        CRC64 crc(HashSymbol(pAttributeClass, pContext, pBuffer));
+        bool fAssembly = pApplAttr->IsAssembly();
+        bool fModule = pApplAttr->IsModule();
+        crc.Update(&fAssembly);
+        crc.Update(&fModule);
+
+        Hash += HashString(
+            crc,
+            pApplAttr->GetExpression() ? pApplAttr->GetExpression()->GetExpressionText() : NULL);
+    }
+
+    return Hash;
+}
+
+bool IncrementalBuildCache::IsVisibleOutsideAssembly(BCSYM_NamedRoot * pNamed)
+{
+    while (pNamed && !pNamed->IsNamespace())
+    {
+        if (!pNamed->IsOrCouldBePublic())
+        {
+            return false;
+        }
+
+        pNamed = pNamed->GetContainer();
+    }
+
+    return true;
+}
+
+#endif !IDE
@@ -0,0 +1,109 @@
+//-------------------------------------------------------------------------------------------------
+//
+//  Copyright (c) Microsoft Corporation.  All rights reserved.
+//
+//  Content-hash based incremental build cache for the command-line compiler.
+//
+//  Each source project records, in a file next to its output assembly, the hashes of its
+//  sources, its compiler options and its references together with a fingerprint of its
+//  public surface.  When all of these match the project does not need to be recompiled.
+//
+//  References to assemblies that were themselves built with a cache are keyed by their
+//  surface fingerprint instead of their MVID, so a change that only touches method bodies
+//  does not force the projects that depend on it to be rebuilt.
+//
+//-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#if !IDE
+
+class IncrementalBuildCache
+{
+public:
+    IncrementalBuildCache(_In_ CompilerProject * pProject);
+
+    // Does the cache file of the project match its current inputs and output?
+    bool IsUpToDate();
+
+    // Records the inputs and the public surface of a project that was
+    // successfully compiled to disk.
+    void Save();
+
+    // Gets the public surface fingerprint recorded for a previously built assembly.
+    static bool TryGetSurfaceFingerprint(
+        Compiler * pCompiler,
+        _In_z_ STRING * pstrAssemblyPath,
+        _Out_ UINT64 * pFingerprint);
+
+    // Folds the options that affect the generated output into a hash.
+    static UINT64 HashCompilerOptions(_In_ VbCompilerOptions * pCompilerOptions);
+
+    static UINT64 HashString(
+        UINT64 Seed,
+        _In_opt_z_ const WCHAR * wszValue);
+
+private:
+    static const DWORD CacheSignature = 0x43424256;    // "VBBC"
+    static const DWORD CacheVersion = 3;
+
+    struct CacheRecord
+    {
+        DWORD Signature;
+        DWORD Version;
+        UINT64 OptionsHash;
+        UINT64 SourcesHash;
+        UINT64 ReferencesHash;
+        UINT64 SurfaceFingerprint;
+        FILETIME OutputTimestamp;
+        FILETIME PdbTimestamp;
+        FILETIME XMLDocTimestamp;
+    };
+
+    static STRING * GetCacheFileName(
+        Compiler * pCompiler,
+        _In_z_ STRING * pstrAssemblyPath);
+
+    static bool ReadRecord(
+        _In_z_ STRING * pstrCacheFileName,
+        _Out_ CacheRecord * pRecord);
+
+    static bool GetLastWriteTime(
+        _In_z_ const WCHAR * wszFileName,
+        _Out_ FILETIME * pTime);
+
+    static bool HashInputFile(
+        UINT64 Seed,
+        _In_opt_z_ const WCHAR * wszFileName,
+        _Out_ UINT64 * pHash);
+
+    static bool IsVisibleOutsideAssembly(BCSYM_NamedRoot * pNamed);
+
+    bool GetOutputTimestamps(_Out_ CacheRecord * pRecord);
+
+    bool ComputeInputs();
+    bool ComputeSourcesHash(_Out_ UINT64 * pHash);
+    UINT64 ComputeReferencesHash();
+    UINT64 ComputeSurfaceFingerprint();
+
+    UINT64 ComputeIdentityHash();
+
+    UINT64 HashSymbol(
+        BCSYM * pSymbol,
+        BCSYM_Container * pContext,
+        _Inout_ StringBuffer * pBuffer);
+
+    UINT64 HashAttributes(
+        BCSYM * pSymbol,
+        BCSYM_Container * pContext,
+        _Inout_ StringBuffer * pBuffer);
+
+    Compiler * m_pCompiler;
+    CompilerProject * m_pProject;
+
+    bool m_fInputsComputed;
+    UINT64 m_SourcesHash;
+    UINT64 m_ReferencesHash;
+};
+
+#endif !IDE
@@ -53,6 +53,9 @@
 #define CLOSURE_MYSTUB_PREFIX           L"$VB$ClosureStub_"
 #define CLOSURE_MYSTUB_PREFIX_LENGTH    16
 
+#define CLOSURE_CACHEDLAMBDA_PREFIX         L"$VB$CachedLambda_"
+#define CLOSURE_CACHEDLAMBDA_PREFIX_LENGTH  17
+
 class ClosureHelpers
 {
 public:
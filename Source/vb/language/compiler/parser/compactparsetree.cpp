@@ -0,0 +1,2202 @@
+//-------------------------------------------------------------------------------------------------
+//
+//  Copyright (c) Microsoft Corporation.  All rights reserved.
+//
+//  Implements the compact serialized form of method body parse trees.
+//
+//  Layout of the stream (all integers are LEB128 varints, signed values zigzag encoded):
+//
+//      method body fields
+//      statement count
+//      for each statement, in lexical order:
+//          index of the parent block (0 is the method body, statements are numbered from 1)
+//          colon punctuator of its statement list entry
+//          statement fields
+//
+//  Nested nodes (expressions, types, names, initializers) are written inline, prefixed by
+//  their opcode plus one so that 0 can stand for NULL.  Each location is written as the
+//  delta of its begin line from the begin line of the previous location, followed by its
+//  begin column, its line count and its end column.
+//
+//-------------------------------------------------------------------------------------------------
+
+#include "StdAfx.h"
+
+//-------------------------------------------------------------------------------------------------
+//
+// CompactParseTreeWriter
+//
+//-------------------------------------------------------------------------------------------------
+
+class CompactParseTreeWriter
+{
+public:
+    CompactParseTreeWriter(_In_ NorlsAllocator * pScratch) :
+        m_IdentifierIndices(NorlsAllocWrapper(pScratch)),
+        m_StatementIndices(NorlsAllocWrapper(pScratch)),
+        m_LastChildren(NorlsAllocWrapper(pScratch)),
+        m_PreviousLine(0),
+        m_cStatements(0),
+        m_Supported(true)
+    {
+    }
+
+    CompactParseTree * Write(
+        _In_ ParseTree::MethodBodyStatement * pBody,
+        _In_ NorlsAllocator * pStorage);
+
+private:
+    bool NumberStatements(_In_ ParseTree::MethodBodyStatement * pBody);
+
+    void Decline()
+    {
+        m_Supported = false;
+    }
+
+    void WriteByte(BYTE Value)
+    {
+        m_Data.AddElement(Value);
+    }
+
+    void WriteBytes(
+        _In_bytecount_(cbValue) const void * pValue,
+        size_t cbValue)
+    {
+        const BYTE * pBytes = (const BYTE *)pValue;
+
+        for (size_t i = 0; i < cbValue; i++)
+        {
+            m_Data.AddElement(pBytes[i]);
+        }
+    }
+
+    void WriteUnsigned(unsigned __int64 Value)
+    {
+        while (Value >= 0x80)
+        {
+            WriteByte((BYTE)(Value | 0x80));
+            Value >>= 7;
+        }
+
+        WriteByte((BYTE)Value);
+    }
+
+    void WriteSigned(__int64 Value)
+    {
+        WriteUnsigned(((unsigned __int64)Value << 1) ^ (unsigned __int64)(Value >> 63));
+    }
+
+    void WriteBool(bool Value)
+    {
+        WriteByte(Value ? 1 : 0);
+    }
+
+    void WriteLocation(const Location & Loc);
+    void WritePunctuator(const ParseTree::PunctuatorLocation & Punctuator);
+    void WriteIdentifierName(_In_opt_ STRING * pName);
+    void WriteIdentifier(const ParseTree::IdentifierDescriptor & Identifier);
+    void WriteStatementReference(_In_opt_ ParseTree::Statement * pStatement);
+    void WriteComments(_In_opt_ ParseTree::CommentList * pComments);
+
+    void WriteStatement(_In_ ParseTree::Statement * pStatement);
+    void WriteBlock(_In_ ParseTree::BlockStatement * pBlock);
+    void WriteExecutableBlock(_In_ ParseTree::ExecutableBlockStatement * pBlock);
+    void WriteExpressionBlock(_In_ ParseTree::ExpressionBlockStatement * pBlock);
+
+    void WriteExpression(_In_opt_ ParseTree::Expression * pExpression);
+    void WriteArguments(const ParseTree::ParenthesizedArgumentList & Arguments);
+    void WriteType(_In_opt_ ParseTree::Type * pType);
+    void WriteName(_In_opt_ ParseTree::Name * pName);
+    void WriteSpecifiers(_In_opt_ ParseTree::SpecifierList * pSpecifiers);
+    void WriteDeclarations(_In_opt_ ParseTree::VariableDeclarationList * pDeclarations);
+    void WriteInitializer(_In_opt_ ParseTree::Initializer * pInitializer);
+
+    template <class ElementType, class ListType>
+    void WriteListNode(_In_ ParseTree::List<ElementType, ListType> * pNode)
+    {
+        WriteLocation(pNode->TextSpan);
+        WritePunctuator(pNode->Punctuator);
+    }
+
+    DynamicArray<BYTE> m_Data;
+    DynamicArray<STRING *> m_Identifiers;
+    DynamicArray<ParseTree::StatementList *> m_Statements;
+    DynamicHashTable<STRING *, unsigned, NorlsAllocWrapper> m_IdentifierIndices;
+    DynamicHashTable<ParseTree::Statement *, unsigned, NorlsAllocWrapper> m_StatementIndices;
+    DynamicHashTable<ParseTree::Statement *, ParseTree::StatementList *, NorlsAllocWrapper> m_LastChildren;
+
+    long m_PreviousLine;
+    unsigned m_cStatements;
+    bool m_Supported;
+};
+
+// Numbers the statements of the body in lexical order and checks that the
+// block structure can be rebuilt from the lexical order alone.
+
+bool
+CompactParseTreeWriter::NumberStatements
+(
+    _In_ ParseTree::MethodBodyStatement * pBody
+)
+{
+    m_StatementIndices.SetValue(pBody, 0);
+
+    for (ParseTree::StatementList * pList = pBody->Children; pList; pList = pList->NextLexical)
+    {
+        ParseTree::Statement * pStatement = pList->Element;
+        ParseTree::BlockStatement * pParent = pStatement ? pStatement->GetRawParent() : NULL;
+
+        if (pStatement == NULL ||
+            pParent == NULL ||
+            pStatement->ContainingList != pList ||
+            !m_StatementIndices.Contains(pParent))
+        {
+            return false;
+        }
+
+        ParseTree::StatementList * pPreviousChild = m_LastChildren.GetValueOrDefault(pParent, NULL);
+
+        if (pList->PreviousInBlock != pPreviousChild ||
+            (pPreviousChild == NULL && pParent->Children != pList))
+        {
+            return false;
+        }
+
+        m_LastChildren.SetValue(pParent, pList);
+        m_StatementIndices.SetValue(pStatement, ++m_cStatements);
+        m_Statements.AddElement(pList);
+    }
+
+    return true;
+}
+
+CompactParseTree *
+CompactParseTreeWriter::Write
+(
+    _In_ ParseTree::MethodBodyStatement * pBody,
+    _In_ NorlsAllocator * pStorage
+)
+{
+    if (pBody->HasSyntaxError ||
+        pBody->XmlRoots ||
+        pBody->ContainsLambdaExpression ||
+        pBody->ContainsQueryExpression ||
+        pBody->ContainsAnonymousTypeInitialization ||
+        !NumberStatements(pBody))
+    {
+        return NULL;
+    }
+
+    WriteUnsigned(pBody->Opcode);
+    WriteLocation(pBody->TextSpan);
+    WriteBool(pBody->IsFirstOnLine);
+    WriteComments(pBody->Comments);
+    WriteExecutableBlock(pBody);
+    WriteUnsigned(pBody->DefinedLabelCount);
+    WriteUnsigned(pBody->OnErrorHandlerCount);
+    WriteUnsigned(pBody->OnErrorResumeCount);
+    WriteUnsigned(pBody->ResumeTargetCount);
+    WriteBool(pBody->IsEmpty);
+    WriteBool(pBody->ProcedureContainsTry);
+    WriteBool(pBody->ProcedureContainsOnError);
+    WriteBool(pBody->ProcedureContainsResume);
+
+    WriteUnsigned(m_cStatements);
+
+    for (unsigned i = 0; i < m_Statements.Count() && m_Supported; i++)
+    {
+        ParseTree::StatementList * pList = m_Statements.Element(i);
+
+        WriteUnsigned(m_StatementIndices.GetValue(pList->Element->GetRawParent()));
+        WritePunctuator(pList->Colon);
+        WriteStatement(pList->Element);
+    }
+
+    if (!m_Supported)
+    {
+        return NULL;
+    }
+
+    CompactParseTree * pCompact = new(*pStorage) CompactParseTree;
+
+    pCompact->m_cbData = m_Data.Count();
+    pCompact->m_cStatements = m_cStatements;
+    pCompact->m_cIdentifiers = m_Identifiers.Count();
+
+    BYTE * pData = pStorage->AllocArray<BYTE>(m_Data.Count());
+    memcpy(pData, m_Data.Array(), m_Data.Count());
+    pCompact->m_pData = pData;
+
+    pCompact->m_Identifiers = pStorage->AllocArray<STRING *>(m_Identifiers.Count());
+    memcpy(pCompact->m_Identifiers, m_Identifiers.Array(), m_Identifiers.Count() * sizeof(STRING *));
+
+    return pCompact;
+}
+
+void
+CompactParseTreeWriter::WriteLocation
+(
+    const Location & Loc
+)
+{
+    WriteSigned((__int64)Loc.m_lBegLine - m_PreviousLine);
+    WriteSigned(Loc.m_lBegColumn);
+    WriteSigned((__int64)Loc.m_lEndLine - Loc.m_lBegLine);
+    WriteSigned(Loc.m_lEndColumn);
+
+    m_PreviousLine = Loc.m_lBegLine;
+}
+
+void
+CompactParseTreeWriter::WritePunctuator
+(
+    const ParseTree::PunctuatorLocation & Punctuator
+)
+{
+    WriteSigned(Punctuator.Line);
+    WriteSigned(Punctuator.Column);
+}
+
+void
+CompactParseTreeWriter::WriteIdentifierName
+(
+    _In_opt_ STRING * pName
+)
+{
+    if (pName == NULL)
+    {
+        WriteUnsigned(0);
+        return;
+    }
+
+    unsigned Index = 0;
+
+    if (!m_IdentifierIndices.GetValue(pName, &Index))
+    {
+        m_Identifiers.AddElement(pName);
+        Index = m_Identifiers.Count();
+        m_IdentifierIndices.SetValue(pName, Index);
+    }
+
+    WriteUnsigned(Index);
+}
+
+void
+CompactParseTreeWriter::WriteIdentifier
+(
+    const ParseTree::IdentifierDescriptor & Identifier
+)
+{
+    WriteIdentifierName(Identifier.Name);
+    WriteUnsigned(Identifier.TypeCharacter);
+    WriteByte(
+        (Identifier.IsBracketed ? 1 : 0) |
+        (Identifier.IsBad ? 2 : 0) |
+        (Identifier.IsNullable ? 4 : 0));
+    WriteLocation(Identifier.TextSpan);
+}
+
+void
+CompactParseTreeWriter::WriteStatementReference
+(
+    _In_opt_ ParseTree::Statement * pStatement
+)
+{
+    unsigned Index = 0;
+
+    if (pStatement &&
+        (!m_StatementIndices.GetValue(pStatement, &Index) || Index == 0))
+    {
+        // References outside the body, or to the body itself, do not occur in
+        // the supported constructs.
+        Decline();
+    }
+
+    WriteUnsigned(Index);
+}
+
+void
+CompactParseTreeWriter::WriteComments
+(
+    _In_opt_ ParseTree::CommentList * pComments
+)
+{
+    WriteUnsigned(ParseTree::CountElements(pComments));
+
+    for (ParseTree::CommentList * pNode = pComments; pNode; pNode = pNode->Next)
+    {
+        ParseTree::Comment * pComment = pNode->Element;
+
+        WriteListNode(pNode);
+        WriteLocation(pComment->TextSpan);
+        WriteUnsigned(pComment->LengthInCharacters);
+
+        for (size_t i = 0; i < pComment->LengthInCharacters; i++)
+        {
+            WriteUnsigned(pComment->Spelling[i]);
+        }
+
+        WriteBool(pComment->IsRem);
+        WriteBool(pComment->IsGeneratedFromXMLDocToken);
+    }
+}
+
+void
+CompactParseTreeWriter::WriteBlock
+(
+    _In_ ParseTree::BlockStatement * pBlock
+)
+{
+    WriteStatementReference(pBlock->TerminatingConstruct);
+    WriteBool(pBlock->HasProperTermination);
+    WriteBool(pBlock->IsOrContainedByExceptionContext);
+    WriteLocation(pBlock->BodyTextSpan);
+}
+
+void
+CompactParseTreeWriter::WriteExecutableBlock
+(
+    _In_ ParseTree::ExecutableBlockStatement * pBlock
+)
+{
+    WriteBlock(pBlock);
+    WriteUnsigned(pBlock->LocalsCount);
+}
+
+void
+CompactParseTreeWriter::WriteExpressionBlock
+(
+    _In_ ParseTree::ExpressionBlockStatement * pBlock
+)
+{
+    WriteExecutableBlock(pBlock);
+    WriteExpression(pBlock->Operand);
+}
+
+void
+CompactParseTreeWriter::WriteStatement
+(
+    _In_ ParseTree::Statement * pStatement
+)
+{
+    if (pStatement->HasSyntaxError || pStatement->XmlRoots)
+    {
+        Decline();
+        return;
+    }
+
+    WriteUnsigned(pStatement->Opcode);
+    WriteLocation(pStatement->TextSpan);
+    WriteByte(
+        (pStatement->IsFirstOnLine ? 1 : 0) |
+        (pStatement->ContainsAnonymousTypeInitialization ? 2 : 0) |
+        (pStatement->ContainsQueryExpression ? 4 : 0) |
+        (pStatement->ContainsLambdaExpression ? 8 : 0));
+    WriteUnsigned(pStatement->ResumeIndex);
+    WriteComments(pStatement->Comments);
+
+    switch (pStatement->Opcode)
+    {
+        case ParseTree::Statement::Empty:
+        case ParseTree::Statement::Stop:
+        case ParseTree::Statement::End:
+        case ParseTree::Statement::ContinueDo:
+        case ParseTree::Statement::ContinueFor:
+        case ParseTree::Statement::ContinueWhile:
+        case ParseTree::Statement::ContinueUnknown:
+        case ParseTree::Statement::ContinueInvalid:
+        case ParseTree::Statement::ExitDo:
+        case ParseTree::Statement::ExitFor:
+        case ParseTree::Statement::ExitSub:
+        case ParseTree::Statement::ExitFunction:
+        case ParseTree::Statement::ExitOperator:
+        case ParseTree::Statement::ExitProperty:
+        case ParseTree::Statement::ExitTry:
+        case ParseTree::Statement::ExitSelect:
+        case ParseTree::Statement::ExitWhile:
+        case ParseTree::Statement::ExitUnknown:
+        case ParseTree::Statement::ExitInvalid:
+            break;
+
+        case ParseTree::Statement::EndIf:
+        case ParseTree::Statement::EndUsing:
+        case ParseTree::Statement::EndWith:
+        case ParseTree::Statement::EndSelect:
+        case ParseTree::Statement::EndStructure:
+        case ParseTree::Statement::EndEnum:
+        case ParseTree::Statement::EndInterface:
+        case ParseTree::Statement::EndClass:
+        case ParseTree::Statement::EndModule:
+        case ParseTree::Statement::EndNamespace:
+        case ParseTree::Statement::EndSub:
+        case ParseTree::Statement::EndFunction:
+        case ParseTree::Statement::EndGet:
+        case ParseTree::Statement::EndSet:
+        case ParseTree::Statement::EndProperty:
+        case ParseTree::Statement::EndOperator:
+        case ParseTree::Statement::EndEvent:
+        case ParseTree::Statement::EndAddHandler:
+        case ParseTree::Statement::EndRemoveHandler:
+        case ParseTree::Statement::EndRaiseEvent:
+        case ParseTree::Statement::EndWhile:
+        case ParseTree::Statement::EndLoop:
+        case ParseTree::Statement::EndTry:
+        case ParseTree::Statement::EndSyncLock:
+        case ParseTree::Statement::EndUnknown:
+        case ParseTree::Statement::EndInvalid:
+            WritePunctuator(pStatement->AsEndBlock()->Punctuator);
+            break;
+
+        case ParseTree::Statement::EndLoopWhile:
+        case ParseTree::Statement::EndLoopUntil:
+            WriteExpression(pStatement->AsBottomTestLoop()->Operand);
+            WritePunctuator(pStatement->AsBottomTestLoop()->WhileOrUntil);
+            break;
+
+        case ParseTree::Statement::Return:
+        case ParseTree::Statement::Error:
+        case ParseTree::Statement::Throw:
+        case ParseTree::Statement::Await:
+        case ParseTree::Statement::Yield:
+            WriteExpression(pStatement->AsExpression()->Operand);
+            break;
+
+        case ParseTree::Statement::Label:
+        case ParseTree::Statement::Goto:
+            WriteIdentifier(pStatement->AsLabelReference()->Label);
+            WriteBool(pStatement->AsLabelReference()->LabelIsLineNumber);
+            break;
+
+        case ParseTree::Statement::Call:
+        {
+            ParseTree::CallStatement * pCall = pStatement->AsCall();
+
+            WriteExpression(pCall->Target);
+            WriteArguments(pCall->Arguments);
+            WritePunctuator(pCall->LeftParenthesis);
+            WriteBool(pCall->CallIsExplicit);
+            break;
+        }
+
+        case ParseTree::Statement::Assign:
+        case ParseTree::Statement::AssignPlus:
+        case ParseTree::Statement::AssignMinus:
+        case ParseTree::Statement::AssignMultiply:
+        case ParseTree::Statement::AssignDivide:
+        case ParseTree::Statement::AssignPower:
+        case ParseTree::Statement::AssignIntegralDivide:
+        case ParseTree::Statement::AssignConcatenate:
+        case ParseTree::Statement::AssignShiftLeft:
+        case ParseTree::Statement::AssignShiftRight:
+            WriteExpression(pStatement->AsAssignment()->Target);
+            WriteExpression(pStatement->AsAssignment()->Source);
+            WritePunctuator(pStatement->AsAssignment()->Operator);
+            break;
+
+        case ParseTree::Statement::AddHandler:
+        case ParseTree::Statement::RemoveHandler:
+            WriteExpression(pStatement->AsHandler()->Event);
+            WriteExpression(pStatement->AsHandler()->Delegate);
+            WritePunctuator(pStatement->AsHandler()->Comma);
+            break;
+
+        case ParseTree::Statement::VariableDeclaration:
+            if (pStatement->AsVariableDeclaration()->Attributes)
+            {
+                Decline();
+                break;
+            }
+
+            WriteSpecifiers(pStatement->AsVariableDeclaration()->Specifiers);
+            WriteDeclarations(pStatement->AsVariableDeclaration()->Declarations);
+            break;
+
+        case ParseTree::Statement::BlockIf:
+        case ParseTree::Statement::LineIf:
+            WriteExpressionBlock(pStatement->AsIf());
+            WritePunctuator(pStatement->AsIf()->Then);
+            break;
+
+        case ParseTree::Statement::ElseIf:
+            WriteExpressionBlock(pStatement->AsElseIf());
+            WritePunctuator(pStatement->AsElseIf()->Then);
+            WriteStatementReference(pStatement->AsElseIf()->ContainingIf);
+            break;
+
+        case ParseTree::Statement::BlockElse:
+        case ParseTree::Statement::LineElse:
+            WriteExecutableBlock(pStatement->AsElse());
+            WriteStatementReference(pStatement->AsElse()->ContainingIf);
+            break;
+
+        case ParseTree::Statement::Try:
+            WriteExecutableBlock(pStatement->AsExecutableBlock());
+            break;
+
+        case ParseTree::Statement::Catch:
+        {
+            ParseTree::CatchStatement * pCatch = pStatement->AsCatch();
+
+            WriteExecutableBlock(pCatch);
+            WriteIdentifier(pCatch->Name);
+            WriteType(pCatch->Type);
+            WriteExpression(pCatch->WhenClause);
+            WritePunctuator(pCatch->As);
+            WritePunctuator(pCatch->When);
+            WriteStatementReference(pCatch->ContainingTry);
+            break;
+        }
+
+        case ParseTree::Statement::Finally:
+            WriteExecutableBlock(pStatement->AsFinally());
+            WriteStatementReference(pStatement->AsFinally()->ContainingTry);
+            break;
+
+        case ParseTree::Statement::While:
+        case ParseTree::Statement::DoWhileBottomTest:
+        case ParseTree::Statement::DoUntilBottomTest:
+        case ParseTree::Statement::DoForever:
+        case ParseTree::Statement::With:
+        case ParseTree::Statement::SyncLock:
+            WriteExpressionBlock(pStatement->AsExpressionBlock());
+            break;
+
+        case ParseTree::Statement::DoWhileTopTest:
+        case ParseTree::Statement::DoUntilTopTest:
+            WriteExpressionBlock(pStatement->AsTopTestDo());
+            WritePunctuator(pStatement->AsTopTestDo()->WhileOrUntil);
+            break;
+
+        default:
+            // For, Select, Using, On Error, Resume, ReDim, Erase, Mid and
+            // conditional compilation are kept in full.
+            Decline();
+            break;
+    }
+}
+
+void
+CompactParseTreeWriter::WriteExpression
+(
+    _In_opt_ ParseTree::Expression * pExpression
+)
+{
+    if (pExpression == NULL)
+    {
+        WriteUnsigned(0);
+        return;
+    }
+
+    WriteUnsigned(pExpression->Opcode + 1);
+    WritePunctuator(pExpression->FirstPunctuator);
+    WriteLocation(pExpression->TextSpan);
+
+    switch (pExpression->Opcode)
+    {
+        case ParseTree::Expression::Me:
+        case ParseTree::Expression::MyBase:
+        case ParseTree::Expression::MyClass:
+        case ParseTree::Expression::GlobalNameSpace:
+        case ParseTree::Expression::Nothing:
+            break;
+
+        case ParseTree::Expression::Name:
+            WriteIdentifier(pExpression->AsName()->Name);
+            break;
+
+        case ParseTree::Expression::Parenthesized:
+            WriteExpression(pExpression->AsParenthesized()->Operand);
+            WriteBool(pExpression->AsParenthesized()->IsRightParenMissing);
+            break;
+
+        case ParseTree::Expression::CastBoolean:
+        case ParseTree::Expression::CastCharacter:
+        case ParseTree::Expression::CastDate:
+        case ParseTree::Expression::CastDouble:
+        case ParseTree::Expression::CastSignedByte:
+        case ParseTree::Expression::CastByte:
+        case ParseTree::Expression::CastShort:
+        case ParseTree::Expression::CastUnsignedShort:
+        case ParseTree::Expression::CastInteger:
+        case ParseTree::Expression::CastUnsignedInteger:
+        case ParseTree::Expression::CastLong:
+        case ParseTree::Expression::CastUnsignedLong:
+        case ParseTree::Expression::CastDecimal:
+        case ParseTree::Expression::CastSingle:
+        case ParseTree::Expression::CastString:
+        case ParseTree::Expression::CastObject:
+        case ParseTree::Expression::Negate:
+        case ParseTree::Expression::Not:
+        case ParseTree::Expression::UnaryPlus:
+        case ParseTree::Expression::AddressOf:
+        case ParseTree::Expression::Await:
+            WriteExpression(pExpression->AsUnary()->Operand);
+            break;
+
+        case ParseTree::Expression::Plus:
+        case ParseTree::Expression::Minus:
+        case ParseTree::Expression::Multiply:
+        case ParseTree::Expression::Divide:
+        case ParseTree::Expression::Power:
+        case ParseTree::Expression::IntegralDivide:
+        case ParseTree::Expression::Concatenate:
+        case ParseTree::Expression::ShiftLeft:
+        case ParseTree::Expression::ShiftRight:
+        case ParseTree::Expression::Modulus:
+        case ParseTree::Expression::Or:
+        case ParseTree::Expression::OrElse:
+        case ParseTree::Expression::Xor:
+        case ParseTree::Expression::And:
+        case ParseTree::Expression::AndAlso:
+        case ParseTree::Expression::Like:
+        case ParseTree::Expression::Is:
+        case ParseTree::Expression::IsNot:
+        case ParseTree::Expression::Equal:
+        case ParseTree::Expression::NotEqual:
+        case ParseTree::Expression::Less:
+        case ParseTree::Expression::LessEqual:
+        case ParseTree::Expression::GreaterEqual:
+        case ParseTree::Expression::Greater:
+            WriteExpression(pExpression->AsBinary()->Left);
+            WriteExpression(pExpression->AsBinary()->Right);
+            break;
+
+        case ParseTree::Expression::CallOrIndex:
+            WriteExpression(pExpression->AsCallOrIndex()->Target);
+            WriteArguments(pExpression->AsCallOrIndex()->Arguments);
+            WriteBool(pExpression->AsCallOrIndex()->AlreadyResolvedTarget);
+            break;
+
+        case ParseTree::Expression::DotQualified:
+        case ParseTree::Expression::BangQualified:
+            WriteExpression(pExpression->AsQualified()->Base);
+            WriteExpression(pExpression->AsQualified()->Name);
+            break;
+
+        case ParseTree::Expression::IntegralLiteral:
+            WriteSigned(pExpression->AsIntegralLiteral()->Value);
+            WriteUnsigned(pExpression->AsIntegralLiteral()->Base);
+            WriteUnsigned(pExpression->AsIntegralLiteral()->TypeCharacter);
+            break;
+
+        case ParseTree::Expression::CharacterLiteral:
+            WriteUnsigned(pExpression->AsCharacterLiteral()->Value);
+            break;
+
+        case ParseTree::Expression::BooleanLiteral:
+            WriteBool(pExpression->AsBooleanLiteral()->Value);
+            break;
+
+        case ParseTree::Expression::DecimalLiteral:
+            WriteBytes(&pExpression->AsDecimalLiteral()->Value, sizeof(DECIMAL));
+            WriteUnsigned(pExpression->AsDecimalLiteral()->TypeCharacter);
+            break;
+
+        case ParseTree::Expression::FloatingLiteral:
+            WriteBytes(&pExpression->AsFloatingLiteral()->Value, sizeof(double));
+            WriteUnsigned(pExpression->AsFloatingLiteral()->TypeCharacter);
+            break;
+
+        case ParseTree::Expression::DateLiteral:
+            WriteSigned(pExpression->AsDateLiteral()->Value);
+            break;
+
+        case ParseTree::Expression::StringLiteral:
+        {
+            ParseTree::StringLiteralExpression * pLiteral = pExpression->AsStringLiteral();
+
+            WriteUnsigned(pLiteral->LengthInCharacters);
+
+            for (size_t i = 0; i < pLiteral->LengthInCharacters; i++)
+            {
+                WriteUnsigned(pLiteral->Value[i]);
+            }
+            break;
+        }
+
+        default:
+            Decline();
+            break;
+    }
+}
+
+void
+CompactParseTreeWriter::WriteArguments
+(
+    const ParseTree::ParenthesizedArgumentList & Arguments
+)
+{
+    WriteUnsigned(ParseTree::CountElements(Arguments.Values));
+
+    for (ParseTree::ArgumentList * pNode = Arguments.Values; pNode; pNode = pNode->Next)
+    {
+        ParseTree::Argument * pArgument = pNode->Element;
+
+        WriteListNode(pNode);
+        WriteBool(pArgument != NULL);
+
+        if (pArgument)
+        {
+            WriteLocation(pArgument->TextSpan);
+            WriteExpression(pArgument->Value);
+            WriteIdentifier(pArgument->Name);
+            WritePunctuator(pArgument->ColonEquals);
+            WriteExpression(pArgument->lowerBound);
+            WritePunctuator(pArgument->To);
+#if IDE
+            WriteSigned(pArgument->ValueStartPosition);
+            WriteSigned(pArgument->ValueWidth);
+#endif
+        }
+    }
+
+    WriteBool(Arguments.ClosingParenthesisPresent);
+    WriteLocation(Arguments.TextSpan);
+}
+
+void
+CompactParseTreeWriter::WriteType
+(
+    _In_opt_ ParseTree::Type * pType
+)
+{
+    if (pType == NULL)
+    {
+        WriteUnsigned(0);
+        return;
+    }
+
+    WriteUnsigned(pType->Opcode + 1);
+    WriteLocation(pType->TextSpan);
+
+    switch (pType->Opcode)
+    {
+        case ParseTree::Type::Boolean:
+        case ParseTree::Type::SignedByte:
+        case ParseTree::Type::Byte:
+        case ParseTree::Type::Short:
+        case ParseTree::Type::UnsignedShort:
+        case ParseTree::Type::Integer:
+        case ParseTree::Type::UnsignedInteger:
+        case ParseTree::Type::Long:
+        case ParseTree::Type::UnsignedLong:
+        case ParseTree::Type::Decimal:
+        case ParseTree::Type::Single:
+        case ParseTree::Type::Double:
+        case ParseTree::Type::Date:
+        case ParseTree::Type::Char:
+        case ParseTree::Type::String:
+        case ParseTree::Type::Object:
+            break;
+
+        case ParseTree::Type::Named:
+            WriteName(pType->AsNamed()->TypeName);
+            break;
+
+        case ParseTree::Type::ArrayWithoutSizes:
+            WriteType(pType->AsArray()->ElementType);
+            WriteUnsigned(pType->AsArray()->Rank);
+            WritePunctuator(pType->AsArray()->LeftParen);
+            break;
+
+        case ParseTree::Type::Nullable:
+            WriteType(pType->AsNullable()->ElementType);
+            WritePunctuator(pType->AsNullable()->QuestionMark);
+            break;
+
+        default:
+            Decline();
+            break;
+    }
+}
+
+void
+CompactParseTreeWriter::WriteName
+(
+    _In_opt_ ParseTree::Name * pName
+)
+{
+    if (pName == NULL)
+    {
+        WriteUnsigned(0);
+        return;
+    }
+
+    WriteUnsigned(pName->Opcode + 1);
+    WriteLocation(pName->TextSpan);
+
+    switch (pName->Opcode)
+    {
+        case ParseTree::Name::Simple:
+            WriteIdentifier(pName->AsSimple()->ID);
+            break;
+
+        case ParseTree::Name::Qualified:
+            WriteName(pName->AsQualified()->Base);
+            WriteIdentifier(pName->AsQualified()->Qualifier);
+            WritePunctuator(pName->AsQualified()->Dot);
+            break;
+
+        case ParseTree::Name::GlobalNameSpace:
+            break;
+
+        default:
+            // Generic names are kept in full.
+            Decline();
+            break;
+    }
+}
+
+void
+CompactParseTreeWriter::WriteSpecifiers
+(
+    _In_opt_ ParseTree::SpecifierList * pSpecifiers
+)
+{
+    WriteUnsigned(ParseTree::CountElements(pSpecifiers));
+
+    for (ParseTree::SpecifierList * pNode = pSpecifiers; pNode; pNode = pNode->Next)
+    {
+        WriteListNode(pNode);
+        WriteUnsigned(pNode->Element->Opcode);
+        WriteLocation(pNode->Element->TextSpan);
+    }
+}
+
+void
+CompactParseTreeWriter::WriteDeclarations
+(
+    _In_opt_ ParseTree::VariableDeclarationList * pDeclarations
+)
+{
+    WriteUnsigned(ParseTree::CountElements(pDeclarations));
+
+    for (ParseTree::VariableDeclarationList * pNode = pDeclarations; pNode; pNode = pNode->Next)
+    {
+        ParseTree::VariableDeclaration * pDeclaration = pNode->Element;
+
+        if (pDeclaration->HasSyntaxError ||
+            (pDeclaration->Opcode != ParseTree::VariableDeclaration::NoInitializer &&
+             pDeclaration->Opcode != ParseTree::VariableDeclaration::WithInitializer))
+        {
+            Decline();
+            return;
+        }
+
+        WriteListNode(pNode);
+        WriteUnsigned(pDeclaration->Opcode);
+        WriteType(pDeclaration->Type);
+        WriteLocation(pDeclaration->TextSpan);
+        WritePunctuator(pDeclaration->As);
+
+        WriteUnsigned(ParseTree::CountElements(pDeclaration->Variables));
+
+        for (ParseTree::DeclaratorList * pVariables = pDeclaration->Variables; pVariables; pVariables = pVariables->Next)
+        {
+            ParseTree::Declarator * pDeclarator = pVariables->Element;
+
+            WriteListNode(pVariables);
+            WriteIdentifier(pDeclarator->Name);
+            WriteType(pDeclarator->ArrayInfo);
+            WriteLocation(pDeclarator->TextSpan);
+            WriteUnsigned(pDeclarator->ResumeIndex);
+            WriteBool(pDeclarator->IsForControlVarDeclaration);
+        }
+
+        if (pDeclaration->Opcode == ParseTree::VariableDeclaration::WithInitializer)
+        {
+            WriteInitializer(pDeclaration->AsInitializer()->InitialValue);
+            WritePunctuator(pDeclaration->AsInitializer()->Equals);
+        }
+    }
+}
+
+void
+CompactParseTreeWriter::WriteInitializer
+(
+    _In_opt_ ParseTree::Initializer * pInitializer
+)
+{
+    if (pInitializer == NULL)
+    {
+        WriteBool(false);
+        return;
+    }
+
+    if (pInitializer->Opcode != ParseTree::Initializer::Expression)
+    {
+        Decline();
+        return;
+    }
+
+    WriteBool(true);
+    WritePunctuator(pInitializer->Key);
+    WriteBool(pInitializer->FieldIsKey);
+    WriteExpression(pInitializer->AsExpression()->Value);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// CompactParseTreeReader
+//
+//-------------------------------------------------------------------------------------------------
+
+class CompactParseTreeReader
+{
+public:
+    CompactParseTreeReader(
+        _In_ const CompactParseTree * pCompact,
+        _In_ const BYTE * pData,
+        size_t cbData,
+        _In_ STRING ** pIdentifiers,
+        unsigned cIdentifiers,
+        _In_ NorlsAllocator * pTreeStorage,
+        long LineDelta) :
+        m_pCompact(pCompact),
+        m_pCursor(pData),
+        m_pEnd(pData + cbData),
+        m_pIdentifiers(pIdentifiers),
+        m_cIdentifiers(cIdentifiers),
+        m_pStorage(pTreeStorage),
+        m_PreviousLine(LineDelta)
+    {
+    }
+
+    ParseTree::MethodBodyStatement * Read();
+
+private:
+    struct TerminatorFixup
+    {
+        ParseTree::BlockStatement * Block;
+        unsigned Index;
+    };
+
+    BYTE ReadByte()
+    {
+        VSASSERT(m_pCursor < m_pEnd, "Compact parse tree is truncated.");
+        return *m_pCursor++;
+    }
+
+    void ReadBytes(
+        _Out_bytecap_(cbValue) void * pValue,
+        size_t cbValue)
+    {
+        VSASSERT(m_pCursor + cbValue <= m_pEnd, "Compact parse tree is truncated.");
+        memcpy(pValue, m_pCursor, cbValue);
+        m_pCursor += cbValue;
+    }
+
+    unsigned __int64 ReadUnsigned()
+    {
+        unsigned __int64 Value = 0;
+        unsigned Shift = 0;
+        BYTE Byte;
+
+        do
+        {
+            Byte = ReadByte();
+            Value |= (unsigned __int64)(Byte & 0x7f) << Shift;
+            Shift += 7;
+        }
+        while (Byte & 0x80);
+
+        return Value;
+    }
+
+    __int64 ReadSigned()
+    {
+        unsigned __int64 Value = ReadUnsigned();
+        return (__int64)(Value >> 1) ^ -(__int64)(Value & 1);
+    }
+
+    bool ReadBool()
+    {
+        return ReadByte() != 0;
+    }
+
+    void ReadLocation(_Out_ Location * pLoc);
+    void ReadPunctuator(_Out_ ParseTree::PunctuatorLocation * pPunctuator);
+    STRING * ReadIdentifierName();
+    void ReadIdentifier(_Out_ ParseTree::IdentifierDescriptor * pIdentifier);
+    ParseTree::Statement * ReadStatementReference();
+    ParseTree::CommentList * ReadComments();
+
+    ParseTree::Statement * ReadStatement();
+    void ReadBlock(_Inout_ ParseTree::BlockStatement * pBlock);
+    void ReadExecutableBlock(_Inout_ ParseTree::ExecutableBlockStatement * pBlock);
+    void ReadExpressionBlock(_Inout_ ParseTree::ExpressionBlockStatement * pBlock);
+
+    ParseTree::Expression * ReadExpression();
+    void ReadArguments(_Out_ ParseTree::ParenthesizedArgumentList * pArguments);
+    ParseTree::Type * ReadType();
+    ParseTree::Name * ReadName();
+    ParseTree::SpecifierList * ReadSpecifiers();
+    ParseTree::VariableDeclarationList * ReadDeclarations();
+    ParseTree::Initializer * ReadInitializer();
+
+    template <class ElementType, class ListType>
+    void ReadListNode(_Out_ ParseTree::List<ElementType, ListType> * pNode)
+    {
+        ReadLocation(&pNode->TextSpan);
+        ReadPunctuator(&pNode->Punctuator);
+    }
+
+    WCHAR * ReadCharacters(size_t Length)
+    {
+        WCHAR * pCharacters = new(*m_pStorage) WCHAR[Length + 1];
+
+        for (size_t i = 0; i < Length; i++)
+        {
+            pCharacters[i] = (WCHAR)ReadUnsigned();
+        }
+
+        pCharacters[Length] = L'\0';
+        return pCharacters;
+    }
+
+    const CompactParseTree * m_pCompact;
+    const BYTE * m_pCursor;
+    const BYTE * m_pEnd;
+    STRING ** m_pIdentifiers;
+    unsigned m_cIdentifiers;
+    NorlsAllocator * m_pStorage;
+    // Locations are stored relative to each other, so starting from a nonzero
+    // line moves the whole body.
+    long m_PreviousLine;
+
+    // Statements by index; element 0 is the method body.
+    DynamicArray<ParseTree::Statement *> m_Statements;
+    DynamicArray<TerminatorFixup> m_Fixups;
+};
+
+ParseTree::MethodBodyStatement *
+CompactParseTreeReader::Read
+(
+)
+{
+    ParseTree::MethodBodyStatement * pBody = new(*m_pStorage) ParseTree::MethodBodyStatement;
+
+    pBody->Opcode = (ParseTree::Statement::Opcodes)ReadUnsigned();
+    ReadLocation(&pBody->TextSpan);
+    pBody->IsFirstOnLine = ReadBool();
+    pBody->Comments = ReadComments();
+    ReadExecutableBlock(pBody);
+    pBody->DefinedLabelCount = (unsigned)ReadUnsigned();
+    pBody->OnErrorHandlerCount = (unsigned)ReadUnsigned();
+    pBody->OnErrorResumeCount = (unsigned)ReadUnsigned();
+    pBody->ResumeTargetCount = (unsigned)ReadUnsigned();
+    pBody->IsEmpty = ReadBool();
+    pBody->ProcedureContainsTry = ReadBool();
+    pBody->ProcedureContainsOnError = ReadBool();
+    pBody->ProcedureContainsResume = ReadBool();
+
+    unsigned cStatements = (unsigned)ReadUnsigned();
+    VSASSERT(cStatements == m_pCompact->GetStatementCount(), "Compact parse tree statement count mismatch.");
+
+    m_Statements.AddElement(pBody);
+
+    // The last child of each block, indexed like m_Statements.
+    NorlsAllocator Scratch(NORLSLOC);
+    ParseTree::StatementList ** LastChildren = Scratch.AllocArray<ParseTree::StatementList *>(cStatements + 1);
+
+    ParseTree::StatementList * pPreviousLexical = NULL;
+    ParseTree::StatementList * pLastLabel = NULL;
+
+    for (unsigned i = 1; i <= cStatements; i++)
+    {
+        unsigned ParentIndex = (unsigned)ReadUnsigned();
+        VSASSERT(ParentIndex < i, "Compact parse tree parent must precede its children.");
+
+        ParseTree::BlockStatement * pParent = m_Statements.Element(ParentIndex)->AsBlock();
+        ParseTree::StatementList * pList = new(*m_pStorage) ParseTree::StatementList;
+
+        ReadPunctuator(&pList->Colon);
+
+        ParseTree::Statement * pStatement = ReadStatement();
+        m_Statements.AddElement(pStatement);
+
+        pList->Element = pStatement;
+        pStatement->ContainingList = pList;
+        pStatement->SetParent(pParent);
+
+        pList->PreviousInBlock = LastChildren[ParentIndex];
+        if (pList->PreviousInBlock)
+        {
+            pList->PreviousInBlock->NextInBlock = pList;
+        }
+        else
+        {
+            pParent->Children = pList;
+        }
+        LastChildren[ParentIndex] = pList;
+
+        pList->PreviousLexical = pPreviousLexical;
+        if (pPreviousLexical)
+        {
+            pPreviousLexical->NextLexical = pList;
+        }
+        pPreviousLexical = pList;
+
+        if (pStatement->Opcode == ParseTree::Statement::Label)
+        {
+            ParseTree::StatementList * pLabelList = new(*m_pStorage) ParseTree::StatementList;
+
+            pLabelList->Element = pStatement;
+            pLabelList->PreviousInBlock = pLastLabel;
+            if (pLastLabel)
+            {
+                pLastLabel->NextInBlock = pLabelList;
+            }
+            else
+            {
+                pBody->DefinedLabels = pLabelList;
+            }
+            pLastLabel = pLabelList;
+        }
+    }
+
+    for (unsigned i = 0; i < m_Fixups.Count(); i++)
+    {
+        m_Fixups.Element(i).Block->TerminatingConstruct = m_Statements.Element(m_Fixups.Element(i).Index);
+    }
+
+    VSASSERT(m_pCursor == m_pEnd, "Compact parse tree was not fully consumed.");
+
+    return pBody;
+}
+
+void
+CompactParseTreeReader::ReadLocation
+(
+    _Out_ Location * pLoc
+)
+{
+    pLoc->m_lBegLine = (long)(m_PreviousLine + ReadSigned());
+    pLoc->m_lBegColumn = (long)ReadSigned();
+    pLoc->m_lEndLine = (long)(pLoc->m_lBegLine + ReadSigned());
+    pLoc->m_lEndColumn = (long)ReadSigned();
+
+    m_PreviousLine = pLoc->m_lBegLine;
+}
+
+void
+CompactParseTreeReader::ReadPunctuator
+(
+    _Out_ ParseTree::PunctuatorLocation * pPunctuator
+)
+{
+    pPunctuator->Line = (long)ReadSigned();
+    pPunctuator->Column = (long)ReadSigned();
+}
+
+STRING *
+CompactParseTreeReader::ReadIdentifierName
+(
+)
+{
+    unsigned Index = (unsigned)ReadUnsigned();
+    VSASSERT(Index <= m_cIdentifiers, "Compact parse tree identifier out of range.");
+
+    return Index ? m_pIdentifiers[Index - 1] : NULL;
+}
+
+void
+CompactParseTreeReader::ReadIdentifier
+(
+    _Out_ ParseTree::IdentifierDescriptor * pIdentifier
+)
+{
+    pIdentifier->Name = ReadIdentifierName();
+    pIdentifier->TypeCharacter = (typeChars)ReadUnsigned();
+
+    BYTE Flags = ReadByte();
+    pIdentifier->IsBracketed = (Flags & 1) != 0;
+    pIdentifier->IsBad = (Flags & 2) != 0;
+    pIdentifier->IsNullable = (Flags & 4) != 0;
+
+    ReadLocation(&pIdentifier->TextSpan);
+}
+
+// Statement references always point backwards except for terminating
+// constructs, which are resolved once all statements exist.
+
+ParseTree::Statement *
+CompactParseTreeReader::ReadStatementReference
+(
+)
+{
+    unsigned Index = (unsigned)ReadUnsigned();
+    VSASSERT(Index < m_Statements.Count(), "Compact parse tree forward reference.");
+
+    return Index ? m_Statements.Element(Index) : NULL;
+}
+
+ParseTree::CommentList *
+CompactParseTreeReader::ReadComments
+(
+)
+{
+    ParseTree::CommentList * pComments = NULL;
+    ParseTree::CommentList ** ppTail = &pComments;
+
+    for (unsigned __int64 Count = ReadUnsigned(); Count > 0; Count--)
+    {
+        ParseTree::CommentList * pNode = new(*m_pStorage) ParseTree::CommentList;
+        ParseTree::Comment * pComment = new(*m_pStorage) ParseTree::Comment;
+
+        ReadListNode(pNode);
+        ReadLocation(&pComment->TextSpan);
+        pComment->LengthInCharacters = (size_t)ReadUnsigned();
+        pComment->Spelling = ReadCharacters(pComment->LengthInCharacters);
+        pComment->IsRem = ReadBool();
+        pComment->IsGeneratedFromXMLDocToken = ReadBool();
+
+        pNode->Element = pComment;
+        *ppTail = pNode;
+        ppTail = &pNode->Next;
+    }
+
+    return pComments;
+}
+
+void
+CompactParseTreeReader::ReadBlock
+(
+    _Inout_ ParseTree::BlockStatement * pBlock
+)
+{
+    unsigned TerminatorIndex = (unsigned)ReadUnsigned();
+
+    if (TerminatorIndex)
+    {
+        TerminatorFixup & Fixup = m_Fixups.Grow();
+        Fixup.Block = pBlock;
+        Fixup.Index = TerminatorIndex;
+    }
+
+    pBlock->HasProperTermination = ReadBool();
+    pBlock->IsOrContainedByExceptionContext = ReadBool();
+    ReadLocation(&pBlock->BodyTextSpan);
+}
+
+void
+CompactParseTreeReader::ReadExecutableBlock
+(
+    _Inout_ ParseTree::ExecutableBlockStatement * pBlock
+)
+{
+    ReadBlock(pBlock);
+    pBlock->LocalsCount = (unsigned)ReadUnsigned();
+}
+
+void
+CompactParseTreeReader::ReadExpressionBlock
+(
+    _Inout_ ParseTree::ExpressionBlockStatement * pBlock
+)
+{
+    ReadExecutableBlock(pBlock);
+    pBlock->Operand = ReadExpression();
+}
+
+ParseTree::Statement *
+CompactParseTreeReader::ReadStatement
+(
+)
+{
+    ParseTree::Statement::Opcodes Opcode = (ParseTree::Statement::Opcodes)ReadUnsigned();
+
+    Location TextSpan;
+    ReadLocation(&TextSpan);
+
+    BYTE Flags = ReadByte();
+    unsigned short ResumeIndex = (unsigned short)ReadUnsigned();
+    ParseTree::CommentList * pComments = ReadComments();
+
+    ParseTree::Statement * pStatement = NULL;
+
+    switch (Opcode)
+    {
+        case ParseTree::Statement::Empty:
+        case ParseTree::Statement::Stop:
+        case ParseTree::Statement::End:
+        case ParseTree::Statement::ContinueDo:
+        case ParseTree::Statement::ContinueFor:
+        case ParseTree::Statement::ContinueWhile:
+        case ParseTree::Statement::ContinueUnknown:
+        case ParseTree::Statement::ContinueInvalid:
+        case ParseTree::Statement::ExitDo:
+        case ParseTree::Statement::ExitFor:
+        case ParseTree::Statement::ExitSub:
+        case ParseTree::Statement::ExitFunction:
+        case ParseTree::Statement::ExitOperator:
+        case ParseTree::Statement::ExitProperty:
+        case ParseTree::Statement::ExitTry:
+        case ParseTree::Statement::ExitSelect:
+        case ParseTree::Statement::ExitWhile:
+        case ParseTree::Statement::ExitUnknown:
+        case ParseTree::Statement::ExitInvalid:
+            pStatement = new(*m_pStorage) ParseTree::Statement;
+            break;
+
+        case ParseTree::Statement::EndIf:
+        case ParseTree::Statement::EndUsing:
+        case ParseTree::Statement::EndWith:
+        case ParseTree::Statement::EndSelect:
+        case ParseTree::Statement::EndStructure:
+        case ParseTree::Statement::EndEnum:
+        case ParseTree::Statement::EndInterface:
+        case ParseTree::Statement::EndClass:
+        case ParseTree::Statement::EndModule:
+        case ParseTree::Statement::EndNamespace:
+        case ParseTree::Statement::EndSub:
+        case ParseTree::Statement::EndFunction:
+        case ParseTree::Statement::EndGet:
+        case ParseTree::Statement::EndSet:
+        case ParseTree::Statement::EndProperty:
+        case ParseTree::Statement::EndOperator:
+        case ParseTree::Statement::EndEvent:
+        case ParseTree::Statement::EndAddHandler:
+        case ParseTree::Statement::EndRemoveHandler:
+        case ParseTree::Statement::EndRaiseEvent:
+        case ParseTree::Statement::EndWhile:
+        case ParseTree::Statement::EndLoop:
+        case ParseTree::Statement::EndTry:
+        case ParseTree::Statement::EndSyncLock:
+        case ParseTree::Statement::EndUnknown:
+        case ParseTree::Statement::EndInvalid:
+        {
+            ParseTree::EndBlockStatement * pEnd = new(*m_pStorage) ParseTree::EndBlockStatement;
+            ReadPunctuator(&pEnd->Punctuator);
+            pStatement = pEnd;
+            break;
+        }
+
+        case ParseTree::Statement::EndLoopWhile:
+        case ParseTree::Statement::EndLoopUntil:
+        {
+            ParseTree::BottomTestLoopStatement * pLoop = new(*m_pStorage) ParseTree::BottomTestLoopStatement;
+            pLoop->Operand = ReadExpression();
+            ReadPunctuator(&pLoop->WhileOrUntil);
+            pStatement = pLoop;
+            break;
+        }
+
+        case ParseTree::Statement::Return:
+        case ParseTree::Statement::Error:
+        case ParseTree::Statement::Throw:
+        case ParseTree::Statement::Await:
+        case ParseTree::Statement::Yield:
+        {
+            ParseTree::ExpressionStatement * pExpression = new(*m_pStorage) ParseTree::ExpressionStatement;
+            pExpression->Operand = ReadExpression();
+            pStatement = pExpression;
+            break;
+        }
+
+        case ParseTree::Statement::Label:
+        case ParseTree::Statement::Goto:
+        {
+            ParseTree::LabelReferenceStatement * pLabel = new(*m_pStorage) ParseTree::LabelReferenceStatement;
+            ReadIdentifier(&pLabel->Label);
+            pLabel->LabelIsLineNumber = ReadBool();
+            pStatement = pLabel;
+            break;
+        }
+
+        case ParseTree::Statement::Call:
+        {
+            ParseTree::CallStatement * pCall = new(*m_pStorage) ParseTree::CallStatement;
+            pCall->Target = ReadExpression();
+            ReadArguments(&pCall->Arguments);
+            ReadPunctuator(&pCall->LeftParenthesis);
+            pCall->CallIsExplicit = ReadBool();
+            pStatement = pCall;
+            break;
+        }
+
+        case ParseTree::Statement::Assign:
+        case ParseTree::Statement::AssignPlus:
+        case ParseTree::Statement::AssignMinus:
+        case ParseTree::Statement::AssignMultiply:
+        case ParseTree::Statement::AssignDivide:
+        case ParseTree::Statement::AssignPower:
+        case ParseTree::Statement::AssignIntegralDivide:
+        case ParseTree::Statement::AssignConcatenate:
+        case ParseTree::Statement::AssignShiftLeft:
+        case ParseTree::Statement::AssignShiftRight:
+        {
+            ParseTree::AssignmentStatement * pAssignment = new(*m_pStorage) ParseTree::AssignmentStatement;
+            pAssignment->Target = ReadExpression();
+            pAssignment->Source = ReadExpression();
+            ReadPunctuator(&pAssignment->Operator);
+            pStatement = pAssignment;
+            break;
+        }
+
+        case ParseTree::Statement::AddHandler:
+        case ParseTree::Statement::RemoveHandler:
+        {
+            ParseTree::HandlerStatement * pHandler = new(*m_pStorage) ParseTree::HandlerStatement;
+            pHandler->Event = ReadExpression();
+            pHandler->Delegate = ReadExpression();
+            ReadPunctuator(&pHandler->Comma);
+            pStatement = pHandler;
+            break;
+        }
+
+        case ParseTree::Statement::VariableDeclaration:
+        {
+            ParseTree::VariableDeclarationStatement * pDeclaration = new(*m_pStorage) ParseTree::VariableDeclarationStatement;
+            pDeclaration->Specifiers = ReadSpecifiers();
+            pDeclaration->Declarations = ReadDeclarations();
+            pStatement = pDeclaration;
+            break;
+        }
+
+        case ParseTree::Statement::BlockIf:
+        case ParseTree::Statement::LineIf:
+        {
+            ParseTree::IfStatement * pIf = new(*m_pStorage) ParseTree::IfStatement;
+            ReadExpressionBlock(pIf);
+            ReadPunctuator(&pIf->Then);
+            pStatement = pIf;
+            break;
+        }
+
+        case ParseTree::Statement::ElseIf:
+        {
+            ParseTree::ElseIfStatement * pElseIf = new(*m_pStorage) ParseTree::ElseIfStatement;
+            ReadExpressionBlock(pElseIf);
+            ReadPunctuator(&pElseIf->Then);
+            pElseIf->ContainingIf = ReadStatementReference()->AsIf();
+            pStatement = pElseIf;
+            break;
+        }
+
+        case ParseTree::Statement::BlockElse:
+        case ParseTree::Statement::LineElse:
+        {
+            ParseTree::ElseStatement * pElse = new(*m_pStorage) ParseTree::ElseStatement;
+            ReadExecutableBlock(pElse);
+            pElse->ContainingIf = ReadStatementReference()->AsIf();
+            pStatement = pElse;
+            break;
+        }
+
+        case ParseTree::Statement::Try:
+        {
+            ParseTree::ExecutableBlockStatement * pTry = new(*m_pStorage) ParseTree::ExecutableBlockStatement;
+            ReadExecutableBlock(pTry);
+            pStatement = pTry;
+            break;
+        }
+
+        case ParseTree::Statement::Catch:
+        {
+            ParseTree::CatchStatement * pCatch = new(*m_pStorage) ParseTree::CatchStatement;
+            ReadExecutableBlock(pCatch);
+            ReadIdentifier(&pCatch->Name);
+            pCatch->Type = ReadType();
+            pCatch->WhenClause = ReadExpression();
+            ReadPunctuator(&pCatch->As);
+            ReadPunctuator(&pCatch->When);
+            pCatch->ContainingTry = ReadStatementReference()->AsExecutableBlock();
+            pStatement = pCatch;
+            break;
+        }
+
+        case ParseTree::Statement::Finally:
+        {
+            ParseTree::FinallyStatement * pFinally = new(*m_pStorage) ParseTree::FinallyStatement;
+            ReadExecutableBlock(pFinally);
+            pFinally->ContainingTry = ReadStatementReference()->AsExecutableBlock();
+            pStatement = pFinally;
+            break;
+        }
+
+        case ParseTree::Statement::While:
+        case ParseTree::Statement::DoWhileBottomTest:
+        case ParseTree::Statement::DoUntilBottomTest:
+        case ParseTree::Statement::DoForever:
+        case ParseTree::Statement::With:
+        case ParseTree::Statement::SyncLock:
+        {
+            ParseTree::ExpressionBlockStatement * pBlock = new(*m_pStorage) ParseTree::ExpressionBlockStatement;
+            ReadExpressionBlock(pBlock);
+            pStatement = pBlock;
+            break;
+        }
+
+        case ParseTree::Statement::DoWhileTopTest:
+        case ParseTree::Statement::DoUntilTopTest:
+        {
+            ParseTree::TopTestDoStatement * pDo = new(*m_pStorage) ParseTree::TopTestDoStatement;
+            ReadExpressionBlock(pDo);
+            ReadPunctuator(&pDo->WhileOrUntil);
+            pStatement = pDo;
+            break;
+        }
+
+        default:
+            VSFAIL("Unexpected statement opcode in compact parse tree.");
+            pStatement = new(*m_pStorage) ParseTree::Statement;
+            break;
+    }
+
+    pStatement->Opcode = Opcode;
+    pStatement->TextSpan = TextSpan;
+    pStatement->IsFirstOnLine = (Flags & 1) != 0;
+    pStatement->ContainsAnonymousTypeInitialization = (Flags & 2) != 0;
+    pStatement->ContainsQueryExpression = (Flags & 4) != 0;
+    pStatement->ContainsLambdaExpression = (Flags & 8) != 0;
+    pStatement->ResumeIndex = ResumeIndex;
+    pStatement->Comments = pComments;
+
+    return pStatement;
+}
+
+ParseTree::Expression *
+CompactParseTreeReader::ReadExpression
+(
+)
+{
+    unsigned __int64 Encoded = ReadUnsigned();
+
+    if (Encoded == 0)
+    {
+        return NULL;
+    }
+
+    ParseTree::Expression::Opcodes Opcode = (ParseTree::Expression::Opcodes)(Encoded - 1);
+
+    ParseTree::PunctuatorLocation FirstPunctuator;
+    ReadPunctuator(&FirstPunctuator);
+
+    Location TextSpan;
+    ReadLocation(&TextSpan);
+
+    ParseTree::Expression * pExpression = NULL;
+
+    switch (Opcode)
+    {
+        case ParseTree::Expression::Me:
+        case ParseTree::Expression::MyBase:
+        case ParseTree::Expression::MyClass:
+        case ParseTree::Expression::GlobalNameSpace:
+        case ParseTree::Expression::Nothing:
+            pExpression = new(*m_pStorage) ParseTree::Expression;
+            break;
+
+        case ParseTree::Expression::Name:
+        {
+            ParseTree::NameExpression * pName = new(*m_pStorage) ParseTree::NameExpression;
+            ReadIdentifier(&pName->Name);
+            pExpression = pName;
+            break;
+        }
+
+        case ParseTree::Expression::Parenthesized:
+        {
+            ParseTree::ParenthesizedExpression * pParenthesized = new(*m_pStorage) ParseTree::ParenthesizedExpression;
+            pParenthesized->Operand = ReadExpression();
+            pParenthesized->IsRightParenMissing = ReadBool();
+            pExpression = pParenthesized;
+            break;
+        }
+
+        case ParseTree::Expression::CastBoolean:
+        case ParseTree::Expression::CastCharacter:
+        case ParseTree::Expression::CastDate:
+        case ParseTree::Expression::CastDouble:
+        case ParseTree::Expression::CastSignedByte:
+        case ParseTree::Expression::CastByte:
+        case ParseTree::Expression::CastShort:
+        case ParseTree::Expression::CastUnsignedShort:
+        case ParseTree::Expression::CastInteger:
+        case ParseTree::Expression::CastUnsignedInteger:
+        case ParseTree::Expression::CastLong:
+        case ParseTree::Expression::CastUnsignedLong:
+        case ParseTree::Expression::CastDecimal:
+        case ParseTree::Expression::CastSingle:
+        case ParseTree::Expression::CastString:
+        case ParseTree::Expression::CastObject:
+        case ParseTree::Expression::Negate:
+        case ParseTree::Expression::Not:
+        case ParseTree::Expression::UnaryPlus:
+        case ParseTree::Expression::AddressOf:
+        case ParseTree::Expression::Await:
+        {
+            ParseTree::UnaryExpression * pUnary = new(*m_pStorage) ParseTree::UnaryExpression;
+            pUnary->Operand = ReadExpression();
+            pExpression = pUnary;
+            break;
+        }
+
+        case ParseTree::Expression::Plus:
+        case ParseTree::Expression::Minus:
+        case ParseTree::Expression::Multiply:
+        case ParseTree::Expression::Divide:
+        case ParseTree::Expression::Power:
+        case ParseTree::Expression::IntegralDivide:
+        case ParseTree::Expression::Concatenate:
+        case ParseTree::Expression::ShiftLeft:
+        case ParseTree::Expression::ShiftRight:
+        case ParseTree::Expression::Modulus:
+        case ParseTree::Expression::Or:
+        case ParseTree::Expression::OrElse:
+        case ParseTree::Expression::Xor:
+        case ParseTree::Expression::And:
+        case ParseTree::Expression::AndAlso:
+        case ParseTree::Expression::Like:
+        case ParseTree::Expression::Is:
+        case ParseTree::Expression::IsNot:
+        case ParseTree::Expression::Equal:
+        case ParseTree::Expression::NotEqual:
+        case ParseTree::Expression::Less:
+        case ParseTree::Expression::LessEqual:
+        case ParseTree::Expression::GreaterEqual:
+        case ParseTree::Expression::Greater:
+        {
+            ParseTree::BinaryExpression * pBinary = new(*m_pStorage) ParseTree::BinaryExpression;
+            pBinary->Left = ReadExpression();
+            pBinary->Right = ReadExpression();
+            pExpression = pBinary;
+            break;
+        }
+
+        case ParseTree::Expression::CallOrIndex:
+        {
+            ParseTree::CallOrIndexExpression * pCall = new(*m_pStorage) ParseTree::CallOrIndexExpression;
+            pCall->Target = ReadExpression();
+            ReadArguments(&pCall->Arguments);
+            pCall->AlreadyResolvedTarget = ReadBool();
+            pExpression = pCall;
+            break;
+        }
+
+        case ParseTree::Expression::DotQualified:
+        case ParseTree::Expression::BangQualified:
+        {
+            ParseTree::QualifiedExpression * pQualified = new(*m_pStorage) ParseTree::QualifiedExpression;
+            pQualified->Base = ReadExpression();
+            pQualified->Name = ReadExpression();
+            pExpression = pQualified;
+            break;
+        }
+
+        case ParseTree::Expression::IntegralLiteral:
+        {
+            ParseTree::IntegralLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::IntegralLiteralExpression;
+            pLiteral->Value = ReadSigned();
+            pLiteral->Base = (ParseTree::IntegralLiteralExpression::Bases)ReadUnsigned();
+            pLiteral->TypeCharacter = (typeChars)ReadUnsigned();
+            pExpression = pLiteral;
+            break;
+        }
+
+        case ParseTree::Expression::CharacterLiteral:
+        {
+            ParseTree::CharacterLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::CharacterLiteralExpression;
+            pLiteral->Value = (WCHAR)ReadUnsigned();
+            pExpression = pLiteral;
+            break;
+        }
+
+        case ParseTree::Expression::BooleanLiteral:
+        {
+            ParseTree::BooleanLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::BooleanLiteralExpression;
+            pLiteral->Value = ReadBool();
+            pExpression = pLiteral;
+            break;
+        }
+
+        case ParseTree::Expression::DecimalLiteral:
+        {
+            ParseTree::DecimalLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::DecimalLiteralExpression;
+            ReadBytes(&pLiteral->Value, sizeof(DECIMAL));
+            pLiteral->TypeCharacter = (typeChars)ReadUnsigned();
+            pExpression = pLiteral;
+            break;
+        }
+
+        case ParseTree::Expression::FloatingLiteral:
+        {
+            ParseTree::FloatingLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::FloatingLiteralExpression;
+            ReadBytes(&pLiteral->Value, sizeof(double));
+            pLiteral->TypeCharacter = (typeChars)ReadUnsigned();
+            pExpression = pLiteral;
+            break;
+        }
+
+        case ParseTree::Expression::DateLiteral:
+        {
+            ParseTree::DateLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::DateLiteralExpression;
+            pLiteral->Value = ReadSigned();
+            pExpression = pLiteral;
+            break;
+        }
+
+        case ParseTree::Expression::StringLiteral:
+        {
+            ParseTree::StringLiteralExpression * pLiteral = new(*m_pStorage) ParseTree::StringLiteralExpression;
+            pLiteral->LengthInCharacters = (size_t)ReadUnsigned();
+            pLiteral->Value = ReadCharacters(pLiteral->LengthInCharacters);
+            pExpression = pLiteral;
+            break;
+        }
+
+        default:
+            VSFAIL("Unexpected expression opcode in compact parse tree.");
+            pExpression = new(*m_pStorage) ParseTree::Expression;
+            break;
+    }
+
+    pExpression->Opcode = Opcode;
+    pExpression->FirstPunctuator = FirstPunctuator;
+    pExpression->TextSpan = TextSpan;
+
+    return pExpression;
+}
+
+void
+CompactParseTreeReader::ReadArguments
+(
+    _Out_ ParseTree::ParenthesizedArgumentList * pArguments
+)
+{
+    ParseTree::ArgumentList ** ppTail = &pArguments->Values;
+
+    for (unsigned __int64 Count = ReadUnsigned(); Count > 0; Count--)
+    {
+        ParseTree::ArgumentList * pNode = new(*m_pStorage) ParseTree::ArgumentList;
+
+        ReadListNode(pNode);
+
+        if (ReadBool())
+        {
+            ParseTree::Argument * pArgument = new(*m_pStorage) ParseTree::Argument;
+
+            ReadLocation(&pArgument->TextSpan);
+            pArgument->Value = ReadExpression();
+            ReadIdentifier(&pArgument->Name);
+            ReadPunctuator(&pArgument->ColonEquals);
+            pArgument->lowerBound = ReadExpression();
+            ReadPunctuator(&pArgument->To);
+#if IDE
+            pArgument->ValueStartPosition = (long)ReadSigned();
+            pArgument->ValueWidth = (long)ReadSigned();
+#endif
+
+            pNode->Element = pArgument;
+        }
+
+        *ppTail = pNode;
+        ppTail = &pNode->Next;
+    }
+
+    *ppTail = NULL;
+    pArguments->ClosingParenthesisPresent = ReadBool();
+    ReadLocation(&pArguments->TextSpan);
+}
+
+ParseTree::Type *
+CompactParseTreeReader::ReadType
+(
+)
+{
+    unsigned __int64 Encoded = ReadUnsigned();
+
+    if (Encoded == 0)
+    {
+        return NULL;
+    }
+
+    ParseTree::Type::Opcodes Opcode = (ParseTree::Type::Opcodes)(Encoded - 1);
+
+    Location TextSpan;
+    ReadLocation(&TextSpan);
+
+    ParseTree::Type * pType = NULL;
+
+    switch (Opcode)
+    {
+        case ParseTree::Type::Named:
+        {
+            ParseTree::NamedType * pNamed = new(*m_pStorage) ParseTree::NamedType;
+            pNamed->TypeName = ReadName();
+            pType = pNamed;
+            break;
+        }
+
+        case ParseTree::Type::ArrayWithoutSizes:
+        {
+            ParseTree::ArrayType * pArray = new(*m_pStorage) ParseTree::ArrayType;
+            pArray->ElementType = ReadType();
+            pArray->Rank = (unsigned)ReadUnsigned();
+            ReadPunctuator(&pArray->LeftParen);
+            pType = pArray;
+            break;
+        }
+
+        case ParseTree::Type::Nullable:
+        {
+            ParseTree::NullableType * pNullable = new(*m_pStorage) ParseTree::NullableType;
+            pNullable->ElementType = ReadType();
+            ReadPunctuator(&pNullable->QuestionMark);
+            pType = pNullable;
+            break;
+        }
+
+        default:
+            VSASSERT(Opcode >= ParseTree::Type::Boolean && Opcode <= ParseTree::Type::Object,
+                     "Unexpected type opcode in compact parse tree.");
+            pType = new(*m_pStorage) ParseTree::Type;
+            break;
+    }
+
+    pType->Opcode = Opcode;
+    pType->TextSpan = TextSpan;
+
+    return pType;
+}
+
+ParseTree::Name *
+CompactParseTreeReader::ReadName
+(
+)
+{
+    unsigned __int64 Encoded = ReadUnsigned();
+
+    if (Encoded == 0)
+    {
+        return NULL;
+    }
+
+    ParseTree::Name::Opcodes Opcode = (ParseTree::Name::Opcodes)(Encoded - 1);
+
+    Location TextSpan;
+    ReadLocation(&TextSpan);
+
+    ParseTree::Name * pName = NULL;
+
+    switch (Opcode)
+    {
+        case ParseTree::Name::Simple:
+        {
+            ParseTree::SimpleName * pSimple = new(*m_pStorage) ParseTree::SimpleName;
+            ReadIdentifier(&pSimple->ID);
+            pName = pSimple;
+            break;
+        }
+
+        case ParseTree::Name::Qualified:
+        {
+            ParseTree::QualifiedName * pQualified = new(*m_pStorage) ParseTree::QualifiedName;
+            pQualified->Base = ReadName();
+            ReadIdentifier(&pQualified->Qualifier);
+            ReadPunctuator(&pQualified->Dot);
+            pName = pQualified;
+            break;
+        }
+
+        default:
+            VSASSERT(Opcode == ParseTree::Name::GlobalNameSpace, "Unexpected name opcode in compact parse tree.");
+            pName = new(*m_pStorage) ParseTree::Name;
+            break;
+    }
+
+    pName->Opcode = Opcode;
+    pName->TextSpan = TextSpan;
+
+    return pName;
+}
+
+ParseTree::SpecifierList *
+CompactParseTreeReader::ReadSpecifiers
+(
+)
+{
+    ParseTree::SpecifierList * pSpecifiers = NULL;
+    ParseTree::SpecifierList ** ppTail = &pSpecifiers;
+
+    for (unsigned __int64 Count = ReadUnsigned(); Count > 0; Count--)
+    {
+        ParseTree::SpecifierList * pNode = new(*m_pStorage) ParseTree::SpecifierList;
+        ParseTree::Specifier * pSpecifier = new(*m_pStorage) ParseTree::Specifier;
+
+        ReadListNode(pNode);
+        pSpecifier->Opcode = (ParseTree::Specifier::Specifiers)ReadUnsigned();
+        ReadLocation(&pSpecifier->TextSpan);
+
+        pNode->Element = pSpecifier;
+        *ppTail = pNode;
+        ppTail = &pNode->Next;
+    }
+
+    return pSpecifiers;
+}
+
+ParseTree::VariableDeclarationList *
+CompactParseTreeReader::ReadDeclarations
+(
+)
+{
+    ParseTree::VariableDeclarationList * pDeclarations = NULL;
+    ParseTree::VariableDeclarationList ** ppTail = &pDeclarations;
+
+    for (unsigned __int64 Count = ReadUnsigned(); Count > 0; Count--)
+    {
+        ParseTree::VariableDeclarationList * pNode = new(*m_pStorage) ParseTree::VariableDeclarationList;
+
+        ReadListNode(pNode);
+
+        ParseTree::VariableDeclaration::Opcodes Opcode = (ParseTree::VariableDeclaration::Opcodes)ReadUnsigned();
+        ParseTree::VariableDeclaration * pDeclaration =
+            Opcode == ParseTree::VariableDeclaration::WithInitializer ?
+                new(*m_pStorage) ParseTree::InitializerVariableDeclaration :
+                new(*m_pStorage) ParseTree::VariableDeclaration;
+
+        pDeclaration->Opcode = Opcode;
+        pDeclaration->Type = ReadType();
+        ReadLocation(&pDeclaration->TextSpan);
+        ReadPunctuator(&pDeclaration->As);
+
+        ParseTree::DeclaratorList ** ppVariablesTail = &pDeclaration->Variables;
+
+        for (unsigned __int64 VariableCount = ReadUnsigned(); VariableCount > 0; VariableCount--)
+        {
+            ParseTree::DeclaratorList * pVariables = new(*m_pStorage) ParseTree::DeclaratorList;
+            ParseTree::Declarator * pDeclarator = new(*m_pStorage) ParseTree::Declarator;
+
+            ReadListNode(pVariables);
+            ReadIdentifier(&pDeclarator->Name);
+
+            ParseTree::Type * pArrayInfo = ReadType();
+            pDeclarator->ArrayInfo = pArrayInfo ? pArrayInfo->AsArray() : NULL;
+
+            ReadLocation(&pDeclarator->TextSpan);
+            pDeclarator->ResumeIndex = (unsigned short)ReadUnsigned();
+            pDeclarator->IsForControlVarDeclaration = ReadBool();
+
+            pVariables->Element = pDeclarator;
+            *ppVariablesTail = pVariables;
+            ppVariablesTail = &pVariables->Next;
+        }
+
+        if (Opcode == ParseTree::VariableDeclaration::WithInitializer)
+        {
+            pDeclaration->AsInitializer()->InitialValue = ReadInitializer();
+            ReadPunctuator(&pDeclaration->AsInitializer()->Equals);
+        }
+
+        pNode->Element = pDeclaration;
+        *ppTail = pNode;
+        ppTail = &pNode->Next;
+    }
+
+    return pDeclarations;
+}
+
+ParseTree::Initializer *
+CompactParseTreeReader::ReadInitializer
+(
+)
+{
+    if (!ReadBool())
+    {
+        return NULL;
+    }
+
+    ParseTree::ExpressionInitializer * pInitializer = new(*m_pStorage) ParseTree::ExpressionInitializer;
+
+    pInitializer->Opcode = ParseTree::Initializer::Expression;
+    ReadPunctuator(&pInitializer->Key);
+    pInitializer->FieldIsKey = ReadBool();
+    pInitializer->Value = ReadExpression();
+
+    return pInitializer;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// CompactParseTree
+//
+//-------------------------------------------------------------------------------------------------
+
+CompactParseTree *
+CompactParseTree::Compact
+(
+    _In_ ParseTree::MethodBodyStatement * pBody,
+    _In_ NorlsAllocator * pStorage
+)
+{
+    ThrowIfNull(pBody);
+    ThrowIfNull(pStorage);
+
+    NorlsAllocator Scratch(NORLSLOC);
+    CompactParseTreeWriter Writer(&Scratch);
+
+    return Writer.Write(pBody, pStorage);
+}
+
+ParseTree::MethodBodyStatement *
+CompactParseTree::Expand
+(
+    _In_ NorlsAllocator * pTreeStorage,
+    long LineDelta
+) const
+{
+    ThrowIfNull(pTreeStorage);
+
+    CompactParseTreeReader Reader(this, m_pData, m_cbData, m_Identifiers, m_cIdentifiers, pTreeStorage, LineDelta);
+
+    return Reader.Read();
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// MethodBodyParseCache
+//
+//-------------------------------------------------------------------------------------------------
+
+MethodBodyParseCache::MethodBodyParseCache() :
+    m_Storage(NORLSLOC),
+    m_cbStored(0)
+{
+}
+
+void
+MethodBodyParseCache::MakeKey
+(
+    _In_count_(cchText) const WCHAR * wszText,
+    size_t cchText,
+    long BegColumn,
+    ParseTree::Statement::Opcodes MethodBodyKind,
+    MethodDeclKind methodDeclKind,
+    bool IsXMLDocOn,
+    LANGVERSION LanguageVersion,
+    _Out_ BodyKey * pKey
+)
+{
+    // Two bodies with the same text but parsed differently never share an
+    // entry.  The begin column matters because it is the column of the first
+    // token of the first line.
+    pKey->Text = wszText;
+    pKey->cchText = cchText;
+    pKey->Settings[0] = BegColumn;
+    pKey->Settings[1] = MethodBodyKind;
+    pKey->Settings[2] = methodDeclKind;
+    pKey->Settings[3] = IsXMLDocOn ? 1 : 0;
+    pKey->Settings[4] = LanguageVersion;
+
+    CRC64 crc(pKey->Settings, sizeof(pKey->Settings));
+    crc.Update(wszText, (unsigned)VBMath::Multiply(cchText, sizeof(WCHAR)));
+
+    pKey->Hash = crc;
+}
+
+bool
+MethodBodyParseCache::Matches
+(
+    const CachedBody & Body,
+    const BodyKey & Key
+)
+{
+    return Body.cchText == Key.cchText &&
+        memcmp(Body.Settings, Key.Settings, sizeof(Key.Settings)) == 0 &&
+        wmemcmp(Body.Text, Key.Text, Key.cchText) == 0;
+}
+
+bool
+MethodBodyParseCache::IsCacheable
+(
+    _In_count_(cchText) const WCHAR * wszText,
+    size_t cchText
+)
+{
+    // '#' also starts date literals and ends Double type characters, which
+    // are simply not cached.
+    return wmemchr(wszText, L'#', cchText) == NULL;
+}
+
+ParseTree::MethodBodyStatement *
+MethodBodyParseCache::TryExpand
+(
+    const BodyKey & Key,
+    long BegLine,
+    _In_ NorlsAllocator * pTreeStorage
+)
+{
+    CompilerIdeLock spLock(m_cs);
+
+    CachedBody Body;
+
+    if (!m_Bodies.GetValue(Key.Hash, &Body) || !Body.Tree || !Matches(Body, Key))
+    {
+        return NULL;
+    }
+
+    return Body.Tree->Expand(pTreeStorage, BegLine - Body.BegLine);
+}
+
+void
+MethodBodyParseCache::Add
+(
+    const BodyKey & Key,
+    long BegLine,
+    _In_ ParseTree::MethodBodyStatement * pBody
+)
+{
+    CompilerIdeLock spLock(m_cs);
+
+    // A different body with the same hash keeps its entry.
+    if (m_Bodies.Contains(Key.Hash))
+    {
+        return;
+    }
+
+    if (m_cbStored > MaxStoredBytes)
+    {
+        m_Bodies.Clear();
+        m_Storage.FreeHeap();
+        m_cbStored = 0;
+    }
+
+    // Bodies that cannot be compacted are recorded without a tree, so that
+    // they are not walked again each time they are parsed.
+    CompactParseTree * pCompact = CompactParseTree::Compact(pBody, &m_Storage);
+    CachedBody Body = { pCompact, BegLine };
+
+    memcpy(Body.Settings, Key.Settings, sizeof(Key.Settings));
+
+    if (pCompact)
+    {
+        size_t cbText = VBMath::Multiply(Key.cchText, sizeof(WCHAR));
+        WCHAR * pText = (WCHAR *)m_Storage.Alloc(cbText);
+
+        memcpy(pText, Key.Text, cbText);
+        Body.Text = pText;
+        Body.cchText = Key.cchText;
+
+        m_cbStored += pCompact->GetSize() + cbText;
+    }
+    else
+    {
+        m_cbStored += sizeof(CachedBody);
+    }
+
+    m_Bodies.SetValue(Key.Hash, Body);
+}
+
+void
+MethodBodyParseCache::Clear
+(
+)
+{
+    CompilerIdeLock spLock(m_cs);
+
+    m_Bodies.Clear();
+    m_Storage.FreeHeap();
+    m_cbStored = 0;
+}
@@ -0,0 +1,146 @@
+//-------------------------------------------------------------------------------------------------
+//
+//  Copyright (c) Microsoft Corporation.  All rights reserved.
+//
+//  Compact serialized form of method body parse trees.
+//
+//  A method body tree is flattened into a byte stream in which statements are numbered in
+//  lexical order and refer to each other (parent, terminating construct, containing If or
+//  Try) by 32-bit statement index instead of by pointer.  Locations are packed relative to
+//  the previous location, identifiers are stored once in a table of pooled STRINGs, and
+//  the statement list links are rebuilt on expansion.  A cached body costs a small fraction
+//  of the memory of the NorlsAllocator tree it was made from.
+//
+//  Only the constructs that occur in most method bodies are supported.  Compact returns
+//  NULL for a tree that contains anything else (or any syntax error); such bodies must be
+//  kept in full or parsed again.
+//
+//-------------------------------------------------------------------------------------------------
+
+#pragma once
+
+class CompactParseTreeWriter;
+class CompactParseTreeReader;
+
+class CompactParseTree
+{
+    friend class CompactParseTreeWriter;
+
+public:
+    // Returns NULL if the tree contains constructs that cannot be compacted.
+    // The method definition is not part of the body and is not recorded.
+    static CompactParseTree * Compact(
+        _In_ ParseTree::MethodBodyStatement * pBody,
+        _In_ NorlsAllocator * pStorage);
+
+    // Rebuilds the method body tree in pTreeStorage, moving every location by
+    // LineDelta lines.  The Definition of the returned body is NULL; callers
+    // attach it as ::ParseCodeBlock does.
+    ParseTree::MethodBodyStatement * Expand(
+        _In_ NorlsAllocator * pTreeStorage,
+        long LineDelta = 0) const;
+
+    size_t GetSize() const
+    {
+        return sizeof(*this) + m_cbData + m_cIdentifiers * sizeof(STRING *);
+    }
+
+    unsigned GetStatementCount() const
+    {
+        return m_cStatements;
+    }
+
+private:
+    CompactParseTree()
+    {
+    }
+
+    const BYTE * m_pData;
+    size_t m_cbData;
+    STRING ** m_Identifiers;
+    unsigned m_cIdentifiers;
+    unsigned m_cStatements;
+};
+
+//-------------------------------------------------------------------------------------------------
+//
+// Method bodies that parsed without diagnostics, kept in compact form and keyed by a hash
+// of their text and of the parser settings.  The declaration parse only records where each
+// body starts and ends (Parser::FindEndProc); when a body is needed and its text has not
+// changed since it was last parsed, it is expanded from here instead of being parsed again,
+// even if edits elsewhere in the file have moved it to other lines.  The text and settings
+// are kept with each entry and compared before it is used, so a hash collision only costs
+// a parse.
+//
+//-------------------------------------------------------------------------------------------------
+
+class MethodBodyParseCache
+{
+public:
+    MethodBodyParseCache();
+
+    // The text of a body and the settings it is parsed with.
+    struct BodyKey
+    {
+        const WCHAR * Text;
+        size_t cchText;
+        long Settings[5];
+        UINT64 Hash;
+    };
+
+    static void MakeKey(
+        _In_count_(cchText) const WCHAR * wszText,
+        size_t cchText,
+        long BegColumn,
+        ParseTree::Statement::Opcodes MethodBodyKind,
+        MethodDeclKind methodDeclKind,
+        bool IsXMLDocOn,
+        LANGVERSION LanguageVersion,
+        _Out_ BodyKey * pKey);
+
+    // Can a body with this text be cached at all?  Bodies with conditional
+    // compilation directives depend on more than their own text.
+    static bool IsCacheable(
+        _In_count_(cchText) const WCHAR * wszText,
+        size_t cchText);
+
+    // Returns NULL if no body with this key is cached, or if it could not
+    // be compacted.
+    ParseTree::MethodBodyStatement * TryExpand(
+        const BodyKey & Key,
+        long BegLine,
+        _In_ NorlsAllocator * pTreeStorage);
+
+    void Add(
+        const BodyKey & Key,
+        long BegLine,
+        _In_ ParseTree::MethodBodyStatement * pBody);
+
+    // Called when the file is removed and when its parse trees are
+    // invalidated.  Decompiling the file keeps the entries, since the bodies
+    // that were not edited are the ones parsed again afterwards.
+    void Clear();
+
+private:
+    struct CachedBody
+    {
+        CompactParseTree * Tree;    // NULL if the body could not be compacted
+        long BegLine;
+        long Settings[5];
+        const WCHAR * Text;         // Copy of the text in m_Storage, NULL if Tree is NULL
+        size_t cchText;
+    };
+
+    static bool Matches(
+        const CachedBody & Body,
+        const BodyKey & Key);
+
+    // Bodies of methods that were since edited are never looked up again, so
+    // the cache is dropped whenever it outgrows this.
+    static const size_t MaxStoredBytes = 4 * 1024 * 1024;
+
+    CompilerIdeCriticalSection m_cs;
+    NorlsAllocator m_Storage;
+    DynamicHashTable<UINT64, CachedBody> m_Bodies;
+    size_t m_cbStored;
+};
@@ -3491,6 +3491,28 @@ RuntimeMemberDescriptor  g_rgRTLangMembers[] =
         /* arg types     */       ARG1((Vtypes)(m_array | t_char))
     },
 
+    {
+        RTNM(StringLengthMember)
+        TLIB(TLB_Desktop | TLB_Starlite)
+        RTNV(RuntimeVersion1)
+        RTF_METHOD | RTF_GET_PROP | RTF_NONVIRTUAL,
+        /* parent class  */       COMStringClass,
+        /* method name   */       WIDE("Length"),
+        /* ret type      */       t_i4,
+        /* arg types     */       ARG0()
+    },
+
+    {
+        RTNM(StringCharsMember)
+        TLIB(TLB_Desktop | TLB_Starlite)
+        RTNV(RuntimeVersion1)
+        RTF_METHOD | RTF_GET_PROP | RTF_NONVIRTUAL,
+        /* parent class  */       COMStringClass,
+        /* method name   */       WIDE("Chars"),
+        /* ret type      */       t_char,
+        /* arg types     */       ARG1(t_i4)
+    },
+
     //
     // System.Type
     //
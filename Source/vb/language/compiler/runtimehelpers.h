@@ -658,6 +658,8 @@ enum RuntimeMembers
     //
     StringConcatenationMember,
     CharArrayToStringMember,
+    StringLengthMember,
+    StringCharsMember,
 
     //
     // System.Type
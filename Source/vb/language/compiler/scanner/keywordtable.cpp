@@ -69,6 +69,195 @@ const long g_tkKwdNameLengths[tkKwdCount] =
     #undef  KWD_QUO
 };
 
+/*****************************************************************************/
+
+//
+// Perfect hash over the spellings of the identifier keywords
+// (tkKwdIdFirst, tkKwdIdLast]. The first level hash picks a bucket; each
+// bucket has a seed, chosen when the table is built, that scatters its
+// keywords into distinct slots. A lookup is one pass over the spelling, two
+// table reads and a verifying compare.
+//
+// The table is built once at startup from g_tkKwdNames, so it always
+// matches keywords.h.
+//
+
+#define KWD_HASH_BUCKETS        64
+#define KWD_HASH_SLOTS          256     // must be at least the number of keywords
+#define KWD_HASH_MAX_SEED       0x10000
+
+class KeywordHashTable
+{
+public:
+    KeywordHashTable();
+
+    tokens Lookup(
+        _In_count_(cchSpelling) const WCHAR *pwchSpelling,
+        size_t cchSpelling) const;
+
+private:
+    static unsigned Slot(unsigned Hash, unsigned Seed)
+    {
+        return ((Hash ^ (Seed * 0x9E3779B1)) * 0x85EBCA6B) >> 24;
+    }
+
+    // Case folded FNV-1a. Returns false if the spelling has a non-ASCII character.
+    static bool HashSpelling(
+        _In_count_(cchSpelling) const WCHAR *pwchSpelling,
+        size_t cchSpelling,
+        _Out_ unsigned *pHash);
+
+    bool m_IsValid;
+    long m_cchLongestKeyword;
+    unsigned short m_BucketSeeds[KWD_HASH_BUCKETS];
+    unsigned short m_Slots[KWD_HASH_SLOTS];     // tokens; tkNone if empty
+};
+
+C_ASSERT(KWD_HASH_SLOTS == 1 << 8);     // Slot() yields the top 8 bits
+C_ASSERT(KWD_HASH_SLOTS >= tkKwdIdLast);
+
+static const KeywordHashTable g_KeywordHashTable;
+
+bool KeywordHashTable::HashSpelling(
+    _In_count_(cchSpelling) const WCHAR *pwchSpelling,
+    size_t cchSpelling,
+    _Out_ unsigned *pHash)
+{
+    unsigned Hash = 2166136261;
+    WCHAR AllCharacters = 0;
+
+    for (size_t i = 0; i < cchSpelling; i++)
+    {
+        AllCharacters |= pwchSpelling[i];
+        Hash = (Hash ^ (pwchSpelling[i] | 0x20)) * 16777619;
+    }
+
+    *pHash = Hash;
+    return AllCharacters < 128;
+}
+
+KeywordHashTable::KeywordHashTable() :
+    m_IsValid(false),
+    m_cchLongestKeyword(0)
+{
+    memset(m_BucketSeeds, 0, sizeof(m_BucketSeeds));
+    memset(m_Slots, 0, sizeof(m_Slots));
+
+    // Distribute the keywords into buckets.
+    unsigned Hashes[tkKwdIdLast + 1];
+    unsigned BucketSizes[KWD_HASH_BUCKETS] = { 0 };
+
+    for (int tk = tkKwdIdFirst + 1; tk <= tkKwdIdLast; tk++)
+    {
+        VSASSERT(g_tkKwdNameLengths[tk] > 0, "Identifier keyword without a spelling");
+
+        if (!HashSpelling(g_tkKwdNames[tk], g_tkKwdNameLengths[tk], &Hashes[tk]))
+        {
+            VSFAIL("Identifier keywords are expected to be ASCII");
+            return;
+        }
+
+        BucketSizes[Hashes[tk] % KWD_HASH_BUCKETS]++;
+        m_cchLongestKeyword = max(m_cchLongestKeyword, g_tkKwdNameLengths[tk]);
+    }
+
+    // Place the largest buckets first, while the table is still sparse.
+    for (unsigned BucketSize = tkKwdIdLast; BucketSize > 0; BucketSize--)
+    {
+        for (unsigned Bucket = 0; Bucket < KWD_HASH_BUCKETS; Bucket++)
+        {
+            if (BucketSizes[Bucket] != BucketSize)
+            {
+                continue;
+            }
+
+            unsigned Seed;
+            for (Seed = 0; Seed < KWD_HASH_MAX_SEED; Seed++)
+            {
+                unsigned short Placed[KWD_HASH_SLOTS / 16] = { 0 };
+                bool Fits = true;
+
+                for (int tk = tkKwdIdFirst + 1; Fits && tk <= tkKwdIdLast; tk++)
+                {
+                    if (Hashes[tk] % KWD_HASH_BUCKETS == Bucket)
+                    {
+                        unsigned iSlot = Slot(Hashes[tk], Seed);
+
+                        Fits = m_Slots[iSlot] == tkNone && !(Placed[iSlot / 16] & (1 << (iSlot % 16)));
+                        Placed[iSlot / 16] |= 1 << (iSlot % 16);
+                    }
+                }
+
+                if (Fits)
+                {
+                    break;
+                }
+            }
+
+            if (Seed == KWD_HASH_MAX_SEED)
+            {
+                // Two keywords with the same hash, or the table is too small.
+                VSFAIL("Unable to build the keyword hash table");
+                return;
+            }
+
+            m_BucketSeeds[Bucket] = (unsigned short)Seed;
+
+            for (int tk = tkKwdIdFirst + 1; tk <= tkKwdIdLast; tk++)
+            {
+                if (Hashes[tk] % KWD_HASH_BUCKETS == Bucket)
+                {
+                    m_Slots[Slot(Hashes[tk], Seed)] = (unsigned short)tk;
+                }
+            }
+        }
+    }
+
+    m_IsValid = true;
+}
+
+tokens KeywordHashTable::Lookup(
+    _In_count_(cchSpelling) const WCHAR *pwchSpelling,
+    size_t cchSpelling) const
+{
+    unsigned Hash;
+
+    if (!m_IsValid ||
+        cchSpelling == 0 ||
+        cchSpelling > (size_t)m_cchLongestKeyword ||
+        !HashSpelling(pwchSpelling, cchSpelling, &Hash))
+    {
+        return tkNone;
+    }
+
+    tokens tk = (tokens)m_Slots[Slot(Hash, m_BucketSeeds[Hash % KWD_HASH_BUCKETS])];
+
+    if (tk == tkNone || (size_t)g_tkKwdNameLengths[tk] != cchSpelling)
+    {
+        return tkNone;
+    }
+
+    // Keywords are all letters, for which OR-ing in 0x20 is an exact case fold.
+    const WCHAR *pwchKeyword = g_tkKwdNames[tk];
+
+    for (size_t i = 0; i < cchSpelling; i++)
+    {
+        if ((pwchSpelling[i] | 0x20) != (pwchKeyword[i] | 0x20))
+        {
+            return tkNone;
+        }
+    }
+
+    return tk;
+}
+
+tokens KeywordOfSpelling(
+    _In_count_(cchSpelling) const WCHAR *pwchSpelling,
+    size_t cchSpelling)
+{
+    return g_KeywordHashTable.Lookup(pwchSpelling, cchSpelling);
+}
+
 #if IDE 
 
 STRING *TokenToString(tokens tok)
@@ -86,6 +86,14 @@ STRING *TokenToString(tokens tok);
 
 tokens TokenOfString(_In_z_ STRING *pstr);
 
+// Maps an identifier spelling to the keyword it spells, without going
+// through the string pool. Matching is ASCII case insensitive. Returns
+// tkNone for anything else, including spellings with non-ASCII (e.g. full
+// width) characters, which only the string pool resolves.
+tokens KeywordOfSpelling(
+    _In_count_(cchSpelling) const WCHAR *pwchSpelling,
+    size_t cchSpelling);
+
 inline
 OperatorPrecedence TokenOpPrec(tokens  tok)
 {
@@ -8,6 +8,14 @@
 
 #include "StdAfx.h"
 
+// SSE2 is always available on x64, and on x86 when the build targets it.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCANNER_SIMD 1
+#include <emmintrin.h>
+#else
+#define SCANNER_SIMD 0
+#endif
+
 #if IDE
 typedef int (STDAPICALLTYPE *PFN_GetCalendarInfoA)(LCID, CALID, CALTYPE, LPTSTR, int, LPDWORD);
 const char szCalendarInfo[] = "GetCalendarInfoA";
@@ -317,6 +325,162 @@ IsIdentifierCharacter
     return IsWideIdentifierCharacter(c);
 }
 
+//
+// Bulk character classification. Each of these skips a run of the common
+// ASCII characters of one class, 8 code units at a time where possible, and
+// returns the first character that may not belong to it. Callers handle that
+// character (typically non-ASCII) with the usual per character test and then
+// resume the run.
+//
+
+#if SCANNER_SIMD
+
+// Index of the first code unit whose lane in Mask is clear; 8 if none is.
+inline unsigned
+FirstClearLane
+(
+    __m128i Mask
+)
+{
+    unsigned Bits = ~(unsigned)_mm_movemask_epi8(Mask) & 0xFFFF;
+    unsigned long Index;
+
+    if (!_BitScanForward(&Index, Bits))
+    {
+        return 8;
+    }
+
+    return Index / 2;
+}
+
+// Lanes of Chars within [Low, High]. Code units >= 0x8000 compare as
+// negative and are never in an ASCII range.
+inline __m128i
+InRange16
+(
+    __m128i Chars,
+    short Low,
+    short High
+)
+{
+    return _mm_and_si128(
+        _mm_cmpgt_epi16(Chars, _mm_set1_epi16(Low - 1)),
+        _mm_cmplt_epi16(Chars, _mm_set1_epi16(High + 1)));
+}
+
+#endif SCANNER_SIMD
+
+// Skips [A-Za-z0-9_].
+inline const WCHAR *
+SkipAsciiIdentifierCharacters
+(
+    _In_ const WCHAR *Here,
+    _In_ const WCHAR *End
+)
+{
+#if SCANNER_SIMD
+    const __m128i Underscore = _mm_set1_epi16('_');
+
+    while (End - Here >= 8)
+    {
+        __m128i Chars = _mm_loadu_si128((const __m128i *)Here);
+        __m128i IsId =
+            _mm_or_si128(
+                _mm_or_si128(InRange16(Chars, 'a', 'z'), InRange16(Chars, 'A', 'Z')),
+                _mm_or_si128(InRange16(Chars, '0', '9'), _mm_cmpeq_epi16(Chars, Underscore)));
+
+        unsigned Run = FirstClearLane(IsId);
+        Here += Run;
+
+        if (Run < 8)
+        {
+            return Here;
+        }
+    }
+#endif SCANNER_SIMD
+
+    while (Here < End && *Here < 128 && IsIDChar[*Here])
+    {
+        Here++;
+    }
+
+    return Here;
+}
+
+// Skips spaces and tabs.
+inline const WCHAR *
+SkipAsciiBlanks
+(
+    _In_ const WCHAR *Here,
+    _In_ const WCHAR *End
+)
+{
+#if SCANNER_SIMD
+    const __m128i Space = _mm_set1_epi16(' ');
+    const __m128i Tab = _mm_set1_epi16('\t');
+
+    while (End - Here >= 8)
+    {
+        __m128i Chars = _mm_loadu_si128((const __m128i *)Here);
+        __m128i Blanks = _mm_or_si128(_mm_cmpeq_epi16(Chars, Space), _mm_cmpeq_epi16(Chars, Tab));
+
+        unsigned Run = FirstClearLane(Blanks);
+        Here += Run;
+
+        if (Run < 8)
+        {
+            return Here;
+        }
+    }
+#endif SCANNER_SIMD
+
+    while (Here < End && (*Here == ' ' || *Here == '\t'))
+    {
+        Here++;
+    }
+
+    return Here;
+}
+
+// Skips ASCII characters other than CR and LF, i.e. stops on anything
+// that could be a line break.
+inline const WCHAR *
+SkipToPossibleLineBreak
+(
+    _In_ const WCHAR *Here,
+    _In_ const WCHAR *End
+)
+{
+#if SCANNER_SIMD
+    const __m128i Cr = _mm_set1_epi16(UCH_CR);
+    const __m128i Lf = _mm_set1_epi16(UCH_LF);
+    const __m128i NonAscii = _mm_set1_epi16((short)0xFF80);
+    const __m128i Zero = _mm_setzero_si128();
+
+    while (End - Here >= 8)
+    {
+        __m128i Chars = _mm_loadu_si128((const __m128i *)Here);
+        __m128i IsAscii = _mm_cmpeq_epi16(_mm_and_si128(Chars, NonAscii), Zero);
+        __m128i IsCrOrLf = _mm_or_si128(_mm_cmpeq_epi16(Chars, Cr), _mm_cmpeq_epi16(Chars, Lf));
+
+        unsigned Run = FirstClearLane(_mm_andnot_si128(IsCrOrLf, IsAscii));
+        Here += Run;
+
+        if (Run < 8)
+        {
+            return Here;
+        }
+    }
+#endif SCANNER_SIMD
+
+    while (Here < End && *Here < 128 && *Here != UCH_CR && *Here != UCH_LF)
+    {
+        Here++;
+    }
+
+    return Here;
+}
+
 inline bool
 BeginsExponent
 (
@@ -971,9 +1135,17 @@ Scanner::EatWhitespace
 
     const WCHAR *Here = m_InputStreamPosition + 1;
 
-    while (Here < m_InputStreamEnd && IsBlank(*Here)) {
+    for (;;)
+    {
+        Here = SkipAsciiBlanks(Here, m_InputStreamEnd);
 
-        Here++;
+        if (Here < m_InputStreamEnd && *Here >= 128 && IsBlank(*Here))
+        {
+            Here++;
+            continue;
+        }
+
+        break;
     }
 
     m_InputStreamPosition = Here;
@@ -1209,11 +1381,11 @@ void Scanner::ScanComment
 
     const WCHAR *CommentStart = Here;
 
-    while (Here < m_InputStreamEnd) {
-
-        WCHAR Next = *Here;
+    for (;;)
+    {
+        Here = SkipToPossibleLineBreak(Here, m_InputStreamEnd);
 
-        if (IsLineBreak(Next))
+        if (Here >= m_InputStreamEnd || IsLineBreak(*Here))
             break;
 
         Here++;
@@ -1276,13 +1448,20 @@ Scanner::ScanIdentifier
         return;
     }
 
-    // The C++ compiler refuses to inline IsIdentifierCharacter, so the
-    // < 128 test is inline here. (This loop gets a *lot* of traffic.)
+    // Skip ASCII runs in bulk; only wide characters are classified one at
+    // a time. (This loop gets a *lot* of traffic.)
 
-    while (Here < m_InputStreamEnd &&
-           (*Here < 128 ? IsIDChar[*Here] : IsWideIdentifierCharacter(*Here)))
+    for (;;)
     {
-        Here++;
+        Here = SkipAsciiIdentifierCharacters(Here, m_InputStreamEnd);
+
+        if (Here < m_InputStreamEnd && *Here >= 128 && IsWideIdentifierCharacter(*Here))
+        {
+            Here++;
+            continue;
+        }
+
+        break;
     }
 
     size_t IdStringLength = (size_t)(Here - IdStart);
@@ -1298,14 +1477,37 @@ Scanner::ScanIdentifier
         IdStringLength = MaxIdentifierLength;
     }
 
-    STRING *IdString;
+    STRING *IdString = NULL;
+
+    tokens IdAsKeyword = KeywordOfSpelling(IdStart, IdStringLength);
+
+    // A keyword spelled with its canonical casing can use the string the
+    // pool already holds for it, which saves hashing and locking the pool.
+    if (IdAsKeyword != tkNone)
+    {
+        STRING *KeywordString = m_pStringPool->TokenToString(IdAsKeyword);
 
-    IdString =
-        m_pStringPool->AddStringWithLen(
-            IdStart,
-            IdStringLength);
+        if (memcmp(KeywordString, IdStart, IdStringLength * sizeof(WCHAR)) == 0)
+        {
+            IdString = KeywordString;
+        }
+    }
+
+    if (IdString == NULL)
+    {
+        IdString =
+            m_pStringPool->AddStringWithLen(
+                IdStart,
+                IdStringLength);
+
+        // Full width keywords are only known to the string pool.
+        if (IdAsKeyword == tkNone)
+        {
+            IdAsKeyword = (tokens)StringPool::TokenOfString(IdString);
+        }
+    }
 
-    tokens IdAsKeyword = (tokens)StringPool::TokenOfString(IdString);
+    VSASSERT(IdAsKeyword == (tokens)StringPool::TokenOfString(IdString), "Keyword hash disagrees with the string pool");
 
     typeChars TypeCharacter = chType_NONE;
 
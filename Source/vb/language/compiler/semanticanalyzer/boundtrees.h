@@ -395,6 +395,8 @@ struct LABEL_ENTRY_BIL
 
   #define SBF_SELECT_HAS_CASE_ELSE    0x2000    // SL_SELECT as tableswitch
   #define SBF_SELECT_TABLE            0x1000    // SL_SELECT as tableswitch
+  #define SBF_SELECT_HASH             0x4000    // SL_SELECT as switch on the hash of a string selector
+  #define SBF_SELECT_SPARSE           0x8000    // SL_SELECT as binary search over clustered tableswitches
 
   #define SBF_CASE_CONDITION          0x2000
   #define SBF_CASE_ISELSE             0x1000    // CASE
@@ -849,6 +851,18 @@ namespace ILTree
 	};
 
 
+	//*****************************************************************************
+	// For sparse Select Case: the values of all the cases, sorted and disjoint
+	//*****************************************************************************
+	struct SelectCaseRange
+	{
+	    __int64           Low;
+	    __int64           High;
+	    unsigned          CaseIndex;   // ordinal of the Case among the children of the Select
+	    bool              StartsCluster; // first range of a cluster dispatched through one tableswitch
+	};
+
+
 	// Use AsSelectBlock() accessor.
 	struct SelectBlock : IfSelectBlock
 	{
@@ -857,6 +871,8 @@ namespace ILTree
 	    SWITCH_TABLE    * SwitchTable;        // table switch
 	    __int64           Minimum;
 	    __int64           Maximum;
+	    SelectCaseRange * CaseRanges;         // sparse switch, sorted by value
+	    unsigned          CaseRangeCount;
     
         SymbolReferenceExpression *LiftedSelectorTemporary;  // If used in a resumable method, we have to lift the temporaries
 	};
@@ -901,6 +917,7 @@ namespace ILTree
 	// Use AsCaseBlock() accessor.
 	struct CaseBlock : IfCaseBlock
 	{
+		CODE_BLOCK *EntryBlock;   // used by codegen when the Select dispatches directly to each Case
 	};
 
 	// Use AsTryBlock() accessor.
@@ -77,6 +77,11 @@
 //  that Closure2 is still the immediate parent of Closure3.  Empty blocks don't
 //  factor into the reparenting process.
 //
+//  When generating optimized code, a closure is first merged into the closure of
+//  an enclosing block if its block is entered at most once per instance of the
+//  enclosing closure.  In the example above Closure3 would be folded into
+//  Closure2 so only one object is allocated when the blocks are executed.
+//
 //  The BILTREE is not altered in this phase.
 //
 //  Phase 3: Closure class creation
@@ -142,6 +147,8 @@
 //  The ClosureRoot will fixup all the lambda references it found in Phase 1 to
 //  point to the newly reparented procedure in the Closure class.  This will case
 //  the SX_LAMBDA billtree nodes to be turned into delegate calls (SX_ADDRESSOF).
+//  Lambdas which were optimized into Shared methods cache their delegate in a
+//  Shared field so that it is only allocated the first time it is evaluated.
 //
 //  Additionally ExpressionTrees will be converted at this point as well.
 //
@@ -245,6 +252,25 @@ bool IsSpecialScopeExecutableBlock(ILTree::ExecutableBlock *block)
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//
+// Whether or not the block is re-entered for every iteration of a loop.  Closures
+// associated with these blocks are created once per iteration.
+//
+bool IsLoopExecutableBlock(ILTree::ExecutableBlock *block)
+{
+    ThrowIfNull(block);
+    switch ( block->bilop )
+    {
+        case SB_FOR:
+        case SB_FOR_EACH:
+        case SB_LOOP:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void UpdateStatementList(ILTree::Statement **first, ILTree::Statement **last, ILTree::Statement *created)
 {
     AssertIfNull(first);
@@ -786,6 +812,20 @@ STRING *ClosureNameMangler::EncodeMyBaseMyClassStubName(Compiler *compiler, Proc
     return compiler->AddString(&buf);
 }
 
+//==============================================================================
+// Name of the Shared field caching the delegate of an optimized lambda.  The
+// name will be prefixed with $VB$CachedLambda_
+//==============================================================================
+STRING *ClosureNameMangler::EncodeCachedLambdaName(Compiler *compiler, Procedure *proc)
+{
+    ThrowIfNull(compiler);
+    ThrowIfNull(proc);
+
+    StringBuffer buf;
+    buf.AppendPrintf(CLOSURE_CACHEDLAMBDA_PREFIX L"%s", proc->GetName());
+    return compiler->AddString(&buf);
+}
+
 
 //==============================================================================
 // End ClosureNameMangler
@@ -797,6 +837,7 @@ ClosureRoot::ClosureRoot(Procedure *proc, ILTree::ProcedureBlock *body, Semantic
     m_state(CRState_None),
     m_procContainsGoto(false),
     m_genEncCode(false),
+    m_genOptimalIL(false),
     m_lambdaNestLevel(0),
     m_semantics(semantics),
     m_pCompiler(semantics->m_Compiler),
@@ -830,6 +871,7 @@ ClosureRoot::ClosureRoot(Procedure *proc, ILTree::ProcedureBlock *body, Semantic
     if ( semantics->m_SourceFile && semantics->m_SourceFile->GetProject() )
     {
         m_genEncCode = semantics->m_SourceFile->GetProject()->GenerateENCableCode();
+        m_genOptimalIL = semantics->m_SourceFile->GetProject()->GenerateOptimalIL();
     }
 }
 
@@ -2374,6 +2416,7 @@ void ClosureRoot::CreateClosureCode()
 
 #endif // DEBUG
 
+    this->MergeClosureScopes();
     this->FixupClosureTreeStructure();
     this->CreateClosureClassCode();
 
@@ -2681,6 +2724,101 @@ void ClosureRoot::FixupShortLivedTemporaries()
     ChangeState(CRState_PostShortLivedFixup);
 }
 
+//==============================================================================
+// Fold closures into the closure of an enclosing block when their lifetimes
+// coincide.  This has to run before the lambdas are parented since lambdas are
+// assigned to the nearest closure of the block they occur in.
+//
+// Merging is not done for ENC since the closure layout must be stable between
+// compiles, nor when the procedure contains a goto since a jump backwards
+// could re-enter the merged block with the same closure instance.
+//==============================================================================
+void ClosureRoot::MergeClosureScopes()
+{
+    EnsureInState(CRState_BiltreeWellFormed);
+
+    if ( m_genEncCode || !m_genOptimalIL || m_procContainsGoto || m_map.Count() < 2 )
+    {
+        return;
+    }
+
+    // Process the closures in a stable order so the generated classes are
+    // the same between compiles
+    ConstIterator<KeyValuePair<ILTree::ExecutableBlock*,Closure*> > mapIt = m_map.GetConstIterator();
+    ArrayList<Closure*,NorlsAllocWrapper> sortedList(m_alloc);
+    while (mapIt.MoveNext())
+    {
+        sortedList.Add(mapIt.Current().Value());
+    }
+
+    ClosureLocationComparer comp;
+    sortedList.Sort(comp);
+
+    bool merged = false;
+    Iterator<Closure*> it = sortedList.GetIterator();
+    while ( it.MoveNext() )
+    {
+        Closure *current = it.Current();
+        Closure *target = FindMergeTarget(current);
+        if ( target )
+        {
+            target->MergeScope(current);
+            m_map.Remove(current->GetBlock());
+            merged = true;
+        }
+    }
+
+    if ( merged )
+    {
+        m_nearestMap.Clear();
+    }
+}
+
+//==============================================================================
+// Find the closure of an enclosing block which can absorb the variables of the
+// passed in closure.  The block of the closure must be entered at most once for
+// every instance of the enclosing closure, so the search stops at loops and at
+// lambda boundaries.
+//
+// Closures of loop blocks are created from the previous iteration's instance
+// with the copy constructor.  They are never a target because a merged
+// variable would then start with its value from the previous iteration
+// instead of its default value.
+//==============================================================================
+Closure *ClosureRoot::FindMergeTarget(Closure *closure)
+{
+    ThrowIfNull(closure);
+
+    ILTree::ExecutableBlock *block = closure->GetBlock();
+    if ( SB_PROC == block->bilop ||
+        SB_CATCH == block->bilop ||
+        ::IsLoopExecutableBlock(block) )
+    {
+        return NULL;
+    }
+
+    ILTree::ExecutableBlock *current = block->Parent;
+    while ( current )
+    {
+        Closure *target = GetClosure(current);
+        if ( target )
+        {
+            return !::IsLoopExecutableBlock(current) && target->CanMergeScope(closure)
+                ? target
+                : NULL;
+        }
+
+        if ( SB_PROC == current->bilop || ::IsLoopExecutableBlock(current) )
+        {
+            break;
+        }
+
+        current = current->Parent;
+    }
+
+    return NULL;
+}
+
 void ClosureRoot::FixupClosureTreeStructure()
 {
     // First part is to assign all of the lambdas to the closures that
@@ -3977,6 +4115,60 @@ void Closure::EnsureVariableLifted(Variable *var)
     }
 }
 
+//==============================================================================
+// Whether the variables of the passed in closure can be moved into this one.
+// The lifted fields are named after the variables so two variables with the
+// same name from sibling scopes cannot share a closure.  Catch variables are
+// left alone since their initialization is tied to the catch block.
+//==============================================================================
+bool Closure::CanMergeScope(Closure *child)
+{
+    ThrowIfNull(child);
+    ThrowIfTrue(m_closureVariable);
+    ThrowIfFalse(child->m_containingProc == m_containingProc);
+
+    HashSetIterator<Variable*,NorlsAllocWrapper> childIt(&child->m_liftSet);
+    while ( childIt.MoveNext() )
+    {
+        Variable *childVar = childIt.Current();
+        if ( 0 != (CL_Catch & m_root->GetVariableFlags(childVar)) )
+        {
+            return false;
+        }
+
+        HashSetIterator<Variable*,NorlsAllocWrapper> it(&m_liftSet);
+        while ( it.MoveNext() )
+        {
+            if ( StringPool::IsEqual(it.Current()->GetName(), childVar->GetName()) )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+// Take ownership of the variables lifted by the passed in closure.  The child
+// closure is discarded by the caller.
+//==============================================================================
+void Closure::MergeScope(Closure *child)
+{
+    ThrowIfNull(child);
+    ThrowIfTrue(child->m_closureVariable);
+
+    HashSetIterator<Variable*,NorlsAllocWrapper> it(&child->m_liftSet);
+    while ( it.MoveNext() )
+    {
+        Variable *var = it.Current();
+        m_root->AddVariableFlag(var, CL_MergedScope);
+        EnsureVariableLifted(var);
+    }
+
+    child->m_liftSet.Clear();
+}
+
 //==============================================================================
 // Ensures that a variable is lifted into the closure and returns a reference
 // to it.  Doesn't do any smarts with Me().
@@ -4478,7 +4670,9 @@ bool Closure::OwnsVariable(Variable *var)
 {
     ThrowIfNull(var);
 
-    return (m_block->Locals == var->GetImmediateParent() || var->IsTemporary() )
+    return (m_block->Locals == var->GetImmediateParent() ||
+            var->IsTemporary() ||
+            0 != (CL_MergedScope & m_root->GetVariableFlags(var)))
         && m_liftSet.Contains(var);
 }
 
@@ -5538,13 +5732,14 @@ void OptimizedClosure::FixupLambdaReference(LambdaData *data)
     // We need to build up the GenericTypeBinding based on where the lambda
     // is being used from
     GenericBinding *binding = NULL;
+    GenericTypeBinding *typeBinding = NULL;
     if ( tracked->GetReferencingProcedure() == containingProc )
     {
         // Called from within the original containing method
 
         // #1 Build up the binding information if nec----ary.  Default to the typeBinding
         // if the method itself is not Generic
-        GenericTypeBinding *typeBinding = IsGenericOrHasGenericParent(containingClass)
+        typeBinding = IsGenericOrHasGenericParent(containingClass)
                     ? CreateSimpleTypeBinding(containingClass)
                     : NULL;
         binding = typeBinding;
@@ -5608,10 +5803,93 @@ void OptimizedClosure::FixupLambdaReference(LambdaData *data)
     // can be a generic delegate bound to some of our paramaters.  The
     // binding depends on our location
     BCSYM *resultType = m_root->GetEquivalentType(expr->ResultType, tracked->GetReferencingProcedure());
-    *ppExpr = GetSemantics()->ConvertWithErrorChecking(
+    ILTree::Expression *delegateCreation = GetSemantics()->ConvertWithErrorChecking(
         addr,
         resultType,
         ExprForceRValue);
+
+    // A Shared lambda referenced from the containing method creates the same
+    // delegate every time it is evaluated, so only create it once.  Lambdas which
+    // are generic over the method's type parameters would need a cache per
+    // instantiation and are left alone.
+    if ( !m_root->m_genEncCode &&
+        !m_lambdaData->UsesMe() &&
+        tracked->GetReferencingProcedure() == containingProc &&
+        lambdaProc->GetGenericParamCount() == 0 &&
+        TypeHelpers::IsDelegateType(resultType) &&
+        !IsBad(delegateCreation) )
+    {
+        delegateCreation = CreateCachedDelegate(delegateCreation, resultType, typeBinding);
+    }
+
+    *ppExpr = delegateCreation;
+}
+
+//==============================================================================
+// Store the delegate of the lambda in a Shared field on the containing class
+// and rewrite its creation into
+//
+//   IIf(cache IsNot Nothing, cache, (cache = New Delegate(AddressOf Lambda), cache))
+//
+// Racing threads may each create a delegate but they are all equivalent.
+//==============================================================================
+ILTree::Expression *OptimizedClosure::CreateCachedDelegate(
+    ILTree::Expression *delegateCreation,
+    BCSYM *delegateType,
+    GenericTypeBinding *typeBinding)
+{
+    ThrowIfNull(delegateCreation);
+    ThrowIfNull(delegateType);
+
+    Semantics *semantics = GetSemantics();
+    Symbols *transientSymbols = GetTransientSymbolFactory();
+    Procedure *lambdaProc = m_lambdaData->GetProcedure();
+    Location loc = delegateCreation->Loc;
+
+    STRING *cacheName = ClosureNameMangler::EncodeCachedLambdaName(GetCompiler(), lambdaProc);
+    Variable *cacheField = transientSymbols->AllocVariable(false, false);
+    transientSymbols->GetVariable(
+        NULL, // No location
+        cacheName,
+        cacheName,
+        DECLF_Private | DECLF_Shared,
+        VAR_Member,
+        delegateType,
+        NULL,
+        NULL,
+        cacheField);
+
+    // Keep the field next to the lambda so they end up in the same physical class
+    Symbols::SetParent(cacheField, lambdaProc->GetPhysicalContainer()->GetUnBindableChildrenHash());
+    semantics->RegisterTransientSymbol(cacheField);
+
+    ILTree::Expression *condition = semantics->AllocateExpression(
+        SX_ISNOT,
+        semantics->GetFXSymbolProvider()->GetBooleanType(),
+        semantics->AllocateSymbolReference(cacheField, delegateType, NULL, loc, typeBinding),
+        semantics->AllocateExpression(SX_NOTHING, delegateType, loc),
+        loc);
+
+    ILTree::Expression *assignment = semantics->AllocateExpression(
+        SX_ASG,
+        TypeHelpers::GetVoidType(),
+        semantics->AllocateSymbolReference(cacheField, delegateType, NULL, loc, typeBinding),
+        delegateCreation,
+        loc);
+
+    ILTree::Expression *store = semantics->AllocateExpression(
+        SX_SEQ_OP2,
+        delegateType,
+        assignment,
+        semantics->AllocateSymbolReference(cacheField, delegateType, NULL, loc, typeBinding),
+        loc);
+
+    return semantics->AllocateIIfExpression(
+        delegateType,
+        condition,
+        semantics->AllocateSymbolReference(cacheField, delegateType, NULL, loc, typeBinding),
+        store,
+        loc);
 }
 
 //==============================================================================
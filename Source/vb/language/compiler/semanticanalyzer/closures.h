@@ -201,6 +201,7 @@ enum VariableFlags
     CL_None = 0,    // No flags
     CL_Catch        = 0x0001,   // Variable is the catch variable
     CL_ClosureVar   = 0x0002,   // Variable is a closure variable
+    CL_MergedScope  = 0x0004,   // Variable was lifted from a scope merged into an enclosing closure
 };
 
 
@@ -226,6 +227,7 @@ public:
     static STRING *DecodeStateMachineProcedureName(BCSYM_NamedRoot*, Compiler*);
     static STRING *EncodeGenericParameterName(Compiler*, GenericParameter*);
     static STRING *EncodeMyBaseMyClassStubName(Compiler*, BCSYM_Proc*,unsigned);
+    static STRING *EncodeCachedLambdaName(Compiler*, BCSYM_Proc*);
     static bool DecodeClosureClassLocation(const WCHAR*, unsigned*);
     static bool DecodeLambdaLocation(const WCHAR*,unsigned*);
     static bool DecodeStateMachineLocation(const WCHAR*,unsigned*);
@@ -487,6 +489,8 @@ private:
     void FixupEmptyBlocks();
     void FixupEmptyBlock(EmptyBlockData*);
     void FixupShortLivedTemporaries();
+    void MergeClosureScopes();
+    Closure *FindMergeTarget(Closure *);
     void FixupClosureTreeStructure();
     void FixupLambdaReferences();
     void FixupExpressionTrees();
@@ -530,6 +534,7 @@ private:
     ClosureRootState m_state;
     bool m_procContainsGoto;
     bool m_genEncCode;
+    bool m_genOptimalIL;
     unsigned m_lambdaNestLevel;
     Semantics *m_semantics;
     Compiler *m_pCompiler;
@@ -701,6 +706,8 @@ public:
     ClassOrRecordType *GetClosureClass() const { return m_closureClass; }
 
     void EnsureVariableLifted(Variable *);
+    bool CanMergeScope(Closure *);
+    void MergeScope(Closure *);
     void AddLambda(LambdaData *);
     void AddChildClosure(Closure *);
     void CreateClosureClassCode();
@@ -802,6 +809,7 @@ protected:
 
 private:
     GenericBinding *CreateLambdaBinding(ClosureBase *owner);
+    ILTree::Expression *CreateCachedDelegate(ILTree::Expression *, BCSYM *, GenericTypeBinding *);
 
     // Do not auto generate
     OptimizedClosure();
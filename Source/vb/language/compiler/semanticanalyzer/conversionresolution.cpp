@@ -231,12 +231,47 @@ Semantics::ClassifyConversionFromExpression
 };
 
 
+/*=======================================================================================
+IsCacheableConversionType
+
+Conversions are cached by the identity of the two type symbols, so only types that are
+represented by a single symbol for the life of the cache qualify: declared containers
+and generic parameters. Generic bindings and arrays are created per use unless a binding
+cache happens to be in effect, and transient symbols go away with the method body.
+=======================================================================================*/
+bool
+Semantics::IsCacheableConversionType
+(
+    Type *pType
+)
+{
+    if (!pType)
+    {
+        return false;
+    }
+
+    if (pType->IsGenericParam())
+    {
+        return !pType->PGenericParam()->IsTransient();
+    }
+
+    return
+        pType->IsContainer() &&
+        !pType->IsGenericBinding() &&
+        !pType->PContainer()->IsTransient() &&
+        !pType->PContainer()->IsAnonymousType() &&
+        !pType->PContainer()->IsAnonymousDelegate();
+}
+
 /*=======================================================================================
 ClassifyConversion
 
 This function classifies the nature of the conversion from the source type to the target
 type. If such a conversion requires a user-defined conversion, it will be supplied as an
 out parameter.
+
+Overload resolution classifies the same pairs of types many times, so the result is kept
+in the project's conversion cache when both types are cacheable.
 =======================================================================================*/
 ConversionClass
 Semantics::ClassifyConversion
@@ -253,6 +288,52 @@ Semantics::ClassifyConversion
     bool IgnoreOperatorMethod
 )
 {
+    bool UseCache =
+        m_PermitDeclarationCaching &&
+        m_ConversionCache &&
+        TargetType != SourceType &&
+        IsCacheableConversionType(TargetType) &&
+        IsCacheableConversionType(SourceType);
+
+    unsigned CacheFlags =
+        (considerConversionsOnNullableBool ? ConversionClassificationCache::ConsiderConversionsOnNullableBool : 0) |
+        (IgnoreOperatorMethod ? ConversionClassificationCache::IgnoreOperatorMethod : 0);
+
+    ConversionClassificationCache::Classification Cached;
+
+    if (UseCache &&
+        m_ConversionCache->Find(TargetType, SourceType, CacheFlags, &Cached))
+    {
+        if (Cached.ConsideredOperatorMethods)
+        {
+            OperatorMethod = Cached.OperatorMethod;
+            OperatorMethodGenericContext = NULL;
+        }
+
+        OperatorMethodIsLifted = Cached.OperatorMethodIsLifted;
+
+        if (pConversionRequiresUnliftedAccessToNullableValue)
+        {
+            *pConversionRequiresUnliftedAccessToNullableValue = Cached.RequiresUnliftedAccessToNullableValue;
+        }
+        if (pConversionIsNarrowingDueToAmbiguity)
+        {
+            *pConversionIsNarrowingDueToAmbiguity = Cached.IsNarrowingDueToAmbiguity;
+        }
+        if (pConversionRelaxationLevel)
+        {
+            *pConversionRelaxationLevel = (DelegateRelaxationLevel)Cached.RelaxationLevel;
+        }
+
+        return (ConversionClass)Cached.Conversion;
+    }
+
+    // Classify into locals so that the complete result is available for the cache
+    // regardless of which outputs the caller asked for.
+    bool RequiresUnliftedAccessToNullableValue = false;
+    bool IsNarrowingDueToAmbiguity = false;
+    DelegateRelaxationLevel RelaxationLevel = DelegateRelaxationLevelNone;
+    bool ConsideredOperatorMethods = false;
 
     ConversionClass Result =
         ClassifyPredefinedConversion
@@ -264,9 +345,9 @@ Semantics::ClassifyConversion
             NULL,
             false,
             considerConversionsOnNullableBool,
-            pConversionRequiresUnliftedAccessToNullableValue,
-            pConversionIsNarrowingDueToAmbiguity,
-            pConversionRelaxationLevel
+            &RequiresUnliftedAccessToNullableValue,
+            &IsNarrowingDueToAmbiguity,
+            &RelaxationLevel
         );
 
     OperatorMethodIsLifted = false;
@@ -283,10 +364,8 @@ Semantics::ClassifyConversion
         !(TypeHelpers::IsIntrinsicType(TypeHelpers::GetElementTypeOfNullable(SourceType, m_CompilerHost)) && 
             TypeHelpers::IsIntrinsicType(TypeHelpers::GetElementTypeOfNullable(TargetType, m_CompilerHost))))
     {
-        if (pConversionRequiresUnliftedAccessToNullableValue)
-        {
-            *pConversionRequiresUnliftedAccessToNullableValue = false;
-        }
+        RequiresUnliftedAccessToNullableValue = false;
+        ConsideredOperatorMethods = true;
 
         Result =
             ClassifyUserDefinedConversion
@@ -297,10 +376,41 @@ Semantics::ClassifyConversion
                 OperatorMethodGenericContext,
                 &OperatorMethodIsLifted,
                 considerConversionsOnNullableBool,
-                pConversionRequiresUnliftedAccessToNullableValue
+                &RequiresUnliftedAccessToNullableValue
             );
     }
 
+    if (pConversionRequiresUnliftedAccessToNullableValue)
+    {
+        *pConversionRequiresUnliftedAccessToNullableValue = RequiresUnliftedAccessToNullableValue;
+    }
+    if (pConversionIsNarrowingDueToAmbiguity)
+    {
+        *pConversionIsNarrowingDueToAmbiguity = IsNarrowingDueToAmbiguity;
+    }
+    if (pConversionRelaxationLevel)
+    {
+        *pConversionRelaxationLevel = RelaxationLevel;
+    }
+
+    // An operator found through the binding of a generic base class, or a lifted
+    // operator that was not allocated with the lookup caches, does not live as
+    // long as the cache does.
+    if (UseCache &&
+        !(ConsideredOperatorMethods && OperatorMethodGenericContext) &&
+        !(ConsideredOperatorMethods && OperatorMethodIsLifted && !m_LiftedOperatorCache))
+    {
+        Cached.OperatorMethod = ConsideredOperatorMethods ? OperatorMethod : NULL;
+        Cached.Conversion = (unsigned char)Result;
+        Cached.RelaxationLevel = (unsigned char)RelaxationLevel;
+        Cached.ConsideredOperatorMethods = ConsideredOperatorMethods;
+        Cached.OperatorMethodIsLifted = OperatorMethodIsLifted;
+        Cached.RequiresUnliftedAccessToNullableValue = RequiresUnliftedAccessToNullableValue;
+        Cached.IsNarrowingDueToAmbiguity = IsNarrowingDueToAmbiguity;
+
+        m_ConversionCache->Insert(TargetType, SourceType, CacheFlags, Cached);
+    }
+
     return Result;
 }
 
@@ -2345,7 +2345,6 @@ Semantics::LookupInNamespace
     _Out_opt_ ImportTrackerEntry *pImportTrackerEntry
 )
 {
-    LookupNode *pLookupResult = NULL;
     LookupKey key;
 
     // This transforms the search lookup from the unnamed namespace of the main type's sourcefile
@@ -2395,19 +2394,22 @@ Semantics::LookupInNamespace
             IgnoreModules, 
             m_Project);
 
-        if (m_LookupCache->Find(&key, &pLookupResult))
+        Declaration *CachedResult;
+        GenericBinding *CachedGenericBindingContext;
+
+        if (m_LookupCache->Find(&key, &CachedResult, &CachedGenericBindingContext))
         {
-            if (pLookupResult->Result)
+            if (CachedResult)
             {
-                LogDependency(pLookupResult->Result);
+                LogDependency(CachedResult);
             }
 
             if (GenericBindingContext)
             {
-                *GenericBindingContext = pLookupResult->GenericBindingContext;
+                *GenericBindingContext = CachedGenericBindingContext;
             }
 
-            return pLookupResult->Result;
+            return CachedResult;
         }
     }
 
@@ -2461,10 +2463,7 @@ Semantics::LookupInNamespace
         !NameIsBad &&
         !TempNameAmbiguousAcrossBaseInterfaces)
     {
-        m_LookupCache->Insert(&key, &pLookupResult);
-
-        pLookupResult->Result = Result;
-        pLookupResult->GenericBindingContext = *GenericBindingContext;
+        m_LookupCache->Insert(&key, Result, *GenericBindingContext);
     }
 
     return Result;
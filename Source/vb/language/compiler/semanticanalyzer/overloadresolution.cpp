@@ -1110,13 +1110,29 @@ Semantics::CollectOverloadCandidates
     RejectedForTypeArgumentCount = 0;
     RejectedForArgumentCount = 0;
 
+    unsigned ArgumentCountToUseForComparison = (OvrldFlags & OvrldSomeCandidatesAreExtensionMethods) ? ArgumentCount  - 1: ArgumentCount;
+
     do
     {
         GenericBinding *CandidateGenericBinding = NULL;
+        OverloadGroupIndex *GroupIndex =
+            GetOverloadGroupIndex(OverloadedProcedure, ArgumentCountToUseForComparison, TypeArgumentCount);
+        unsigned EntryIndex = 0;
+
+        // Members that cannot take this many arguments or type arguments only add to
+        // RejectedForArgumentCount or RejectedForTypeArgumentCount. Callers only test whether
+        // the counts are zero, so once both are known to be non-zero the index lets the walk
+        // stop after the members that can take the counts.
 
-        for (Declaration *NextProcedure = OverloadedProcedure;
+        for (Declaration *NextProcedure = NextOverloadCandidate(GroupIndex, OverloadedProcedure, NULL, EntryIndex, false);
              NextProcedure;
-             NextProcedure = NextProcedure->GetNextOverload())
+             NextProcedure =
+                NextOverloadCandidate(
+                    GroupIndex,
+                    OverloadedProcedure,
+                    NextProcedure,
+                    EntryIndex,
+                    RejectedForArgumentCount > 0 && (TypeArgumentCount == 0 || RejectedForTypeArgumentCount > 0)))
         {
             // Amazingly, non-procedures can land here if a class defines both fields
             // and methods with the same name. (This is impossible in VB, but apparently
@@ -1193,9 +1209,20 @@ Semantics::CollectOverloadCandidates
             unsigned MaximumParameterCount = 0;
             bool HasParamArray = false;
 
-            NonAliasProcedure->GetAllParameterCounts(RequiredParameterCount, MaximumParameterCount, HasParamArray);
+            if (GroupIndex)
+            {
+                const OverloadGroupIndex::Entry &Member = GroupIndex->Entries[EntryIndex - 1];
 
-            unsigned ArgumentCountToUseForComparison = (OvrldFlags & OvrldSomeCandidatesAreExtensionMethods) ? ArgumentCount  - 1: ArgumentCount;
+                VSASSERT(Member.Member == NextProcedure, "Overload group index out of step with its members.");
+
+                RequiredParameterCount = Member.RequiredParameterCount;
+                MaximumParameterCount = Member.MaximumParameterCount;
+                HasParamArray = Member.HasParamArray;
+            }
+            else
+            {
+                NonAliasProcedure->GetAllParameterCounts(RequiredParameterCount, MaximumParameterCount, HasParamArray);
+            }
 
             if (ArgumentCountToUseForComparison < RequiredParameterCount ||
                 (ArgumentCountToUseForComparison > MaximumParameterCount && !HasParamArray))
@@ -1324,6 +1351,122 @@ Semantics::CollectOverloadCandidates
     return Candidates;
 }
 
+OverloadGroupIndex *
+Semantics::GetOverloadGroupIndex
+(
+    Declaration *OverloadedProcedure,
+    unsigned ArgumentCount,
+    unsigned TypeArgumentCount
+)
+{
+    // Like other declaration caches, the index is only kept by real compilation.
+    // Members of transient containers do not live as long as the cache.
+    if (!m_PermitDeclarationCaching ||
+        !m_OverloadGroupCache ||
+        OverloadedProcedure->IsTransient() ||
+        (OverloadedProcedure->GetContainer() && OverloadedProcedure->GetContainer()->IsTransient()))
+    {
+        return NULL;
+    }
+
+    OverloadGroupIndex *GroupIndex = m_OverloadGroupCache->Find(OverloadedProcedure, ArgumentCount, TypeArgumentCount);
+
+    if (GroupIndex)
+    {
+        return GroupIndex;
+    }
+
+    unsigned EntryCount = 0;
+
+    for (Declaration *Member = OverloadedProcedure; Member; Member = Member->GetNextOverload())
+    {
+        if (IsProcedure(Member))
+        {
+            EntryCount++;
+        }
+    }
+
+    GroupIndex =
+        (OverloadGroupIndex *)m_OverloadGroupCache->GetNorlsAllocator()->Alloc(
+            VBMath::Add(
+                sizeof(OverloadGroupIndex),
+                VBMath::Multiply(sizeof(OverloadGroupIndex::Entry), EntryCount ? EntryCount - 1 : 0)));
+
+    GroupIndex->EntryCount = EntryCount;
+    GroupIndex->ApplicableEntryCount = 0;
+
+    // The members that can take the counts are placed from the front and the
+    // others from the back, then the back part is put back in declaration order.
+
+    unsigned InapplicableEntryIndex = EntryCount;
+
+    for (Declaration *Member = OverloadedProcedure; Member; Member = Member->GetNextOverload())
+    {
+        if (!IsProcedure(Member))
+        {
+            continue;
+        }
+
+        unsigned RequiredParameterCount = 0;
+        unsigned MaximumParameterCount = 0;
+        bool HasParamArray = false;
+
+        ViewAsProcedure(Member)->GetAllParameterCounts(RequiredParameterCount, MaximumParameterCount, HasParamArray);
+
+        bool IsApplicable =
+            (TypeArgumentCount == 0 || TypeArgumentCount == Member->GetGenericParamCount()) &&
+            ArgumentCount >= RequiredParameterCount &&
+            (ArgumentCount <= MaximumParameterCount || HasParamArray);
+
+        OverloadGroupIndex::Entry &IndexEntry =
+            GroupIndex->Entries[IsApplicable ? GroupIndex->ApplicableEntryCount++ : --InapplicableEntryIndex];
+
+        IndexEntry.Member = Member;
+        IndexEntry.RequiredParameterCount = RequiredParameterCount;
+        IndexEntry.MaximumParameterCount = MaximumParameterCount;
+        IndexEntry.HasParamArray = HasParamArray;
+    }
+
+    VSASSERT(InapplicableEntryIndex == GroupIndex->ApplicableEntryCount, "Overload group index entries miscounted.");
+
+    for (unsigned Low = InapplicableEntryIndex, High = EntryCount; Low + 1 < High; Low++, High--)
+    {
+        OverloadGroupIndex::Entry Swap = GroupIndex->Entries[Low];
+        GroupIndex->Entries[Low] = GroupIndex->Entries[High - 1];
+        GroupIndex->Entries[High - 1] = Swap;
+    }
+
+    return m_OverloadGroupCache->Insert(OverloadedProcedure, ArgumentCount, TypeArgumentCount, GroupIndex);
+}
+
+Declaration *
+Semantics::NextOverloadCandidate
+(
+    OverloadGroupIndex *GroupIndex,
+    Declaration *OverloadedProcedure,
+    Declaration *Current,
+    _Inout_ unsigned &EntryIndex,
+    bool SkipInapplicableMembers
+)
+{
+    if (!GroupIndex)
+    {
+        return Current ? Current->GetNextOverload() : OverloadedProcedure;
+    }
+
+    unsigned EntryLimit =
+        SkipInapplicableMembers ?
+            GroupIndex->ApplicableEntryCount :
+            GroupIndex->EntryCount;
+
+    if (EntryIndex < EntryLimit)
+    {
+        return GroupIndex->Entries[EntryIndex++].Member;
+    }
+
+    return NULL;
+}
+
 Declaration *
 Semantics::VerifyLateboundCallConditions
 (
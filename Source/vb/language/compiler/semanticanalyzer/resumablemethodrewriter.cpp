@@ -468,6 +468,128 @@ public:
 #endif
 
 
+// =============================================================================
+// FindSuspendingBlocks
+// Before rewriting, we walk the original body to find which blocks contain an
+// Await or a Yield (directly or in a nested block). A local declared in a block
+// that never suspends, and that isn't re-entered by an enclosing loop which does,
+// can't be live across a resumption, so it stays a local of MoveNext rather than
+// being hoisted into a field of the state machine. GoTo can re-enter a block
+// without a loop, so its presence anywhere disables the analysis.
+//
+class FindSuspendingBlocks : public BoundTreeVisitor
+{
+
+public:
+    FindSuspendingBlocks(NorlsAllocator& allocator) :
+        m_blockStack(NorlsAllocWrapper(&allocator)),
+        m_scopeBlocks(&allocator),
+        m_containsGoto(false)
+    {
+    }
+
+    bool ContainsGoto()
+    {
+        return m_containsGoto;
+    }
+
+    // Returns the block whose locals are "pScope", or NULL if it isn't a nested block of the body
+    ILTree::ExecutableBlock* GetBlockOfScope(_In_opt_ BCSYM_Hash *pScope)
+    {
+        return pScope == NULL ? NULL : m_scopeBlocks.GetValueOrDefault(pScope, NULL);
+    }
+
+    bool IsSuspending(_In_ ILTree::ExecutableBlock *pBlock)
+    {
+        return m_suspendingBlocks.Contains(pBlock);
+    }
+
+protected:
+
+    virtual bool StartBlock(ILTree::ExecutableBlock* pBlock)
+    {
+        if (pBlock->bilop != SB_PROC && pBlock->Locals != NULL)
+        {
+            m_scopeBlocks.SetValue(pBlock->Locals, pBlock);
+        }
+
+        m_blockStack.PushOrEnqueue(pBlock);
+        return true;
+    }
+
+    virtual void EndBlock(ILTree::ExecutableBlock* pBlock)
+    {
+        ILTree::ExecutableBlock* pPoppedBlock = m_blockStack.PopOrDequeue();
+        VSASSERT(pPoppedBlock == pBlock, "Uh oh, our stack and our visitor don't agree on the current block!");
+    }
+
+    virtual bool StartStatement(ILTree::Statement* pStatement)
+    {
+        if (IsBad(pStatement))
+        {
+            return false;
+        }
+
+        switch (pStatement->bilop)
+        {
+            case SL_YIELD:
+                MarkAncestors();
+                break;
+
+            case SL_GOTO:
+            case SL_ON_ERR:
+            case SL_RESUME:
+                m_containsGoto = true;
+                break;
+        }
+
+        return true;
+    }
+
+    virtual bool StartExpression(ILTree::Expression** ppExpression)
+    {
+        if (IsBad(*ppExpression))
+        {
+            return false;
+        }
+
+        if ((*ppExpression)->bilop == SX_AWAIT)
+        {
+            MarkAncestors();
+        }
+
+        return true;
+    }
+
+private:
+    FindSuspendingBlocks(const FindSuspendingBlocks&); // No copying
+    FindSuspendingBlocks& operator=(const FindSuspendingBlocks&); // No copying
+
+    void MarkAncestors()
+    {
+        for (ArrayListReverseIterator<ILTree::ExecutableBlock*, NorlsAllocWrapper> it = m_blockStack.GetIterator();
+             it.MoveNext(); )
+        {
+            m_suspendingBlocks.Add(it.Current());
+        }
+    }
+
+    Filo<ILTree::ExecutableBlock*, NorlsAllocWrapper> m_blockStack;
+    DynamicHashTable<BCSYM_Hash*, ILTree::ExecutableBlock*, NorlsAllocWrapper> m_scopeBlocks;
+    HashSet<ILTree::ExecutableBlock*> m_suspendingBlocks;
+    bool m_containsGoto;
+};
+
+
+// A long-lived temporary that was hoisted into a field, and the block it belongs to.
+// Temporaries of the same type share a field when their blocks are disjoint.
+struct SharedTemporaryField
+{
+    BCSYM_Variable *Field;
+    ILTree::ExecutableBlock *Block;
+};
+
+
 struct LabelTarget : CSingleLink<LabelTarget>
 {
     int state;
@@ -605,6 +727,12 @@ private:
     //
     TemporaryAccounting m_TemporaryAccounting;  // If there are any temporaries we've failed to account for, it's probably an error
     HashSet<BCSYM_Variable*> m_TemporaryVars; // TemporaryManage can't reuse LongLived temporaries, so we manage reusing them here.
+    //
+    FindSuspendingBlocks m_SuspendingBlocks;  // Which blocks of the original body contain an Await or Yield
+    bool m_HoistOnlyLiveLocals;               // If set, locals that can't be live across a resumption stay in MoveNext, and temporaries share fields
+    DynamicArray<SharedTemporaryField> m_SharedTemporaryFields; // The fields that long-lived temporaries were hoisted into
+    bool IsLocalToOneResumption(_In_ Variable *originalVariable);
+    BCSYM_Variable* FindSharedTemporaryField(_In_ ILTree::ExecutableBlock *block, Type *type);
     bool m_RewritingOpImplicit;
 };
 
@@ -617,7 +745,8 @@ ResumableMethodLowerer::ResumableMethodLowerer(Semantics *semantics, _In_ ILTree
     m_AwaiterFields(semantics->m_TransientSymbolCreator.GetNorlsAllocator()),
     m_LocalFieldMap(semantics->m_TransientSymbolCreator.GetNorlsAllocator()),
     m_GenericParamMap(semantics->m_TransientSymbolCreator.GetNorlsAllocator()),
-    m_TryHandlers(semantics->m_TransientSymbolCreator.GetNorlsAllocator())
+    m_TryHandlers(semantics->m_TransientSymbolCreator.GetNorlsAllocator()),
+    m_SuspendingBlocks(*semantics->m_TransientSymbolCreator.GetNorlsAllocator())
 {
     ThrowIfNull(semantics);
     ThrowIfNull(originalBlock);
@@ -662,6 +791,7 @@ ResumableMethodLowerer::ResumableMethodLowerer(Semantics *semantics, _In_ ILTree
     m_iStateMachineFinished = FINISHED_STATE_SENTINEL;
     m_CurrentScopeTargets = NULL;
     m_RewritingOpImplicit = false;
+    m_HoistOnlyLiveLocals = false;
 
     // Location...
     if (m_MainProc->HasLocation())
@@ -1864,6 +1994,17 @@ void ResumableMethodLowerer::AddMoveNextMethodToStateMachineClass()
 
 
 
+    // Find out which locals might be live across an Await/Yield. Only those need hoisting.
+    // ENC and debug builds keep hoisting everything, so the debugger sees every local as a field.
+    if (m_Semantics->m_SourceFile != NULL &&
+        m_Semantics->m_SourceFile->GetProject() != NULL &&
+        m_Semantics->m_SourceFile->GetProject()->GenerateOptimalIL() &&
+        !m_Semantics->m_SourceFile->GetProject()->GenerateENCableCode())
+    {
+        m_SuspendingBlocks.Visit(m_OriginalBlock);
+        m_HoistOnlyLiveLocals = !m_SuspendingBlocks.ContainsGoto();
+    }
+
     // ====================================================================
     // REWRITE THE ORIGINAL FUNCTION BODY INTO A MOVENEXT BODY
     //
@@ -2416,9 +2557,35 @@ Variable* ResumableMethodLowerer::RewriteVariable(_In_ Variable* originalVariabl
     {
         VSASSERT(newVariable != NULL, "Error: lifted a non-null Me variable into an already-mapped null");
         return newVariable;
-    
+
     }
-    
+
+    // A local that can't be live across an Await/Yield is left as a local of MoveNext, in the
+    // same block it was declared in (like the Catch and Finally locals above).
+    if (IsLocalToOneResumption(originalVariable))
+    {
+        return originalVariable;
+    }
+
+    Type *newType = RewriteType(originalVariable->GetType());
+
+    // Long-lived temporaries of disjoint blocks (e.g. the enumerators of two sibling For Each loops)
+    // are never live at the same time, so they can share a field.
+    Temporary *temp = originalVariable->IsTemporary() ? originalVariable->GetTemporaryInfo() : NULL;
+    bool shareField = m_HoistOnlyLiveLocals && temp != NULL && temp->Lifetime == LifetimeLongLived && temp->Block != NULL;
+    if (shareField)
+    {
+        newVariable = FindSharedTemporaryField(temp->Block, newType);
+        if (newVariable != NULL)
+        {
+            SharedTemporaryField shared = { newVariable, temp->Block };
+            m_SharedTemporaryFields.AddElement(shared);
+            originalVariable->SetRewrittenName(newVariable->GetName());
+            m_LocalFieldMap.SetValue(originalVariable, newVariable);
+            return newVariable;
+        }
+    }
+
     STRING *encodedName = ClosureNameMangler::EncodeResumableVariableName(m_Compiler,originalVariable->GetName());
     STRING *newName = NULL;
     for (int suffix=1; ; suffix++)
@@ -2431,10 +2598,15 @@ Variable* ResumableMethodLowerer::RewriteVariable(_In_ Variable* originalVariabl
             break;       
         }
     }
-    Type *newType = RewriteType(originalVariable->GetType());
     newVariable = AddFieldToStateMachineClass(newName, newType);
     m_LocalFieldMap.SetValue(originalVariable, newVariable);
 
+    if (shareField)
+    {
+        SharedTemporaryField shared = { newVariable, temp->Block };
+        m_SharedTemporaryFields.AddElement(shared);
+    }
+
     VSASSERT(newVariable != NULL, "Error: lifted a non-null Me variable into a newly-created null");
 
     // Note: if this variable has a restricted type (ArgIterator &c.) then we'd end up producing
@@ -2451,6 +2623,90 @@ Variable* ResumableMethodLowerer::RewriteVariable(_In_ Variable* originalVariabl
 }
 
 
+bool ResumableMethodLowerer::IsLocalToOneResumption(_In_ Variable *originalVariable)
+{
+    // Temporaries are always hoisted: MoveNext has its own TemporaryManager, which doesn't know about them.
+    if (!m_HoistOnlyLiveLocals || originalVariable->IsTemporary() || !originalVariable->IsLocal())
+    {
+        return false;
+    }
+
+    // The local keeps its original symbol, so its type mustn't mention the generic parameters of the
+    // resumable method: inside the state machine those have become SM$T.
+    Type *type = originalVariable->GetType();
+    if (type == NULL || type->IsBad() || RefersToGenericParameter(type, m_MainProc))
+    {
+        return false;
+    }
+
+    // Locals of the procedure block itself aren't in any block of MoveNext, so they must be hoisted.
+    ILTree::ExecutableBlock *block = NULL;
+    if (originalVariable->GetImmediateParent() != NULL && originalVariable->GetImmediateParent()->IsHash())
+    {
+        block = m_SuspendingBlocks.GetBlockOfScope(originalVariable->GetImmediateParent()->PHash());
+    }
+
+    if (block == NULL || m_SuspendingBlocks.IsSuspending(block))
+    {
+        return false;
+    }
+
+    // VB locals keep their value when a loop re-enters their block. If the loop suspends
+    // somewhere, that value has to survive the resumption.
+    for (ILTree::ExecutableBlock *outer = block->Parent; outer != NULL; outer = outer->Parent)
+    {
+        if ((outer->bilop == SB_FOR || outer->bilop == SB_FOR_EACH || outer->bilop == SB_LOOP) &&
+            m_SuspendingBlocks.IsSuspending(outer))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+BCSYM_Variable* ResumableMethodLowerer::FindSharedTemporaryField(_In_ ILTree::ExecutableBlock *block, Type *type)
+{
+    for (unsigned i = 0; i < m_SharedTemporaryFields.Count(); i++)
+    {
+        BCSYM_Variable *candidate = m_SharedTemporaryFields.Element(i).Field;
+        if (!BCSYM::AreTypesEqual(candidate->GetType(), type))
+        {
+            continue;
+        }
+
+        // The field is available only if every block already using it is disjoint from this one,
+        // i.e. neither contains the other.
+        bool available = true;
+        for (unsigned j = 0; j < m_SharedTemporaryFields.Count() && available; j++)
+        {
+            if (m_SharedTemporaryFields.Element(j).Field != candidate)
+            {
+                continue;
+            }
+
+            ILTree::ExecutableBlock *used = m_SharedTemporaryFields.Element(j).Block;
+            for (ILTree::ExecutableBlock *outer = block; outer != NULL && available; outer = outer->Parent)
+            {
+                available = (outer != used);
+            }
+            for (ILTree::ExecutableBlock *outer = used; outer != NULL && available; outer = outer->Parent)
+            {
+                available = (outer != block);
+            }
+        }
+
+        if (available)
+        {
+            return candidate;
+        }
+    }
+
+    return NULL;
+}
+
+
 
 ILTree::Expression* ResumableMethodLowerer::RewriteAwaitExpression(_In_ ILTree::AwaitExpression *await)
 {
@@ -2838,6 +2838,16 @@ Semantics::InitializeInterpretationState
             {
                 m_LiftedOperatorCache = m_Project->GetLiftedOperatorCache();
             }
+
+            if (!m_ConversionCache)
+            {
+                m_ConversionCache = m_Project->GetConversionCache();
+            }
+
+            if (!m_OverloadGroupCache)
+            {
+                m_OverloadGroupCache = m_Project->GetOverloadGroupCache();
+            }
         }
 
         if (GetCompilerHost() && !m_MergedNamespaceCache)
@@ -3602,6 +3612,8 @@ Semantics::Semantics
     m_statementGroupId(1),
     m_ExtensionMethodLookupCache(NULL),
     m_LiftedOperatorCache(NULL),
+    m_ConversionCache(NULL),
+    m_OverloadGroupCache(NULL),
     m_InterpretingMethodBody(false),
     m_XmlNameVars(NULL),
     m_AnonymousTypeBindingTable(NULL),
@@ -3663,6 +3675,8 @@ Semantics::Semantics
             m_LookupCache = m_SourceFile->GetProject()->GetLookupCache();
             m_ExtensionMethodLookupCache = m_SourceFile->GetProject()->GetExtensionMethodLookupCache();
             m_LiftedOperatorCache = m_SourceFile->GetProject()->GetLiftedOperatorCache();
+            m_ConversionCache = m_SourceFile->GetProject()->GetConversionCache();
+            m_OverloadGroupCache = m_SourceFile->GetProject()->GetOverloadGroupCache();
         }
 
         if (GetCompilerHost())
@@ -4209,6 +4209,18 @@ protected:
         _Out_ ILTree::SelectBlock *Select
     );
 
+    bool
+    RecommendStringHashTable
+    (
+        _Out_ ILTree::SelectBlock *Select
+    );
+
+    bool
+    RecommendSparseSwitchTable
+    (
+        _Out_ ILTree::SelectBlock *Select
+    );
+
     void
     OptimizeSelectStatement
     (
@@ -6862,6 +6874,29 @@ protected:
         _Inout_opt_ AsyncSubAmbiguityFlagCollection **ppAsyncSubArgumentListAmbiguity
     );
 
+    // Gets the cached index of the method group that starts with the given
+    // overload for the given counts, building it if necessary. Returns NULL
+    // if the group cannot be cached.
+    OverloadGroupIndex *
+    GetOverloadGroupIndex
+    (
+        Declaration *OverloadedProcedure,
+        unsigned ArgumentCount,
+        unsigned TypeArgumentCount
+    );
+
+    // Steps to the next member of a method group, through its index if it
+    // has one. Current is NULL to get the first member.
+    Declaration *
+    NextOverloadCandidate
+    (
+        OverloadGroupIndex *GroupIndex,
+        Declaration *OverloadedProcedure,
+        Declaration *Current,
+        _Inout_ unsigned &EntryIndex,
+        bool SkipInapplicableMembers
+    );
+
     bool
     VerifyParameterCounts
     (
@@ -8447,6 +8482,13 @@ protected:
         bool IgnoreOperatorMethod = false
     );
     
+    // Can conversions involving the type be kept in the conversion cache?
+    static bool
+    IsCacheableConversionType
+    (
+        Type *pType
+    );
+    
     ConversionClass
     ClassifyPredefinedCLRConversion
     (
@@ -10783,9 +10825,11 @@ protected:
     // A mechanism to build the call graph for the given method.
     CallGraph *m_CallGraph;
 
-    LookupTree *m_LookupCache;
+    LookupCache *m_LookupCache;
     ExtensionMethodNameLookupCache * m_ExtensionMethodLookupCache;
     LiftedUserDefinedOperatorCache * m_LiftedOperatorCache;
+    ConversionClassificationCache * m_ConversionCache;
+    OverloadGroupIndexCache * m_OverloadGroupCache;
     NamespaceRingTree *m_MergedNamespaceCache;
     bool m_DoNotMergeNamespaceCaches;
     CompilationCaches *m_CompilationCaches;
@@ -3111,6 +3111,16 @@ Semantics::InterpretSelectStatement
         //
         SetFlag32(Result, SBF_SELECT_TABLE);
     }
+    else if (TypeHelpers::IsStringType(Selector->ResultType) &&
+             !(m_SourceFileOptions & OPTION_OptionText))
+    {
+        // Likewise assume all Case statements are simple string constants, in which case the
+        // Select can dispatch on a hash of the selector. Text comparisons are culture aware, so
+        // two strings that compare equal need not hash alike and Option Compare Text always
+        // uses the list of comparisons.
+        //
+        SetFlag32(Result, SBF_SELECT_HASH);
+    }
 
     Result->SelectorCapture = CaptureInLongLivedTemporary(Selector, Result->SelectorTemporary, Result);
 }
@@ -3241,11 +3251,37 @@ Semantics::InterpretCaseStatement
             ClearFlag32(EnclosingSelect, SBF_SELECT_TABLE);
         }
 
+        if (BoundCaseElement->LowBound->bilop != SX_CNS_STR ||
+            BoundCaseElement->IsRange ||
+            BoundCaseElement->RelationalOpcode != SX_EQ)
+        {
+            ClearFlag32(EnclosingSelect, SBF_SELECT_HASH);
+        }
+
         *BoundCaseListTarget = BoundCaseElement;
         BoundCaseListTarget = &BoundCaseElement->Next;
     }
 }
 
+static bool
+IsSwitchTableWorthwhile
+(
+    unsigned __int64 CountOfEntries,
+    unsigned IfBlockCount,
+    unsigned IfRangeBlockCount
+)
+{
+    unsigned const IF_BLOCK_SIZE = 15;   // ld+param, ld+param, br+addr
+    unsigned const IF_RANGE_BLOCK_SIZE = 30;   // 2 * if block size
+    unsigned const SWITCH_HEADER_SIZE = 29;   // ld+param, ld+param, sub, switch+ui4
+    unsigned const SWITCH_ELEMENT_SIZE = 4;    // addr
+
+    return
+        SWITCH_HEADER_SIZE + SWITCH_ELEMENT_SIZE * CountOfEntries <=
+            2 * (IF_BLOCK_SIZE * IfBlockCount + IF_RANGE_BLOCK_SIZE * IfRangeBlockCount) &&
+        CountOfEntries <= INT_MAX;
+}
+
 bool
 Semantics::RecommendSwitchTable
 (
@@ -3377,11 +3413,6 @@ Semantics::RecommendSwitchTable
     // 
 
 
-    unsigned const IF_BLOCK_SIZE = 15;   // ld+param, ld+param, br+addr
-    unsigned const IF_RANGE_BLOCK_SIZE = 30;   // 2 * if block size
-    unsigned const SWITCH_HEADER_SIZE = 29;   // ld+param, ld+param, sub, switch+ui4
-    unsigned const SWITCH_ELEMENT_SIZE = 4;    // addr
-
     VSASSERT((IsUnsigned && (unsigned __int64)Maximum >= (unsigned __int64)Minimum) ||
              (!IsUnsigned && Maximum >= Minimum),
              "PreprocessSelect: Max and Min invalid");
@@ -3393,16 +3424,18 @@ Semantics::RecommendSwitchTable
     if (CountOfEntries == 0)
     {
         ClearFlag32(Select, SBF_SELECT_TABLE);
+        SetFlag32(Select, SBF_SELECT_SPARSE);
         return false;
     }
 
     // if size of switch table is over twice as large as if list, or the switch table
     // would be too large to index into, use an if list
-    if ( (SWITCH_HEADER_SIZE + SWITCH_ELEMENT_SIZE * CountOfEntries >
-         2 * (IF_BLOCK_SIZE * IfBlockCount + IF_RANGE_BLOCK_SIZE * IfRangeBlockCount)) ||
-         (CountOfEntries > INT_MAX))
+    if (!IsSwitchTableWorthwhile(CountOfEntries, IfBlockCount, IfRangeBlockCount))
     {
+        // The values are too spread out for a single table, but may still
+        // fall into a few dense clusters.
         ClearFlag32(Select, SBF_SELECT_TABLE);
+        SetFlag32(Select, SBF_SELECT_SPARSE);
         return false;
     }
 
@@ -3413,8 +3446,228 @@ Semantics::RecommendSwitchTable
     return true;
 }
 
+bool
+Semantics::RecommendStringHashTable
+(
+    _Out_ ILTree::SelectBlock *Select
+)
+{
+    if (!HasFlag32(Select, SBF_SELECT_HASH))
+    {
+        return false;
+    }
+
+    unsigned LabelCount = 0;
+    ILTree::Statement *CurrentStatement = Select->Child;
+
+    while (CurrentStatement &&
+           CurrentStatement->bilop == SB_CASE &&
+           !HasFlag32(CurrentStatement, SBF_CASE_ISELSE))
+    {
+        for (ILTree::CASELIST *CurrentCaseClause = CurrentStatement->AsCaseBlock().BoundCaseList;
+             CurrentCaseClause;
+             CurrentCaseClause = CurrentCaseClause->Next)
+        {
+            LabelCount++;
+        }
+
+        CurrentStatement = CurrentStatement->Next;
+    }
+
+    // Hashing the selector costs a pass over its characters, which only pays
+    // for itself once the IF list would need several string comparisons.
+    //
+    unsigned const MINIMUM_HASHED_LABELS = 7;
+
+    if (LabelCount < MINIMUM_HASHED_LABELS)
+    {
+        ClearFlag32(Select, SBF_SELECT_HASH);
+        return false;
+    }
+
+    return true;
+}
+
+static int __cdecl
+CompareSignedCaseRanges
+(
+    const void *Left,
+    const void *Right
+)
+{
+    __int64 LeftLow = ((const ILTree::SelectCaseRange *)Left)->Low;
+    __int64 RightLow = ((const ILTree::SelectCaseRange *)Right)->Low;
+
+    return LeftLow < RightLow ? -1 : (LeftLow > RightLow ? 1 : 0);
+}
+
+static int __cdecl
+CompareUnsignedCaseRanges
+(
+    const void *Left,
+    const void *Right
+)
+{
+    unsigned __int64 LeftLow = ((const ILTree::SelectCaseRange *)Left)->Low;
+    unsigned __int64 RightLow = ((const ILTree::SelectCaseRange *)Right)->Low;
+
+    return LeftLow < RightLow ? -1 : (LeftLow > RightLow ? 1 : 0);
+}
+
+// A Select whose constant cases are too sparse for one SWITCH table is
+// generated as a binary search over clusters of values, each dense cluster
+// getting its own SWITCH table.  This is only possible when no value belongs
+// to more than one Case, so that the order of the cases doesn't matter.
+
+bool
+Semantics::RecommendSparseSwitchTable
+(
+    _Out_ ILTree::SelectBlock *Select
+)
+{
+    if (!HasFlag32(Select, SBF_SELECT_SPARSE))
+    {
+        return false;
+    }
+
+    unsigned RangeCount = 0;
+    ILTree::Statement *CurrentStatement = Select->Child;
+
+    while (CurrentStatement &&
+           CurrentStatement->bilop == SB_CASE &&
+           !HasFlag32(CurrentStatement, SBF_CASE_ISELSE))
+    {
+        for (ILTree::CASELIST *CurrentCaseClause = CurrentStatement->AsCaseBlock().BoundCaseList;
+             CurrentCaseClause;
+             CurrentCaseClause = CurrentCaseClause->Next)
+        {
+            RangeCount++;
+        }
+
+        CurrentStatement = CurrentStatement->Next;
+    }
+
+    // A binary search needs a few values before it beats the IF list.
+    unsigned const MINIMUM_SPARSE_LABELS = 6;
+
+    if (RangeCount < MINIMUM_SPARSE_LABELS)
+    {
+        ClearFlag32(Select, SBF_SELECT_SPARSE);
+        return false;
+    }
+
+    ILTree::SelectCaseRange *Ranges = m_TreeStorage.AllocArray<ILTree::SelectCaseRange>(RangeCount);
+    unsigned RangeIndex = 0;
+    unsigned CaseIndex = 0;
+
+    CurrentStatement = Select->Child;
+
+    while (CurrentStatement &&
+           CurrentStatement->bilop == SB_CASE &&
+           !HasFlag32(CurrentStatement, SBF_CASE_ISELSE))
+    {
+        for (ILTree::CASELIST *CurrentCaseClause = CurrentStatement->AsCaseBlock().BoundCaseList;
+             CurrentCaseClause;
+             CurrentCaseClause = CurrentCaseClause->Next)
+        {
+            ILTree::SelectCaseRange *Range = &Ranges[RangeIndex++];
+
+            Range->Low = CurrentCaseClause->LowBound->AsIntegralConstantExpression().Value;
+            Range->High =
+                CurrentCaseClause->IsRange ?
+                    CurrentCaseClause->HighBound->AsIntegralConstantExpression().Value :
+                    Range->Low;
+            Range->CaseIndex = CaseIndex;
+        }
+
+        CaseIndex++;
+        CurrentStatement = CurrentStatement->Next;
+    }
+
+    bool IsUnsigned = TypeHelpers::IsUnsignedType(GetDataType(Select->SelectorTemporary));
+
+    qsort(
+        Ranges,
+        RangeCount,
+        sizeof(ILTree::SelectCaseRange),
+        IsUnsigned ? CompareUnsignedCaseRanges : CompareSignedCaseRanges);
+
+    for (RangeIndex = 1; RangeIndex < RangeCount; RangeIndex++)
+    {
+        __int64 PreviousHigh = Ranges[RangeIndex - 1].High;
+        __int64 Low = Ranges[RangeIndex].Low;
+
+        if ((IsUnsigned && (unsigned __int64)Low <= (unsigned __int64)PreviousHigh) ||
+            (!IsUnsigned && Low <= PreviousHigh))
+        {
+            ClearFlag32(Select, SBF_SELECT_SPARSE);
+            return false;
+        }
+    }
+
+    // Partition the values into clusters, extending each cluster for as long
+    // as a SWITCH table over it stays worthwhile.  Clusters of one or two values
+    // are split up, comparing against them directly is cheaper.
+    //
+    unsigned const MINIMUM_CLUSTER_SIZE = 3;
+
+    RangeIndex = 0;
+
+    while (RangeIndex < RangeCount)
+    {
+        unsigned ClusterEnd = RangeIndex + 1;
+        unsigned IfBlockCount = Ranges[RangeIndex].Low == Ranges[RangeIndex].High ? 1 : 0;
+        unsigned IfRangeBlockCount = 1 - IfBlockCount;
+
+        while (ClusterEnd < RangeCount)
+        {
+            bool IsRange = Ranges[ClusterEnd].Low != Ranges[ClusterEnd].High;
+
+            // Ranges are disjoint and sorted, so this can only wrap to 0 when
+            // the cluster covers every 64 bit value.
+            unsigned __int64 CountOfEntries =
+                (unsigned __int64)Ranges[ClusterEnd].High - (unsigned __int64)Ranges[RangeIndex].Low + 1;
+
+            if (CountOfEntries == 0 ||
+                !IsSwitchTableWorthwhile(
+                    CountOfEntries,
+                    IfBlockCount + (IsRange ? 0 : 1),
+                    IfRangeBlockCount + (IsRange ? 1 : 0)))
+            {
+                break;
+            }
+
+            if (IsRange)
+            {
+                IfRangeBlockCount++;
+            }
+            else
+            {
+                IfBlockCount++;
+            }
+
+            ClusterEnd++;
+        }
+
+        if (ClusterEnd - RangeIndex < MINIMUM_CLUSTER_SIZE)
+        {
+            ClusterEnd = RangeIndex + 1;
+        }
+
+        Ranges[RangeIndex].StartsCluster = true;
+        RangeIndex = ClusterEnd;
+    }
+
+    Select->CaseRanges = Ranges;
+    Select->CaseRangeCount = RangeCount;
+
+    return true;
+}
+
 // Determine what kind of byte codes to generate for SELECT.
-// There are two choices, use an IF list or a SWITCH table
+// There are four choices, use an IF list, a SWITCH table, a binary search
+// over several SWITCH tables or, for string selectors compared in binary
+// mode, a SWITCH on the hash of the selector.
 // This function determines which method to use
 // The conditions for choosing the SWITCH table are:
 //   switch value must be integer
@@ -3435,7 +3688,9 @@ Semantics::OptimizeSelectStatement
         return;
     }
 
-    if (RecommendSwitchTable(Select))
+    if (RecommendSwitchTable(Select) ||
+        RecommendSparseSwitchTable(Select) ||
+        RecommendStringHashTable(Select))
     {
         return;
     }
@@ -613,6 +613,8 @@ void SourceFile::Invalidate(bool SkipDemoteNodesCheck /* = true */)
         m_pParseTreeService = NULL;
     }
 
+    m_MethodBodyParseCache.Clear();
+
     // If we are currently connected to a SourceFileView, disconnect now because
     // the SourceFile is completely invalid at this point.  Otherwise it's possible
     // for the SourceFileView and hence the managed object model to continue to hold
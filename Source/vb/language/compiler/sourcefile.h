@@ -409,6 +409,11 @@ public:
         return &m_XMLDocFile;
     }
 
+    MethodBodyParseCache *GetMethodBodyParseCache()
+    {
+        return &m_MethodBodyParseCache;
+    }
+
 #if IDE 
     // Sets or Resets the state of the m_fNeedToFireOnStatementsChangedEvents flag.
     void SetNeedToFireOnStatementsChangedEvents(bool state)
@@ -773,6 +778,9 @@ private:
     // Manages XMLDocs for this sourcefile.
     XMLDocFile m_XMLDocFile;
 
+    // Compact trees of the method bodies parsed from this file, by body text hash.
+    MethodBodyParseCache m_MethodBodyParseCache;
+
 #if IDE 
 
     // Array of "extra" tokens we've built while compiling toward CS_TypesEmitted.
@@ -57,6 +57,7 @@ typedef CComCritSecLock<CompilerIdeCriticalSection> CompilerIdeLock;
 #include "..\Compiler\Templates.h"
 #include "..\Compiler\LinkedLists.h"
 #include "..\Compiler\TreeTemplates.h"
+#include "..\Compiler\HashCacheTemplates.h"
 #include "..\Compiler\GraphTemplates.h"
 #include "..\Compiler\StringPoolEntry.h"
 #include "..\Compiler\StringBuffer.h"
@@ -97,6 +98,7 @@ typedef CComCritSecLock<CompilerIdeCriticalSection> CompilerIdeLock;
 #include "..\Compiler\Parser\Parser.h"
 
 #include "..\Compiler\Parser\ParseTreeHelpers.h"
+#include "..\Compiler\Parser\CompactParseTree.h"
 
 #include "..\Compiler\Parser\ParseTreeVisitor.h"
 #include "..\Compiler\Parser\LocationFixupVisitor.h"
@@ -144,6 +146,7 @@ typedef CComCritSecLock<CompilerIdeCriticalSection> CompilerIdeLock;
 #endif  // IDE
 
 #include "..\Compiler\CompilerProject.h"
+#include "..\Compiler\IncrementalBuildCache.h"
 #include "..\Compiler\Symbols\MetaImport.h"
 #include "..\Compiler\TypeName.h"
 #include "..\Compiler\TypeNameBuilder.h"
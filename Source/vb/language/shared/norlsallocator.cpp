@@ -51,6 +51,8 @@ NorlsAllocator::NorlsAllocator(
     m_nSerialNo = g_NrlsAllocTracker->AddAllocator(this);
     m_nSeqNo= 0;
     m_nTotalAllocated = 0;
+    m_nHighWater = 0;
+    m_nTotalRecycled = 0;
     m_dwAllocThreadId = 0;
 #if NRLSTRACK_GETSTACKS    
     m_pLastBlock = NULL;
@@ -78,6 +80,8 @@ NorlsAllocator::NorlsAllocator(
     m_dwCreatedThreadId = GetCurrentThreadId();
     m_nSerialNo = g_NrlsAllocTracker->AddAllocator(this);
     m_nTotalAllocated = 0;
+    m_nHighWater = 0;
+    m_nTotalRecycled = 0;
     m_dwAllocThreadId = 0;
 #if NRLSTRACK_GETSTACKS    
     m_pLastBlock = NULL;
@@ -105,6 +109,7 @@ void NorlsAllocator::Init(ProtectedEntityFlagsEnum entity)
     allowReadOnlyDirectives = false;
     anyPageMarkedReadOnly = false;
     inAllowingWrite = false;
+    m_pRecycleBins = NULL;
     this->entity = entity;
 }
 
@@ -122,6 +127,9 @@ NorlsAllocator::~NorlsAllocator()
 
 #endif NRLSTRACK
     FreeHeap();
+
+    delete m_pRecycleBins;
+    m_pRecycleBins = NULL;
 }
 
 /*
@@ -308,17 +316,37 @@ void* NorlsAllocator::_AllocNonZero(size_t& sz)
     }
 
     size_t roundSize = VBMath::RoundUpAllocSize(sz);
-    size_t available = limitFree - nextFree;
-   
-    if ( available < roundSize )
+
+    void ** ppRecycled = NULL;
+    if (m_pRecycleBins && roundSize <= MaxRecycleSize)
     {
-        AllocNewPage(sz);
+        ppRecycled = &m_pRecycleBins->heads[RecycleBinIndex(roundSize)];
     }
 
-    p = nextFree;
-    nextFree += roundSize; // this shouldn't overflow because we got the memory for the request (we would have thrown in AllocNewPage() otherwise)
-    
-    MakeCurrentPageWriteableInternal();
+    if (ppRecycled && *ppRecycled)
+    {
+        // Reuse a block of the same size class rather than bumping.
+        p = *ppRecycled;
+        *ppRecycled = *(void **)p;
+
+#if NRLSTRACK
+        m_nTotalRecycled += roundSize;
+#endif NRLSTRACK
+    }
+    else
+    {
+        size_t available = limitFree - nextFree;
+
+        if ( available < roundSize )
+        {
+            AllocNewPage(sz);
+        }
+
+        p = nextFree;
+        nextFree += roundSize; // this shouldn't overflow because we got the memory for the request (we would have thrown in AllocNewPage() otherwise)
+
+        MakeCurrentPageWriteableInternal();
+    }
 
     AssertIfFalse((size_t)nextFree % sizeof(void*) == 0);
     AssertIfFalse((size_t)limitFree % sizeof(void*) == 0);
@@ -326,6 +354,10 @@ void* NorlsAllocator::_AllocNonZero(size_t& sz)
 
 #if NRLSTRACK
     m_nTotalAllocated += roundSize;
+    if (m_nTotalAllocated > m_nHighWater)
+    {
+        m_nHighWater = m_nTotalAllocated;
+    }
     m_dwAllocThreadId  = 0;
 #endif NRLSTRACK
     
@@ -443,10 +475,68 @@ NorlsAllocator::Resize(
     // Realloc is not possible.  Simply do an allocation
     void *pNew = Alloc(cbSizeNew);
     memcpy(pNew, pv, cbSizeOld);
+
+    // The old block is no longer referenced; let a later allocation reuse it.
+    if (m_pRecycleBins)
+    {
+        Recycle(pv, cbSizeOld);
+    }
+
     return pNew;
 }
 
 
+/*
+ * Turn on size-class recycling for this allocator.
+ */
+void NorlsAllocator::EnableRecycling()
+{
+    if (!m_pRecycleBins)
+    {
+        m_pRecycleBins = new (zeromemory) RecycleBins;
+    }
+}
+
+/*
+ * Hand a block back to the allocator so that a later allocation of the same
+ * size can reuse it. 'sz' must be the size that was requested for the block.
+ * Blocks that are too large to be binned are simply dropped, as they would
+ * be without recycling.
+ */
+void NorlsAllocator::Recycle(_Post_invalid_ void * p, size_t sz)
+{
+    VSASSERT(p == NULL || IsAddressInHeap(p), "Recycled block does not belong to this allocator");
+
+    size_t roundSize = VBMath::RoundUpAllocSize(sz);
+
+    // Linking the block would write into it, which read-only pages forbid.
+    if (!m_pRecycleBins || !p || roundSize == 0 || roundSize > MaxRecycleSize || anyPageMarkedReadOnly)
+    {
+        return;
+    }
+
+#if DEBUG
+    // Fill with junk so that use after recycle is noticed.
+    memset(p, 0xEE, roundSize);
+#endif
+
+    void ** ppHead = &m_pRecycleBins->heads[RecycleBinIndex(roundSize)];
+    *(void **)p = *ppHead;
+    *ppHead = p;
+
+#if NRLSTRACK
+    m_nTotalAllocated -= roundSize;
+#endif NRLSTRACK
+}
+
+void NorlsAllocator::ClearRecycleBins()
+{
+    if (m_pRecycleBins)
+    {
+        memset(m_pRecycleBins, 0, sizeof(RecycleBins));
+    }
+}
+
 /*
  * An allocation request has overflowed the current page.
  * allocate a new page and try again.
@@ -557,6 +647,9 @@ void NorlsAllocator::Free(NorlsMark * mark)
 {
     VSASSERT(mark->depth <= m_depth, "Depth check violation on a NorlsMark");
 
+    // Recycled blocks may lie beyond the mark; don't hand them out again.
+    ClearRecycleBins();
+
 #if NRLSTRACK  
     m_nTotalAllocated=  mark->m_nTotalAllocatedAtMark ;
 #if NRLSTRACK_GETSTACKS
@@ -637,6 +730,7 @@ void NorlsAllocator::FreeHeap()
     }
 
     // Reset the allocator.
+    ClearRecycleBins();
     m_depth = 0;
     nextFree = limitFree = NULL;
     pageList = pageLast = NULL;
@@ -724,8 +818,10 @@ NrlsAllocTracker::GetAllocatorStatusReport(_Out_ long *pnCnt, _Out_ long *pnTotM
         if (*pnTotMem == 0) // if the caller wants the entire report (expensive) or just the totals.
         {
            
-            StringCchPrintfW(szBuffer, sizeof(szBuffer), L" %9d,  %4d, %5d, %ws(%d)\r\n", 
+            StringCchPrintfW(szBuffer, sizeof(szBuffer), L" %9d, %9d, %9d,  %4d, %5d, %ws(%d)\r\n", 
                             pAllocator->m_nTotalAllocated, 
+                            pAllocator->m_nHighWater, 
+                            pAllocator->m_nTotalRecycled, 
                             pAllocator->m_dwCreatedThreadId, 
                             pAllocator->m_nSerialNo,
                             pAllocator->m_szFile, 
@@ -757,6 +853,7 @@ NrlsAllocTracker::GetVBMemoryStats(_In_ LPCSTR strDesc)
     listNorls::iterator it = m_set.begin();
     long nCnt = 0;
     long nTotMem = 0;
+    long nHighWater = 0;
     
     for ( ; it != m_set.end() ; ++it)
     {
@@ -764,18 +861,21 @@ NrlsAllocTracker::GetVBMemoryStats(_In_ LPCSTR strDesc)
         NorlsAllocator *pAllocator = *it;
         nCnt++;
         nTotMem += pAllocator->m_nTotalAllocated;
+        nHighWater += pAllocator->m_nHighWater;
     }
     m_VBMemoryInUse.nNrlsTotalAllocs = nCnt;
     m_VBMemoryInUse.nNrlsTotalBytes = nTotMem;
+    m_VBMemoryInUse.nNrlsHighWaterBytes = nHighWater;
 
     if (strDesc)
     {
-        VsDebugPrintf("%20s   Heap Size %9d  Cnt %6d    Nrls Size %9d Cnt %6d\n", 
+        VsDebugPrintf("%20s   Heap Size %9d  Cnt %6d    Nrls Size %9d Cnt %6d High %9d\n", 
             strDesc,
             m_VBMemoryInUse.nHeapTotalBytes,
             m_VBMemoryInUse.nHeapTotalAllocs, 
             m_VBMemoryInUse.nNrlsTotalBytes,
-            m_VBMemoryInUse.nNrlsTotalAllocs
+            m_VBMemoryInUse.nNrlsTotalAllocs,
+            m_VBMemoryInUse.nNrlsHighWaterBytes
             );
     }    
     return m_VBMemoryInUse;
@@ -31,6 +31,7 @@ struct VBMemoryInUse
     
     long nNrlsTotalBytes;
     long nNrlsTotalAllocs;
+    long nNrlsHighWaterBytes;
     
 };
 
@@ -254,6 +255,17 @@ public:
         _In_ size_t cbSizeOld,
         _In_ size_t cbSizeNew);
 
+    // Size-class recycling, for allocators whose owners release objects in bulk.
+    // Once enabled, blocks handed back through Recycle are reused by later
+    // allocations of the same rounded size instead of growing the heap.
+    // Releasing to a mark discards all recycled blocks.
+    void EnableRecycling();
+    void Recycle(_Post_invalid_ void * p, size_t sz);
+    bool IsRecyclingEnabled() const
+    {
+        return m_pRecycleBins != NULL;
+    }
+
     void ValidateHeap();
     PWSTR AllocStr(PCWSTR str);
     NorlsMark Mark();
@@ -270,6 +282,8 @@ public:
     long m_nSerialNo;        // the allocator's serialno
     long m_nSeqNo;  /// the sequence # of the allocation for this allcoator
     ULONG m_nTotalAllocated;
+    ULONG m_nHighWater;      // largest m_nTotalAllocated seen
+    ULONG m_nTotalRecycled;  // bytes served from the recycle bins
 #if NRLSTRACK_GETSTACKS    
     NrlsHeapData  * m_pLastBlock;           // ptr to linked list of alloc'd Heap blocks so VSAssert CHeapSpy can watch Nrlsallocs
     HANDLE  TrackingHeapToUse();
@@ -331,6 +345,23 @@ private:
     void AllocNewPage(size_t sz);
     NorlsPage * NewPage(size_t sz);
 
+    // Recycled blocks are kept in one free list per pointer-size multiple.
+    static const size_t MaxRecycleSize = 32 * sizeof(void *);
+
+    struct RecycleBins
+    {
+        void * heads[MaxRecycleSize / sizeof(void *)];
+    };
+
+    static size_t RecycleBinIndex(size_t roundSize)
+    {
+        return roundSize / sizeof(void *) - 1;
+    }
+
+    void ClearRecycleBins();
+
+    RecycleBins * m_pRecycleBins;
+
     ProtectedEntityFlagsEnum entity;
     bool allowReadOnlyDirectives;
     bool anyPageMarkedReadOnly;
@@ -18,6 +18,11 @@ NorlsAllocatorManager::NorlsAllocatorManager()
     }
 #endif NRLSTRACK
 
+#if BUILDING_VBC
+    // Large pages are never paged out, so only the short lived command line
+    // compiler uses them. This fails quietly without SeLockMemoryPrivilege.
+    m_symbolHeap.EnableLargePageArenas();
+#endif BUILDING_VBC
 }
 
 
@@ -21,9 +21,43 @@ public:
         return m_heap;
     }
 
+    // Heap for the long lived symbol allocators. It is backed by large pages
+    // when the process may use them, to reduce TLB misses while binding.
+    PageHeap& GetSymbolPageHeap()
+    {
+        return m_symbolHeap;
+    }
+
     void CleanupPageHeap()
     {
         m_heap.DecommitUnusedPages();
+        m_symbolHeap.DecommitUnusedPages();
+    }
+
+    // Decommits unused pages and frees unused arenas of both heaps.
+    void ShrinkUnusedResources()
+    {
+        m_heap.ShrinkUnusedResources();
+        m_symbolHeap.ShrinkUnusedResources();
+    }
+
+    // Sizes across both heaps. The maximums are the sums of the maximums of
+    // each heap, which need not have been reached at the same time.
+    unsigned GetCurrentUseSize() const
+    {
+        return m_heap.GetCurrentUseSize() + m_symbolHeap.GetCurrentUseSize();
+    }
+    unsigned GetMaxUseSize() const
+    {
+        return m_heap.GetMaxUseSize() + m_symbolHeap.GetMaxUseSize();
+    }
+    unsigned GetCurrentReserveSize() const
+    {
+        return m_heap.GetCurrentReserveSize() + m_symbolHeap.GetCurrentReserveSize();
+    }
+    unsigned GetMaxReserveSize() const
+    {
+        return m_heap.GetMaxReserveSize() + m_symbolHeap.GetMaxReserveSize();
     }
 
     virtual 
@@ -38,6 +72,7 @@ public:
 
 private:
     PageHeap m_heap;
+    PageHeap m_symbolHeap;
 };
 
 
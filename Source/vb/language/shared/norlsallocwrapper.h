@@ -103,10 +103,17 @@ public:
     template <class T>
     void DeAllocate(T * pData)
     {
-        //we do nothing
-        //infact we don't even run the destructor.
+        //we don't run the destructor.
         //This is because we are using the norls allocator, whic means
         //means memory is never released, and no destructors are ever run.
+        //If the allocator recycles blocks, the memory is handed back so that
+        //the next allocation of the same size can reuse it.
+        NorlsAllocator * pNorlsAlloc = m_pNorlsAlloc;
+
+        if (pNorlsAlloc->IsRecyclingEnabled())
+        {
+            pNorlsAlloc->Recycle(pData, sizeof(T));
+        }
     }
 
     template <class T>
@@ -97,7 +97,11 @@ arenaList(NULL),
 arenaLast(NULL),
 singlePageArenaList(NULL),
 singlePageArenaLast(NULL),
-whatIsProtected(ProtectedEntityFlags::Nothing)
+whatIsProtected(ProtectedEntityFlags::Nothing),
+m_largePageSize(0),
+m_pLargePageBlockNext(NULL),
+m_pLargePageBlockLimit(NULL),
+m_cThreadPageCaches(0)
 {
     CTinyGate gate (&lock ); // Acquire the lock
     StaticInit();
@@ -297,6 +301,19 @@ void* PageHeap::PageArena::AllocPages(unsigned int cPages, PageHeap& parent)
 
 void * PageHeap::AllocPages(size_t sz)
 {
+    // Single pages are served from the calling thread's cache, if it has one,
+    // without contending for the lock.
+    if (sz == pageSize && m_cThreadPageCaches != 0)
+    {
+        ThreadPageCache* pCache = ThreadPageCache::GetCurrent(*this);
+        void* p;
+
+        if (pCache && (p = pCache->Pop()))
+        {
+            return p;
+        }
+    }
+
     CTinyGate gate (&lock ); // Acquire the lock
 
     VSASSERT(sz % pageSize == 0 && sz != 0, "Invalid");     // must be page size multiple.
@@ -382,13 +399,14 @@ void PageHeap::FreeUnusedArenas()
     {
         nextArena = arena->nextArena;
 
-        if (arena->type == LargeAllocation)
+        if (arena->type == LargeAllocation || arena->isLargePage)
             continue;
 
         if (!arena->HasUsedPages())
         {
             //unlink from list.
             RemoveArena(arena, arenaList, arenaLast);
+            m_arenaIndex.Remove(arena);
             size_t addressSpace = arena->GetAddressSpaceSize();
             arena->FreeAddressSpace();
             m_pageCurReserve -= addressSpace / pageSize;
@@ -404,10 +422,10 @@ void PageHeap::FreeUnusedArenas()
         SinglePageArena* arena = singlePageArenasWithFreePages.front();
         singlePageArenasWithFreePages.pop();
 
-        if (arena->NumberOfFreePagesAvailable() == PAGES_PER_ARENA) // all the pages are free
+        if (arena->NumberOfFreePagesAvailable() == PAGES_PER_ARENA && !arena->isLargePage) // all the pages are free
         {
             // Unlink from list and delete the arena
-            addressToSinglePageArenaMap.erase(arena->pages);
+            m_arenaIndex.Remove(arena);
             RemoveArena(arena, singlePageArenaList, singlePageArenaLast);
             size_t addressSpace = arena->GetAddressSpaceSize();
             arena->FreeAddressSpace();                       // sets arena->pages = NULL
@@ -428,6 +446,16 @@ void PageHeap::FreeUnusedArenas()
 */
 void PageHeap::FreePages(ProtectedEntityFlagsEnum entity, _Post_invalid_ void * p, size_t sz)
 {
+    if (sz == pageSize && m_cThreadPageCaches != 0 && CanCacheFreedPage(entity))
+    {
+        ThreadPageCache* pCache = ThreadPageCache::GetCurrent(*this);
+
+        if (pCache && pCache->Push(p))
+        {
+            return;
+        }
+    }
+
     CTinyGate gate (&lock ); // Acquire the lock
 
     VSASSERT(sz % pageSize == 0 && sz != 0, "Invalid");     // must be page size multiple.
@@ -540,6 +568,7 @@ void PageHeap::LargeFree(void * p, size_t sz)
     VSASSERT(arena && arena->type == LargeAllocation && arena->pages == p && arena->size == sz, "Invalid");
 
     m_pageCurReserve -= sz / pageSize;
+    m_arenaIndex.Remove(arena);
 
     // Free the pages.
     BOOL b;
@@ -619,10 +648,9 @@ void PageHeap::SinglePageFree(ProtectedEntityFlagsEnum entity, _Post_invalid_ vo
 {
     CTinyGate gate (&lock); // Acquire the lock
     // Find the arena corresponding to free
-    // Get the first arena whose starting memory address is greater than p, then go back one arena because
-    // p belongs to the closest arena whose first page is <= p, and upper_bound returns the first arena whose
-    // page is strictly greater than p.
-    SinglePageArena* arena = (--addressToSinglePageArenaMap.upper_bound(p))->second;
+    PageArena* owner = m_arenaIndex.Find(p);
+    VSASSERT(owner && owner->type == SinglePageAllocation, "Invalid");
+    SinglePageArena* arena = static_cast<SinglePageArena*>(owner);
     VSASSERT(arena && arena->size == PAGES_PER_ARENA * pageSize && arena->OwnsPage(p), "Invalid");
 
     // Mark the page as freed
@@ -660,10 +688,14 @@ void FreeArenaList(PageHeap::PageArena* list, bool checkLeaks)
             }
         }
 
-        // Free the pages in the arena.
-        BOOL b;
-        b = VirtualFree(arena->pages, 0, MEM_RELEASE);
-        VSASSERT(b, "Invalid");
+        // Free the pages in the arena. Large page arenas are released
+        // with the block they were carved from.
+        if (!arena->isLargePage)
+        {
+            BOOL b;
+            b = VirtualFree(arena->pages, 0, MEM_RELEASE);
+            VSASSERT(b, "Invalid");
+        }
 
         // Free the arena structure.
         delete arena;
@@ -680,12 +712,13 @@ void PageHeap::FreeAllPages(bool checkLeaks)
 
     FreeArenaList(arenaList, checkLeaks);
     FreeArenaList(singlePageArenaList, checkLeaks);
+    FreeLargePageBlocks();
 
     m_pageCurUse = m_pageCurReserve = 0;
     arenaList = arenaLast = NULL;
     singlePageArenaList = singlePageArenaLast = NULL;
 
-    addressToSinglePageArenaMap.clear();  
+    m_arenaIndex.Clear();
     singlePageArenasWithFreePages = std::queue<SinglePageArena*>();
 }
 
@@ -698,7 +731,8 @@ bool PageHeap::DecommitUnusedPagesFromArenaList(PageArena* list)
 
     for (arena = list; arena != NULL; arena = arena->nextArena)
     {
-        if (arena->type == LargeAllocation)
+        // Large pages cannot be decommitted.
+        if (arena->type == LargeAllocation || arena->isLargePage)
             continue;
 
         for (int dwIndex = 0; dwIndex < PAGES_PER_ARENA / BITS_DWORD; ++dwIndex)
@@ -831,18 +865,20 @@ PageHeap::PageArena * PageHeap::CreateArena(PageArenaType type, size_t sz)
         }
     }
 
-    newArena->pages = VirtualAlloc(0, sz, type == LargeAllocation ? MEM_COMMIT : MEM_RESERVE, PAGE_READWRITE);
+    newArena->pages = type == LargeAllocation ?
+        VirtualAlloc(0, sz, MEM_COMMIT, PAGE_READWRITE) :
+        ReserveArenaPages(newArena, sz);
     if (!newArena->pages)
     {
         VbThrow(GetLastHResultError());
     }
 
+    newArena->size = sz;
+    m_arenaIndex.Insert(newArena);
+
     if (newSinglePageArena)
     {
         // also add the new SinglePageArena to our indexing data structures
-        VSASSERT(addressToSinglePageArenaMap.find(newSinglePageArena->pages) == addressToSinglePageArenaMap.end(), 
-            "We shouldn't already have an arena for this address");
-        addressToSinglePageArenaMap[newSinglePageArena->pages] = newSinglePageArena;
         singlePageArenasWithFreePages.push(newSinglePageArena);
     }
 
@@ -852,7 +888,6 @@ PageHeap::PageArena * PageHeap::CreateArena(PageArenaType type, size_t sz)
         m_pageMaxReserve = m_pageCurReserve;
     }
 
-    newArena->size = sz;
     newArena->type = type;
 
     return newArena;
@@ -863,14 +898,290 @@ PageHeap::PageArena * PageHeap::CreateArena(PageArenaType type, size_t sz)
 */
 PageHeap::PageArena * PageHeap::FindArena(const void * p)
 {
-    PageArena * arena;
+    PageArena * arena = m_arenaIndex.Find(p);
 
-    for (arena = arenaList; arena != NULL; arena = arena->nextArena)
+    VSASSERT(arena && arena->OwnsPage(p), "Invalid");      // Should find the arena.
+    return arena;
+}
+
+/*
+* Reserve the address space of a regular or single page arena. With large
+* page arenas enabled, the arena is a committed slice of a large page block.
+*/
+void* PageHeap::ReserveArenaPages(PageArena* arena, size_t sz)
+{
+    if (m_largePageSize && sz <= m_largePageSize)
+    {
+        if (m_pLargePageBlockNext + sz > m_pLargePageBlockLimit)
+        {
+            void* block = VirtualAlloc(0, m_largePageSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+            if (block)
+            {
+                m_largePageBlocks.push_back(block);
+                m_pLargePageBlockNext = (BYTE*)block;
+                m_pLargePageBlockLimit = (BYTE*)block + m_largePageSize;
+            }
+            else
+            {
+                // Physical memory is too fragmented for another large page;
+                // stop trying and fall back to regular arenas.
+                m_largePageSize = 0;
+                m_pLargePageBlockNext = m_pLargePageBlockLimit = NULL;
+            }
+        }
+
+        if (m_largePageSize)
+        {
+            void* p = m_pLargePageBlockNext;
+            m_pLargePageBlockNext += sz;
+
+            arena->isLargePage = true;
+            memset(arena->committed, 0xFF, sizeof(arena->committed));
+            return p;
+        }
+    }
+
+    return VirtualAlloc(0, sz, MEM_RESERVE, PAGE_READWRITE);
+}
+
+void PageHeap::FreeLargePageBlocks()
+{
+    for (std::list<void*>::iterator it = m_largePageBlocks.begin(); it != m_largePageBlocks.end(); ++it)
+    {
+        BOOL b;
+        b = VirtualFree(*it, 0, MEM_RELEASE);
+        VSASSERT(b, "Invalid");
+    }
+
+    m_largePageBlocks.clear();
+    m_pLargePageBlockNext = m_pLargePageBlockLimit = NULL;
+}
+
+bool PageHeap::EnableLargePageArenas()
+{
+    CTinyGate gate (&lock ); // Acquire the lock
+
+    if (m_largePageSize)
+    {
+        return true;
+    }
+
+    // Large pages can't be protected at system page granularity.
+    if (PageProtect::StaticWhatIsProtected() != ProtectedEntityFlags::Nothing)
     {
-        if (arena->OwnsPage(p))
-            return arena;
+        return false;
+    }
+
+    // Slices must tile the large page exactly so that none straddle a block.
+    size_t largePageSize = GetLargePageMinimum();
+    size_t arenaSize = PAGES_PER_ARENA * pageSize;
+    if (largePageSize == 0 || largePageSize % arenaSize != 0)
+    {
+        return false;
+    }
+
+    // Allocating large pages requires the lock memory privilege to be enabled.
+    HANDLE hToken = NULL;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken))
+    {
+        return false;
+    }
+
+    TOKEN_PRIVILEGES tp;
+    tp.PrivilegeCount = 1;
+    tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    bool enabled =
+        LookupPrivilegeValueW(NULL, SE_LOCK_MEMORY_NAME, &tp.Privileges[0].Luid) &&
+        AdjustTokenPrivileges(hToken, FALSE, &tp, 0, NULL, NULL) &&
+        GetLastError() == ERROR_SUCCESS;    // ERROR_NOT_ALL_ASSIGNED if the privilege isn't held
+
+    CloseHandle(hToken);
+
+    if (enabled)
+    {
+        m_largePageSize = largePageSize;
+    }
+
+    return enabled;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Address to arena index.
+
+PageHeap::ArenaIndex::ArenaIndex()
+{
+    memset(m_root, 0, sizeof(m_root));
+}
+
+PageHeap::ArenaIndex::~ArenaIndex()
+{
+    Clear();
+}
+
+void PageHeap::ArenaIndex::Insert(PageArena* arena)
+{
+    Set(arena, arena);
+}
+
+void PageHeap::ArenaIndex::Remove(const PageArena* arena)
+{
+    Set(arena, NULL);
+}
+
+/*
+* Point every granule covered by the arena at 'value', creating interior
+* nodes as needed.
+*/
+void PageHeap::ArenaIndex::Set(const PageArena* arena, PageArena* value)
+{
+    VSASSERT(arena->pages && arena->size, "Arena must own address space before it is indexed");
+
+    size_t keyFirst = (size_t)arena->pages >> ARENA_INDEX_GRANULE_SHIFT;
+    size_t keyLast = ((size_t)arena->pages + arena->size - 1) >> ARENA_INDEX_GRANULE_SHIFT;
+
+    for (size_t key = keyFirst; key <= keyLast; key++)
+    {
+        VSASSERT(key < ((size_t)1 << ARENA_INDEX_KEY_BITS), "Address outside of the indexed range");
+
+        MidNode*& mid = m_root[key >> (ARENA_INDEX_LEAF_BITS + ARENA_INDEX_MID_BITS)];
+        if (!mid)
+        {
+            if (!value)
+            {
+                continue;
+            }
+            mid = new (zeromemory) MidNode;
+        }
+
+        LeafNode*& leaf = mid->leaves[(key >> ARENA_INDEX_LEAF_BITS) & ((1 << ARENA_INDEX_MID_BITS) - 1)];
+        if (!leaf)
+        {
+            if (!value)
+            {
+                continue;
+            }
+            leaf = new (zeromemory) LeafNode;
+        }
+
+        PageArena*& slot = leaf->arenas[key & ((1 << ARENA_INDEX_LEAF_BITS) - 1)];
+        VSASSERT(value == NULL ? slot == arena : slot == NULL, "Arena index out of sync");
+        slot = value;
+    }
+}
+
+void PageHeap::ArenaIndex::Clear()
+{
+    for (size_t iRoot = 0; iRoot < _countof(m_root); iRoot++)
+    {
+        MidNode* mid = m_root[iRoot];
+        if (mid)
+        {
+            for (size_t iMid = 0; iMid < _countof(mid->leaves); iMid++)
+            {
+                delete mid->leaves[iMid];
+            }
+            delete mid;
+            m_root[iRoot] = NULL;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+// Per-thread single page cache.
+
+// The innermost cache created on this thread, if any.
+static __declspec(thread) PageHeap::ThreadPageCache* t_pCurrentPageCache = NULL;
+
+PageHeap::ThreadPageCache::ThreadPageCache(PageHeap& heap) :
+    m_heap(heap),
+    m_pPrevious(t_pCurrentPageCache),
+#if DEBUG
+    m_dwThreadId(GetCurrentThreadId()),
+#endif
+    m_cPages(0),
+    m_cHits(0)
+{
+    t_pCurrentPageCache = this;
+    InterlockedIncrement(&m_heap.m_cThreadPageCaches);
+}
+
+PageHeap::ThreadPageCache::~ThreadPageCache()
+{
+    VSASSERT(m_dwThreadId == GetCurrentThreadId(), "ThreadPageCache destroyed on the wrong thread");
+    VSASSERT(t_pCurrentPageCache == this, "ThreadPageCache instances must be destroyed in reverse order");
+
+    Flush();
+    t_pCurrentPageCache = m_pPrevious;
+    InterlockedDecrement(&m_heap.m_cThreadPageCaches);
+}
+
+/*
+* Find the innermost cache on this thread that caches pages of the given heap.
+*/
+PageHeap::ThreadPageCache* PageHeap::ThreadPageCache::GetCurrent(const PageHeap& heap)
+{
+    for (ThreadPageCache* pCache = t_pCurrentPageCache; pCache; pCache = pCache->m_pPrevious)
+    {
+        if (&pCache->m_heap == &heap)
+        {
+            return pCache;
+        }
     }
 
-    VSASSERT(0, "Invalid");      // Should find the arena.
     return NULL;
 }
+
+void* PageHeap::ThreadPageCache::Pop()
+{
+    if (m_cPages == 0)
+    {
+        return NULL;
+    }
+
+    void* p = m_pages[--m_cPages];
+    m_cHits++;
+
+#ifdef DEBUG
+    // Make sure they aren't zero filled.
+    memset(p, 0xCC, pageSize);
+#endif //DEBUG
+
+    return p;
+}
+
+bool PageHeap::ThreadPageCache::Push(_Post_invalid_ void* p)
+{
+    if (m_cPages == MaxCachedPages)
+    {
+        return false;
+    }
+
+#ifdef DEBUG
+    // Fill pages with junk to indicated unused.
+    memset(p, 0xAE, pageSize);
+#endif //DEBUG
+
+    m_pages[m_cPages++] = p;
+    return true;
+}
+
+/*
+* Return all cached pages to the heap.
+*/
+void PageHeap::ThreadPageCache::Flush()
+{
+    if (m_cPages == 0)
+    {
+        return;
+    }
+
+    CTinyGate gate (&m_heap.lock); // Acquire the lock
+
+    while (m_cPages)
+    {
+        m_heap.m_pageCurUse -= 1;
+        m_heap.SinglePageFree(ProtectedEntityFlags::Other, m_pages[--m_cPages]);
+    }
+}
@@ -19,6 +19,20 @@
 #define PAGES_PER_ARENA 128              // 4k system page size => 128*4k = 512KB per arena
 #define BIGALLOC_SIZE   (128 * 1024)    // more than this alloc (128KB) is not done from an arena.
 
+// The arena index maps each allocation granule of the address space to the
+// arena that reserved it. VirtualAlloc reservations start on 64K boundaries,
+// so no granule can be shared by two arenas.
+#define ARENA_INDEX_GRANULE_SHIFT   16
+#ifdef _WIN64
+#define ARENA_INDEX_ADDRESS_BITS    48
+#else
+#define ARENA_INDEX_ADDRESS_BITS    32
+#endif
+#define ARENA_INDEX_KEY_BITS        (ARENA_INDEX_ADDRESS_BITS - ARENA_INDEX_GRANULE_SHIFT)
+#define ARENA_INDEX_LEAF_BITS       10
+#define ARENA_INDEX_MID_BITS        ((ARENA_INDEX_KEY_BITS - ARENA_INDEX_LEAF_BITS) / 2)
+#define ARENA_INDEX_ROOT_BITS       (ARENA_INDEX_KEY_BITS - ARENA_INDEX_LEAF_BITS - ARENA_INDEX_MID_BITS)
+
 #define DWORD_BIT_SHIFT 5        // log2 of bits in a DWORD.
 #define BITS_DWORD      (1 << DWORD_BIT_SHIFT)
 #define DWORD_BIT_MASK  (BITS_DWORD - 1)
@@ -44,6 +58,7 @@ public:
         void* pages;           // the pages in the arena.
         size_t size;            // size of the arena.
         PageArenaType type;        // large allocs and single page allocs have special cased codepaths
+        bool isLargePage;          // carved out of a large page block; always committed, never released on its own
         DWORD used[PAGES_PER_ARENA / BITS_DWORD];        // bit map of in-use pages in this arena.
         DWORD committed[PAGES_PER_ARENA / BITS_DWORD];   // bit map of committed pages in this arena.
 
@@ -133,11 +148,112 @@ public:
         }
     };
 
+    // Constant time map from an address to the arena that owns it. Interior
+    // nodes are created on demand and kept until the index is cleared.
+    class ArenaIndex
+    {
+    public:
+        ArenaIndex();
+        ~ArenaIndex();
+
+        void Insert(PageArena* arena);
+        void Remove(const PageArena* arena);
+        void Clear();
+
+        PageArena* Find(const void* p) const
+        {
+            size_t key = (size_t)p >> ARENA_INDEX_GRANULE_SHIFT;
+            VSASSERT(key < ((size_t)1 << ARENA_INDEX_KEY_BITS), "Address outside of the indexed range");
+
+            MidNode* mid = m_root[key >> (ARENA_INDEX_LEAF_BITS + ARENA_INDEX_MID_BITS)];
+            if (!mid)
+            {
+                return NULL;
+            }
+
+            LeafNode* leaf = mid->leaves[(key >> ARENA_INDEX_LEAF_BITS) & ((1 << ARENA_INDEX_MID_BITS) - 1)];
+            if (!leaf)
+            {
+                return NULL;
+            }
+
+            return leaf->arenas[key & ((1 << ARENA_INDEX_LEAF_BITS) - 1)];
+        }
+
+    private:
+        ArenaIndex(const ArenaIndex&);
+        ArenaIndex& operator=(const ArenaIndex&);
+
+        struct LeafNode
+        {
+            PageArena* arenas[1 << ARENA_INDEX_LEAF_BITS];
+        };
+
+        struct MidNode
+        {
+            LeafNode* leaves[1 << ARENA_INDEX_MID_BITS];
+        };
+
+        void Set(const PageArena* arena, PageArena* value);
+
+        MidNode* m_root[1 << ARENA_INDEX_ROOT_BITS];
+    };
+
+    // Optional cache of single pages private to the thread that creates it.
+    // While one is alive, single page allocations and frees on that thread
+    // against its heap are satisfied from the cache without taking the heap
+    // lock.  Cached pages still count as in use until the cache is destroyed,
+    // which returns them to the heap.  Must be destroyed on the creating thread.
+    class ThreadPageCache
+    {
+    public:
+        ThreadPageCache(PageHeap& heap);
+        ~ThreadPageCache();
+
+        static ThreadPageCache* GetCurrent(const PageHeap& heap);
+
+        void* Pop();
+        bool Push(_Post_invalid_ void* p);
+        void Flush();
+
+        unsigned GetHitCount() const
+        {
+            return m_cHits;
+        }
+
+    private:
+        ThreadPageCache(const ThreadPageCache&);
+        ThreadPageCache& operator=(const ThreadPageCache&);
+
+        static const unsigned MaxCachedPages = 32;
+
+        PageHeap& m_heap;
+        ThreadPageCache* m_pPrevious;
+#if DEBUG
+        DWORD m_dwThreadId;
+#endif
+        unsigned m_cPages;
+        unsigned m_cHits;
+        void* m_pages[MaxCachedPages];
+    };
+
     PageHeap();
     ~PageHeap();
 
     static void StaticInit();
 
+    // Back regular and single page arenas with large (2MB) pages when the
+    // process is allowed to lock memory and no page protection is in effect.
+    // Such arenas are committed up front and are only released by
+    // FreeAllPages. Returns false, leaving the heap unchanged, if large pages
+    // are unavailable.
+    bool EnableLargePageArenas();
+
+    bool UsesLargePageArenas() const
+    {
+        return m_largePageSize != 0;
+    }
+
     void* AllocPages( _In_ size_t sz);
     void FreePages(ProtectedEntityFlagsEnum entity, _Post_invalid_ void* p, size_t sz);
     void FreeAllPages(bool checkLeaks = true);
@@ -184,6 +300,13 @@ private:
 
     void FreePagesHelper(ProtectedEntityFlagsEnum entity, PageArena* arena, _Post_invalid_ void* p, size_t sz);
 
+    // Pages can only bypass FreePagesHelper when it would not protect them.
+    static bool CanCacheFreedPage(ProtectedEntityFlagsEnum entity)
+    {
+        return !PageProtect::IsEntityProtected(entity) &&
+               !PageProtect::IsEntityProtected(ProtectedEntityFlags::UnusedMemory);
+    }
+
     // special case allocation/free behavior for large allocations
     void * LargeAlloc(size_t sz);
     void LargeFree(void * p, size_t sz);
@@ -192,11 +315,16 @@ private:
     void* SinglePageAlloc();
     void SinglePageFree(ProtectedEntityFlagsEnum entity, _Post_invalid_ void* p);
 
+    // Reserve address space for a non-large allocation arena, from a large
+    // page block if large page arenas are enabled.
+    void* ReserveArenaPages(PageArena* arena, size_t sz);
+    void FreeLargePageBlocks();
+
     SinglePageArena* singlePageArenaList; // List of memory arenas exclusively for single page allocs
     SinglePageArena* singlePageArenaLast; // Last memory arena in list.
     
     // used to efficiently find the arena a freed memory address belonged to
-    std::map<void *, SinglePageArena*> addressToSinglePageArenaMap;  
+    ArenaIndex m_arenaIndex;
     // used to efficiently find an arena to make a new allocation from
     std::queue<SinglePageArena*> singlePageArenasWithFreePages;
 
@@ -210,4 +338,14 @@ private:
 
     size_t m_pageCurUse, m_pageMaxUse;
     size_t m_pageCurReserve, m_pageMaxReserve;
+
+    // Large page arena state; m_largePageSize is 0 unless enabled.
+    size_t m_largePageSize;
+    BYTE* m_pLargePageBlockNext;        // next unused arena slice of the current block
+    BYTE* m_pLargePageBlockLimit;
+    std::list<void*> m_largePageBlocks;
+
+    // Number of live ThreadPageCache instances on any thread for this heap.
+    // Heaps that no thread caches for skip the thread local lookup.
+    volatile LONG m_cThreadPageCaches;
 };
@@ -81,10 +81,10 @@ CompilerResults ^HostedCompiler::CompileExpression(System::String ^expression,
                     System::Globalization::CultureInfo::InvariantCulture,
                     "Expression = \"{0}\" :: CurrentReservedSize = {1} :: CurrentUseSize = {2} :: MaxReservedSize = {3} :: MaxUseSize = {4} :: WorkingSet64 = {5} :: PagedMemorySize64 = {6}", 
                     expression, 
-                    g_pvbNorlsManager->GetPageHeap().GetCurrentReserveSize(), 
-                    g_pvbNorlsManager->GetPageHeap().GetCurrentUseSize(), 
-                    g_pvbNorlsManager->GetPageHeap().GetMaxReserveSize(), 
-                    g_pvbNorlsManager->GetPageHeap().GetMaxUseSize(),
+                    g_pvbNorlsManager->GetCurrentReserveSize(), 
+                    g_pvbNorlsManager->GetCurrentUseSize(), 
+                    g_pvbNorlsManager->GetMaxReserveSize(), 
+                    g_pvbNorlsManager->GetMaxUseSize(),
                     System::Diagnostics::Process::GetCurrentProcess()->WorkingSet64,
                     System::Diagnostics::Process::GetCurrentProcess()->PagedMemorySize64));
         }
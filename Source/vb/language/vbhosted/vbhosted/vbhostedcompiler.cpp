@@ -74,7 +74,7 @@ STDMETHODIMP VbHostedCompiler::CompileExpression
         IfFailGo(session.CompileExpression(pParsed));
     }
 
-    g_pvbNorlsManager->GetPageHeap().ShrinkUnusedResources();
+    g_pvbNorlsManager->ShrinkUnusedResources();
 
     VB_EXIT_LABEL();
 }
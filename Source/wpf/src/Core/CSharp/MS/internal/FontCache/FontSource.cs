@@ -258,6 +258,25 @@ namespace MS.Internal.FontCache
             return ByteArrayToUnmanagedStream(bits);
         }
 
+        /// <summary>
+        /// Demand read permissions for all font files except system ones. This is the
+        /// demand GetUnmanagedStream makes before mapping a font file, for callers that
+        /// reuse content mapped earlier for another caller.
+        /// </summary>
+        /// <SecurityNote>
+        ///     Critical - as this function calls critical WindowsFontsUriObject.
+        ///     TreatAsSafe - as the WindowsFontsUriObject is used to determine whether to demand permissions.
+        /// </SecurityNote>
+        [SecurityCritical, SecurityTreatAsSafe]
+        public void DemandFileIOPermission()
+        {
+            // Demand FileIORead permission for any non-system fonts.
+            if (_fontUri.IsFile && !_skipDemand)
+            {
+                SecurityHelper.DemandUriReadPermission(_fontUri);
+            }
+        }
+
         /// <summary>
         /// Tries to open a file and throws exceptions in case of failures. This
         /// method is used to achieve the same exception throwing behavior after
@@ -397,22 +416,6 @@ namespace MS.Internal.FontCache
             return memoryFont;
         }
 
-        /// <summary>
-        /// Demand read permissions for all fonts except system ones.
-        /// </summary>
-        /// <SecurityNote>
-        ///     Critical - as this function calls critical WindowsFontsUriObject.
-        ///     TreatAsSafe - as the WindowsFontsUriObject is used to determine whether to demand permissions.
-        /// </SecurityNote>
-        [SecurityCritical, SecurityTreatAsSafe]
-        private void DemandFileIOPermission()
-        {
-            // Demand FileIORead permission for any non-system fonts.
-            if (!_skipDemand)
-            {
-                SecurityHelper.DemandUriReadPermission(_fontUri);
-            }
-        }
 
         #endregion Private Methods
 
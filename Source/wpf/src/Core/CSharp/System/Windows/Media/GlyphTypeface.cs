@@ -1089,7 +1089,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetAdvanceWidth);
+                return CreateGlyphIndexer(this.GetAdvanceWidth, DesignGlyphMetric.AdvanceWidth);
             }
         }
 
@@ -1101,7 +1101,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetAdvanceHeight);
+                return CreateGlyphIndexer(this.GetAdvanceHeight, DesignGlyphMetric.AdvanceHeight);
             }
         }
 
@@ -1116,7 +1116,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetLeftSidebearing);
+                return CreateGlyphIndexer(this.GetLeftSidebearing, DesignGlyphMetric.LeftSideBearing);
             }
         }
 
@@ -1131,7 +1131,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetRightSidebearing);
+                return CreateGlyphIndexer(this.GetRightSidebearing, DesignGlyphMetric.RightSideBearing);
             }
         }
 
@@ -1147,7 +1147,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetTopSidebearing);
+                return CreateGlyphIndexer(this.GetTopSidebearing, DesignGlyphMetric.TopSideBearing);
             }
         }
 
@@ -1163,7 +1163,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetBottomSidebearing);
+                return CreateGlyphIndexer(this.GetBottomSidebearing, DesignGlyphMetric.BottomSideBearing);
             }
         }
 
@@ -1175,7 +1175,7 @@ namespace System.Windows.Media
             get
             {
                 CheckInitialized(); // This can only be called on fully initialized GlyphTypeface
-                return CreateGlyphIndexer(this.GetBaseline);
+                return CreateGlyphIndexer(this.GetBaseline, DesignGlyphMetric.Baseline);
             }
         }
 
@@ -1489,6 +1489,83 @@ namespace System.Windows.Media
             return  -1 * ((double)metrics.BottomSideBearing + metrics.VerticalOriginY - metrics.AdvanceHeight);
         }
 
+        /// <summary>
+        /// Obtains one design metric, relative to the em size, for glyphs firstGlyph to firstGlyph + count - 1
+        /// with a single call into DWrite. Used by the glyph indexers when they enumerate all the glyphs of the font.
+        /// </summary>
+        /// <SecurityNote>
+        /// Critical - Calls critical DWrite.FontFace methods
+        /// TreatAsSafe - This information is safe to expose.
+        /// </SecurityNote>
+        [SecurityCritical, SecurityTreatAsSafe]
+        private unsafe void GetDesignGlyphMetricValues(DesignGlyphMetric metric, ushort firstGlyph, int count, double[] values)
+        {
+            Invariant.Assert(count <= GlyphIndexer.BatchSize && count <= values.Length);
+
+            ushort* pGlyphIndices = stackalloc ushort[count];
+            for (int i = 0; i < count; ++i)
+            {
+                pGlyphIndices[i] = (ushort)(firstGlyph + i);
+            }
+
+            // Only the outputs the metric is computed from are requested.
+            MS.Internal.Text.TextInterface.GlyphMetrics* pGlyphMetrics = null;
+            uint* pAdvanceWidths = null;
+            MS.Internal.Text.TextInterface.GlyphBounds* pGlyphBounds = null;
+
+            switch (metric)
+            {
+                case DesignGlyphMetric.AdvanceWidth:
+                    uint* advanceWidths = stackalloc uint[count];
+                    pAdvanceWidths = advanceWidths;
+                    break;
+
+                case DesignGlyphMetric.LeftSideBearing:
+                case DesignGlyphMetric.Baseline:
+                    MS.Internal.Text.TextInterface.GlyphBounds* glyphBounds = stackalloc MS.Internal.Text.TextInterface.GlyphBounds[count];
+                    pGlyphBounds = glyphBounds;
+                    break;
+
+                default:
+                    MS.Internal.Text.TextInterface.GlyphMetrics* glyphMetrics = stackalloc MS.Internal.Text.TextInterface.GlyphMetrics[count];
+                    pGlyphMetrics = glyphMetrics;
+                    break;
+            }
+
+            MS.Internal.Text.TextInterface.FontFace fontFaceDWrite = _font.GetFontFace();
+            try
+            {
+                fontFaceDWrite.GetDesignGlyphMetricsAndBounds(pGlyphIndices, checked((uint)count), pGlyphMetrics, pAdvanceWidths, pGlyphBounds);
+            }
+            finally
+            {
+                fontFaceDWrite.Release();
+            }
+
+            double designEmHeight = DesignEmHeight;
+
+            for (int i = 0; i < count; ++i)
+            {
+                double value;
+
+                switch (metric)
+                {
+                    case DesignGlyphMetric.AdvanceWidth:      value = pAdvanceWidths[i];                   break;
+                    case DesignGlyphMetric.AdvanceHeight:     value = pGlyphMetrics[i].AdvanceHeight;      break;
+                    case DesignGlyphMetric.LeftSideBearing:   value = pGlyphBounds[i].Left;                break;
+                    case DesignGlyphMetric.RightSideBearing:  value = pGlyphMetrics[i].RightSideBearing;   break;
+                    case DesignGlyphMetric.TopSideBearing:    value = pGlyphMetrics[i].TopSideBearing;     break;
+                    case DesignGlyphMetric.BottomSideBearing: value = pGlyphMetrics[i].BottomSideBearing;  break;
+                    default:
+                        // The black box bottom is measured up from the baseline.
+                        value = -pGlyphBounds[i].Bottom;
+                        break;
+                }
+
+                values[i] = value / designEmHeight;
+            }
+        }
+
         /// <summary>
         /// Optimized version of obtaining all of glyph metrics from font cache at once
         /// without repeated checks and divisions.
@@ -2077,14 +2154,19 @@ namespace System.Windows.Media
         /// Safe - This information is safe to expose.
         /// </SecurityNote>
         [SecurityCritical, SecurityTreatAsSafe]
-        private GlyphIndexer CreateGlyphIndexer(GlyphAccessor accessor)
+        private GlyphIndexer CreateGlyphIndexer(GlyphAccessor accessor, DesignGlyphMetric metric)
         {
             GlyphIndexer indexer;
 
+            GlyphRangeAccessor rangeAccessor = delegate(ushort firstGlyph, int count, double[] values)
+            {
+                GetDesignGlyphMetricValues(metric, firstGlyph, count, values);
+            };
+
             MS.Internal.Text.TextInterface.FontFace fontFaceDWrite = _font.GetFontFace();
             try
             {
-                indexer = new GlyphIndexer(accessor, fontFaceDWrite.GlyphCount);
+                indexer = new GlyphIndexer(accessor, rangeAccessor, fontFaceDWrite.GlyphCount);
             }
             finally
             {
@@ -2106,18 +2188,62 @@ namespace System.Windows.Media
 
         private delegate double GlyphAccessor(ushort glyphIndex, float pixelsPerDip, TextFormattingMode textFormattingMode, bool isSideways);
 
+        /// <summary>
+        /// Fills values[0] to values[count - 1] with the design metric of glyphs firstGlyph to firstGlyph + count - 1.
+        /// </summary>
+        private delegate void GlyphRangeAccessor(ushort firstGlyph, int count, double[] values);
+
+        /// <summary>
+        /// The design metrics exposed through glyph indexers.
+        /// </summary>
+        private enum DesignGlyphMetric
+        {
+            AdvanceWidth,
+            AdvanceHeight,
+            LeftSideBearing,
+            RightSideBearing,
+            TopSideBearing,
+            BottomSideBearing,
+            Baseline
+        }
+
         /// <summary>
         /// This class is a helper to implement named indexers
         /// for glyph metrics.
         /// </summary>
         private class GlyphIndexer : IDictionary<ushort, double>
         {
-            internal GlyphIndexer(GlyphAccessor accessor, ushort numberOfGlyphs)
+            internal GlyphIndexer(GlyphAccessor accessor, GlyphRangeAccessor rangeAccessor, ushort numberOfGlyphs)
             {
                 _accessor = accessor;
+                _rangeAccessor = rangeAccessor;
                 _numberOfGlyphs = numberOfGlyphs;
             }
 
+            /// <summary>
+            /// Number of glyphs whose metrics are obtained at once when enumerating.
+            /// </summary>
+            internal const int BatchSize = 256;
+
+            /// <summary>
+            /// Returns the values of all the glyphs in glyph index order, obtaining them
+            /// BatchSize glyphs at a time instead of one glyph per call.
+            /// </summary>
+            private IEnumerable<double> EnumerateValues()
+            {
+                double[] values = new double[Math.Min((int)_numberOfGlyphs, BatchSize)];
+
+                for (int firstGlyph = 0; firstGlyph < _numberOfGlyphs; firstGlyph += values.Length)
+                {
+                    int count = Math.Min(values.Length, _numberOfGlyphs - firstGlyph);
+
+                    _rangeAccessor((ushort)firstGlyph, count, values);
+
+                    for (int i = 0; i < count; ++i)
+                        yield return values[i];
+                }
+            }
+
             #region IDictionary<ushort,double> Members
 
             public void Add(ushort key, double value)
@@ -2212,8 +2338,12 @@ namespace System.Windows.Media
                     throw new ArgumentOutOfRangeException("arrayIndex");
                 }
 
-                for (ushort i = 0; i < Count; ++i)
-                    array[arrayIndex + i] = new KeyValuePair<ushort, double>(i, this[i]);
+                ushort i = 0;
+                foreach (double value in EnumerateValues())
+                {
+                    array[arrayIndex + i] = new KeyValuePair<ushort, double>(i, value);
+                    ++i;
+                }
             }
 
             public int Count
@@ -2237,8 +2367,9 @@ namespace System.Windows.Media
 
             public IEnumerator<KeyValuePair<ushort, double>> GetEnumerator()
             {
-                for (ushort i = 0; i < Count; ++i)
-                    yield return new KeyValuePair<ushort, double>(i, this[i]);
+                ushort i = 0;
+                foreach (double value in EnumerateValues())
+                    yield return new KeyValuePair<ushort, double>(i++, value);
             }
 
             #endregion
@@ -2301,8 +2432,9 @@ namespace System.Windows.Media
                         throw new ArgumentOutOfRangeException("arrayIndex");
                     }
 
-                    for (ushort i = 0; i < Count; ++i)
-                        array[arrayIndex + i] = _glyphIndexer[i];
+                    int i = 0;
+                    foreach (double value in _glyphIndexer.EnumerateValues())
+                        array[arrayIndex + i++] = value;
                 }
 
                 public int Count
@@ -2326,8 +2458,7 @@ namespace System.Windows.Media
 
                 public IEnumerator<double> GetEnumerator()
                 {
-                    for (ushort i = 0; i < Count; ++i)
-                        yield return _glyphIndexer[i];
+                    return _glyphIndexer.EnumerateValues().GetEnumerator();
                 }
 
                 #endregion
@@ -2345,6 +2476,7 @@ namespace System.Windows.Media
             }
 
             private GlyphAccessor _accessor;
+            private GlyphRangeAccessor _rangeAccessor;
             private ushort _numberOfGlyphs;
         }
 
@@ -0,0 +1,179 @@
+#include "CharAttributeTable.h"
+#include "ItemizerHelper.h"
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+    /// <SecurityNote>
+    /// Critical    - Returns a pointer to the native table.
+    /// </SecurityNote>
+    [SecurityCritical]
+    const CharAttributeType* CharAttributeTable::GetTable(IClassification^ classificationUtility)
+    {
+        const CharAttributeType* table = _table;
+        if (table == NULL)
+        {
+            System::Threading::Monitor::Enter(_tableLock);
+            try
+            {
+                if (_table == NULL)
+                {
+                    table = BuildTable(classificationUtility);
+
+                    // Make sure the content of the table is visible before the table is published.
+                    System::Threading::Thread::MemoryBarrier();
+                    _table = table;
+                }
+                table = _table;
+            }
+            finally
+            {
+                System::Threading::Monitor::Exit(_tableLock);
+            }
+        }
+        return table;
+    }
+
+    /// <SecurityNote>
+    /// Critical    - Asserts unmanaged code permission to new and delete native buffers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    [SecurityPermission(SecurityAction::Assert, UnmanagedCode=true)]
+    const CharAttributeType* CharAttributeTable::BuildTable(IClassification^ classificationUtility)
+    {
+        CharAttributeType* attributes = new CharAttributeType[PageSize * PageSize];
+        try
+        {
+            bool isCombining;
+            bool needsCaretInfo;
+            bool isIndic;
+            bool isDigit;
+            bool isLatin;
+            bool isStrong;
+
+            for (UINT32 ch = 0; ch < PageSize * PageSize; ++ch)
+            {
+                classificationUtility->GetCharAttribute(
+                    ch,
+                    isCombining,
+                    needsCaretInfo,
+                    isIndic,
+                    isDigit,
+                    isLatin,
+                    isStrong
+                    );
+
+                attributes[ch] = (CharAttributeType)
+                                 (((isCombining)    ? CharAttribute::IsCombining    : CharAttribute::None)
+                                | ((needsCaretInfo) ? CharAttribute::NeedsCaretInfo : CharAttribute::None)
+                                | ((isLatin)        ? CharAttribute::IsLatin        : CharAttribute::None)
+                                | ((isIndic)        ? CharAttribute::IsIndic        : CharAttribute::None)
+                                | ((isStrong)       ? CharAttribute::IsStrong       : CharAttribute::None)
+                                | ((ItemizerHelper::IsExtendedCharacter((WCHAR)ch)) ? CharAttribute::IsExtended : CharAttribute::None)
+                                | ((isDigit)        ? (int)IsDigit                  : CharAttribute::None));
+            }
+
+            // Map every high byte to the first page with the same content.
+            BYTE   pageIndex[PageSize];
+            UINT32 pageSource[PageSize];
+            UINT32 pageCount = 0;
+
+            for (UINT32 high = 0; high < PageSize; ++high)
+            {
+                UINT32 page = 0;
+                while (   page < pageCount
+                       && memcmp(attributes + pageSource[page] * PageSize, attributes + high * PageSize, PageSize) != 0)
+                {
+                    ++page;
+                }
+
+                if (page == pageCount)
+                {
+                    pageSource[pageCount++] = high;
+                }
+                pageIndex[high] = (BYTE)page;
+            }
+
+            // The table is shared by all itemizations and lives as long as the process.
+            CharAttributeType* table = new CharAttributeType[PageSize + pageCount * PageSize];
+            memcpy(table, pageIndex, PageSize);
+            for (UINT32 page = 0; page < pageCount; ++page)
+            {
+                memcpy(table + PageSize + page * PageSize, attributes + pageSource[page] * PageSize, PageSize);
+            }
+
+            return table;
+        }
+        finally
+        {
+            delete[] attributes;
+        }
+    }
+
+    /// <SecurityNote>
+    /// Critical    - Receives pointers, arrays and their bounds as input.
+    /// </SecurityNote>
+    [SecurityCritical]
+    void CharAttributeTable::Classify(
+        __in_ecount(length) const WCHAR*        text,
+        UINT32                                  length,
+        IClassification^                        classificationUtility,
+        TextItemizer^                           textItemizer,
+        System::Globalization::CultureInfo^     numberCulture,
+        __out_ecount(length) CharAttributeType* pCharAttribute
+        )
+    {
+        // Text will never be of zero length. This is enforced by Itemize().
+        const CharAttributeType* table     = GetTable(classificationUtility);
+        const CharAttributeType* asciiPage = table + PageSize + table[0] * PageSize;
+
+        // Digits are only reported when there is a number culture.
+        CharAttributeType digitMask  = (numberCulture == nullptr) ? (CharAttributeType)CharAttribute::None : (CharAttributeType)IsDigit;
+        CharAttributeType digitState = (CharAttributeType)(Lookup(table, text[0]) & digitMask);
+        UINT32            digitRangeStart = 0;
+
+        for (UINT32 i = 0; i < length;)
+        {
+            // Latin text is mostly ASCII. Four code units are tested at once and, when they are all below
+            // U+0080 and do not change the digit state, they are classified straight from the first page.
+            if (   length - i >= 4
+                && ((*(UNALIGNED const UINT64*)(text + i)) & 0xFF80FF80FF80FF80) == 0)
+            {
+                CharAttributeType attributes0 = asciiPage[text[i]];
+                CharAttributeType attributes1 = asciiPage[text[i + 1]];
+                CharAttributeType attributes2 = asciiPage[text[i + 2]];
+                CharAttributeType attributes3 = asciiPage[text[i + 3]];
+
+                if (((  (attributes0 ^ digitState)
+                      | (attributes1 ^ digitState)
+                      | (attributes2 ^ digitState)
+                      | (attributes3 ^ digitState)) & digitMask) == 0)
+                {
+                    pCharAttribute[i]     = (CharAttributeType)(attributes0 & ~IsDigit);
+                    pCharAttribute[i + 1] = (CharAttributeType)(attributes1 & ~IsDigit);
+                    pCharAttribute[i + 2] = (CharAttributeType)(attributes2 & ~IsDigit);
+                    pCharAttribute[i + 3] = (CharAttributeType)(attributes3 & ~IsDigit);
+                    i += 4;
+                    continue;
+                }
+            }
+
+            CharAttributeType attributes = Lookup(table, text[i]);
+
+            CharAttributeType currentDigitState = (CharAttributeType)(attributes & digitMask);
+            if (currentDigitState != digitState)
+            {
+                textItemizer->SetIsDigit(digitRangeStart, i - digitRangeStart, digitState != 0);
+
+                digitRangeStart = i;
+                digitState      = currentDigitState;
+            }
+
+            // pCharAttribute is assumed to have the same length as text. This is enforced by Itemize().
+            pCharAttribute[i] = (CharAttributeType)(attributes & ~IsDigit);
+            ++i;
+        }
+
+        textItemizer->SetIsDigit(digitRangeStart, length - digitRangeStart, digitState != 0);
+    }
+
+}}}}//MS::Internal::Text::TextInterface
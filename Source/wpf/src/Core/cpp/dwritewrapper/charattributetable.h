@@ -0,0 +1,69 @@
+#ifndef __CHAR_ATTRIBUTE_TABLE_H
+#define __CHAR_ATTRIBUTE_TABLE_H
+
+#include "Common.h"
+#include "CharAttribute.h"
+#include "IClassification.h"
+#include "TextItemizer.h"
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+    /// <summary>
+    /// Native two level table of the CharAttribute of every UTF-16 code unit.
+    /// </summary>
+    /// <remarks>
+    /// The classification data lives in PresentationCore, which we cannot reference, so the table is
+    /// built once per process by querying IClassification for every code unit. The first level maps the
+    /// high byte of a code unit to one of the distinct 256 entry pages that make up the second level;
+    /// identical pages (most of the CJK and private use ranges) are stored only once.
+    /// </remarks>
+    private ref class CharAttributeTable sealed
+    {
+    private:
+
+        /// <summary>
+        /// Table only flag that marks the code units classified as digits.
+        /// It is never written to the CharAttribute arrays handed to the TextItemizer.
+        /// </summary>
+        literal CharAttributeType IsDigit = 0x40;
+
+        literal UINT32 PageSize = 256;
+
+        /// <SecurityNote>
+        /// Critical - Native table read with unchecked indices.
+        /// </SecurityNote>
+        [SecurityCritical]
+        static const CharAttributeType* _table     = NULL;
+        static Object^                  _tableLock = gcnew Object();
+
+        [SecurityCritical]
+        static const CharAttributeType* GetTable(IClassification^ classificationUtility);
+
+        [SecurityCritical]
+        static const CharAttributeType* BuildTable(IClassification^ classificationUtility);
+
+        static CharAttributeType Lookup(const CharAttributeType* table, WCHAR ch)
+        {
+            return table[PageSize + (table[ch >> 8] * PageSize) + (ch & 0xFF)];
+        }
+
+    internal:
+
+        /// <summary>
+        /// Fills the CharAttribute of every code unit of the text and, when numberCulture is
+        /// not null, reports the digit ranges of the text to the itemizer in the same pass.
+        /// </summary>
+        [SecurityCritical]
+        static void Classify(
+            __in_ecount(length) const WCHAR*        text,
+            UINT32                                  length,
+            IClassification^                        classificationUtility,
+            TextItemizer^                           textItemizer,
+            System::Globalization::CultureInfo^     numberCulture,
+            __out_ecount(length) CharAttributeType* pCharAttribute
+            );
+    };
+
+}}}}//MS::Internal::Text::TextInterface
+
+#endif //__CHAR_ATTRIBUTE_TABLE_H
@@ -181,6 +181,44 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         return glyphCount;
     }
 
+    /// <SecurityNote>
+    /// Critical - Uses security critical member _fontFace.
+    /// </SecurityNote>
+    [SecurityCritical]
+    array<GlyphMetrics>^ FontFace::GetDesignGlyphMetricsCache()
+    {
+        array<GlyphMetrics>^ designGlyphMetricsCache = _designGlyphMetricsCache;
+        if (designGlyphMetricsCache == nullptr)
+        {
+            UINT16 glyphCount       = GlyphCount;
+            UINT16 cachedGlyphCount = (glyphCount < DesignGlyphMetricsCacheSize) ? glyphCount : DesignGlyphMetricsCacheSize;
+
+            designGlyphMetricsCache = gcnew array<GlyphMetrics>(cachedGlyphCount);
+            if (cachedGlyphCount > 0)
+            {
+                UINT16 glyphIndices[DesignGlyphMetricsCacheSize];
+                for (UINT16 i = 0; i < cachedGlyphCount; ++i)
+                {
+                    glyphIndices[i] = i;
+                }
+
+                pin_ptr<GlyphMetrics> pDesignGlyphMetricsCache = &designGlyphMetricsCache[0];
+                HRESULT hr = _fontFace->Value->GetDesignGlyphMetrics(
+                                                              glyphIndices,
+                                                              cachedGlyphCount,
+                                                              reinterpret_cast<DWRITE_GLYPH_METRICS *>(pDesignGlyphMetricsCache)
+                                                              );
+
+                System::GC::KeepAlive(_fontFace);
+                ConvertHresultToException(hr, "array<GlyphMetrics>^ FontFace::GetDesignGlyphMetricsCache");
+            }
+
+            // Threads racing to fill the cache compute the same metrics, so whichever is published last is fine.
+            _designGlyphMetricsCache = designGlyphMetricsCache;
+        }
+        return designGlyphMetricsCache;
+    }
+
     /// <SecurityNote>
     /// Critical - Uses security critical member _fontFace.
     ///            Receives a native pointer as an argument.
@@ -193,6 +231,25 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         __out_ecount(glyphCount) GlyphMetrics *pGlyphMetrics
         )
     {      
+        // Runs mostly use the first glyphs of the font, whose metrics are served from the cache.
+        array<GlyphMetrics>^ designGlyphMetricsCache = GetDesignGlyphMetricsCache();
+
+        UINT32 cachedGlyphCount = 0;
+        while (   cachedGlyphCount < glyphCount
+               && pGlyphIndices[cachedGlyphCount] < (UINT32)designGlyphMetricsCache->Length)
+        {
+            ++cachedGlyphCount;
+        }
+
+        if (cachedGlyphCount == glyphCount)
+        {
+            for (UINT32 i = 0; i < glyphCount; ++i)
+            {
+                pGlyphMetrics[i] = designGlyphMetricsCache[pGlyphIndices[i]];
+            }
+            return;
+        }
+
         HRESULT hr = _fontFace->Value->GetDesignGlyphMetrics(
                                                       pGlyphIndices,
                                                       glyphCount,
@@ -204,6 +261,61 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         ConvertHresultToException(hr, "array<GlyphMetrics^>^ FontFace::GetDesignGlyphMetrics");
     }
 
+    /// <SecurityNote>
+    /// Critical - Calls critical GetDesignGlyphMetrics.
+    ///            Receives native pointers as arguments.
+    /// </SecurityNote>
+    [SecurityCritical]
+    void FontFace::GetDesignGlyphMetricsAndBounds(
+        __in_ecount(glyphCount) const UINT16 *pGlyphIndices,
+        UINT32 glyphCount,
+        __out_ecount_opt(glyphCount) GlyphMetrics *pGlyphMetrics,
+        __out_ecount_opt(glyphCount) UINT32 *pAdvanceWidths,
+        __out_ecount_opt(glyphCount) GlyphBounds *pGlyphBounds
+        )
+    {
+        // When the caller does not want the metrics themselves they are
+        // obtained in chunks on the stack instead of in a heap buffer.
+        const UINT32 chunkSize = 64;
+        DWRITE_GLYPH_METRICS chunkGlyphMetrics[chunkSize];
+
+        UINT32 count = 0;
+        for (UINT32 start = 0; start < glyphCount; start += count)
+        {
+            GlyphMetrics* pMetrics;
+            if (pGlyphMetrics != NULL)
+            {
+                count    = glyphCount;
+                pMetrics = pGlyphMetrics;
+            }
+            else
+            {
+                count    = (glyphCount - start < chunkSize) ? glyphCount - start : chunkSize;
+                pMetrics = reinterpret_cast<GlyphMetrics*>(chunkGlyphMetrics);
+            }
+
+            GetDesignGlyphMetrics(pGlyphIndices + start, count, pMetrics);
+
+            for (UINT32 i = 0; i < count; ++i)
+            {
+                if (pAdvanceWidths != NULL)
+                {
+                    pAdvanceWidths[start + i] = pMetrics[i].AdvanceWidth;
+                }
+
+                if (pGlyphBounds != NULL)
+                {
+                    // Vertical bearings are measured from the vertical origin, VerticalOriginY above the baseline.
+                    GlyphBounds* pBounds = pGlyphBounds + start + i;
+                    pBounds->Left   = pMetrics[i].LeftSideBearing;
+                    pBounds->Right  = (INT32)pMetrics[i].AdvanceWidth - pMetrics[i].RightSideBearing;
+                    pBounds->Top    = pMetrics[i].VerticalOriginY - pMetrics[i].TopSideBearing;
+                    pBounds->Bottom = pMetrics[i].VerticalOriginY - (INT32)pMetrics[i].AdvanceHeight + pMetrics[i].BottomSideBearing;
+                }
+            }
+        }
+    }
+
     /// <SecurityNote>
     /// Critical - Uses security critical member _fontFace.
     ///            Receives a native pointer as an argument.
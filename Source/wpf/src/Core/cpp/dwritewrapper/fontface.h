@@ -10,6 +10,7 @@
 #include "FontStretch.h"
 #include "FontMetrics.h"
 #include "GlyphMetrics.h"
+#include "GlyphBounds.h"
 #include "DWriteMatrix.h"
 #include "OpenTypeTableTag.h"
 #include "NativePointerWrapper.h"
@@ -50,6 +51,20 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
             /// </remarks>
             int _refCount;
 
+            /// <summary>
+            /// Design metrics of the first glyphs of the font, which hold the most frequently used
+            /// glyphs of most fonts. Lazily allocated on the first design metrics request.
+            /// </summary>
+            array<GlyphMetrics>^ _designGlyphMetricsCache;
+
+            /// <summary>
+            /// Number of glyphs whose design metrics are cached.
+            /// </summary>
+            literal UINT16 DesignGlyphMetricsCacheSize = 256;
+
+            [SecurityCritical]
+            array<GlyphMetrics>^ GetDesignGlyphMetricsCache();
+
         internal:
 
             /// <summary>
@@ -179,6 +194,23 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                 __out_ecount(glyphCount) GlyphMetrics *pGlyphMetrics
                 );
 
+            /// <summary>
+            /// Obtains the design metrics, advance widths and black boxes of an array of glyphs in font design units,
+            /// in a single call. Any of the output arrays may be NULL.
+            /// </summary>
+            /// <param name="pGlyphIndices">An array of glyph indices to compute the metrics for.</param>
+            /// <param name="pGlyphMetrics">Receives the design metrics of every glyph.</param>
+            /// <param name="pAdvanceWidths">Receives the advance width of every glyph.</param>
+            /// <param name="pGlyphBounds">Receives the black box of every glyph.</param>
+            [SecurityCritical]
+            void GetDesignGlyphMetricsAndBounds(
+                __in_ecount(glyphCount) const UINT16 *pGlyphIndices,
+                UINT32 glyphCount,
+                __out_ecount_opt(glyphCount) GlyphMetrics *pGlyphMetrics,
+                __out_ecount_opt(glyphCount) UINT32 *pAdvanceWidths,
+                __out_ecount_opt(glyphCount) GlyphBounds *pGlyphBounds
+                );
+
             [SecurityCritical]
             void GetDisplayGlyphMetrics(
                 __in_ecount(glyphCount) const UINT16 *pGlyphIndices,
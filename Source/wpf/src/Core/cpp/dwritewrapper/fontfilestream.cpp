@@ -12,7 +12,8 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         // fontSource->GetUnmanagedStream() which returns a copy of the content of the stream. Special casing XPS will not
         // guarantee that this problem will be fixed so we will use the GetUnmanagedStream(). Note: This path will only 
         // be taken for embedded fonts among which XPS is a main scenario. For local fonts we use DWrite's APIs.
-        _fontSourceStream = fontSource->GetUnmanagedStream();
+        // The content is shared by all the streams DWrite opens on the same font, see FontFileView.
+        _fontFileView = FontFileView::Acquire(fontSource);
         try
         {
             _lastWriteTime = fontSource->GetLastWriteTimeUtc().ToFileTimeUtc();
@@ -21,18 +22,19 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         {
             _lastWriteTime = -1;
         }        
-
-        // Create lock to control access to font source stream.
-        _fontSourceStreamLock = gcnew Object();
     }
 
     FontFileStream::~FontFileStream()
     {
-        _fontSourceStream->Close();
+        if (_fontFileView != nullptr)
+        {
+            _fontFileView->Release();
+            _fontFileView = nullptr;
+        }
     }
 
     /// <SecurityNote>
-    /// Critical - Calls critical CreateGarbageCollectorHandleNativeWrapper
+    /// Critical - Returns a pointer to critical font file data.
     /// </SecurityNote>
     [System::Security::SecurityCritical]
     [ComVisible(true)]
@@ -43,75 +45,32 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         __out void** fragmentContext
         )
     {
-        HRESULT hr = S_OK;
-        try
+        if (fragmentContext == NULL || fragmentStart == NULL)
         {
-            if(
-                fragmentContext == NULL || fragmentStart == NULL
-                ||
-                fileOffset   > long::MaxValue                    // Cannot safely cast to long
-                ||            
-                fragmentSize > int::MaxValue                     // fragment size cannot be casted to int
-                || 
-                fileOffset > UINT64_MAX - fragmentSize           // make sure next sum doesn't overflow
-                || 
-                fileOffset + fragmentSize  > (UINT64)_fontSourceStream->Length // reading past the end of the Stream
-              ) 
-            {
-                return E_INVALIDARG;
-            }
-
-            int fragmentSizeInt = (int)fragmentSize;
-            array<byte>^ buffer = gcnew array<byte>(fragmentSizeInt);
-            
-            // DWrite may call this method from multiple threads. We need to ensure thread safety by making Seek and Read atomic.
-            System::Threading::Monitor::Enter(_fontSourceStreamLock);
-            try
-            {
-                _fontSourceStream->Seek(fileOffset, //long
-                                        System::IO::SeekOrigin::Begin);
-
-                _fontSourceStream->Read(buffer,         //byte[]
-                                        0,              //int
-                                        fragmentSizeInt //int
-                                        );
-            }
-            finally 
-            {
-                System::Threading::Monitor::Exit(_fontSourceStreamLock);
-            }
-
-            GCHandle gcHandle = GCHandle::Alloc(buffer, GCHandleType::Pinned);
-
-            *fragmentStart = (byte*)(gcHandle.AddrOfPinnedObject().ToPointer());
-            
-            *fragmentContext = GCHandle::ToIntPtr(gcHandle).ToPointer();
+            return E_INVALIDARG;
         }
-        catch(System::Exception^ exception)
+
+        // The view is immutable and stays mapped for the lifetime of this stream, so DWrite
+        // can read fragments from any thread without copying, locking or pinning.
+        const void* fragment = (_fontFileView != nullptr) ? _fontFileView->GetFragment(fileOffset, fragmentSize) : NULL;
+        if (fragment == NULL) // reading past the end of the file
         {
-            hr = System::Runtime::InteropServices::Marshal::GetHRForException(exception);
+            return E_INVALIDARG;
         }
 
-        return hr;
+        *fragmentStart   = fragment;
+        *fragmentContext = NULL;
+
+        return S_OK;
     }
 
-    /// <SecurityNote>
-    /// Critical - Asserts unmanaged code permission to call GCHandle::FromIntPtr
-    ///            Frees a GCHandle based on the passed in pointer so the pointer 
-    ///            passed in must be trusted.
-    /// </SecurityNote>
-    [System::Security::SecurityCritical]
-    [System::Security::Permissions::SecurityPermission(System::Security::Permissions::SecurityAction::Assert, UnmanagedCode=true)]
     [ComVisible(true)]
     void FontFileStream::ReleaseFileFragment(
         void* fragmentContext
         )
     {
-        if (fragmentContext != NULL)
-        {
-            GCHandle gcHandle = GCHandle::FromIntPtr(IntPtr(fragmentContext));
-            gcHandle.Free();
-        }
+        // Fragments point into the shared view of the font file and have nothing to release.
+        Debug::Assert(fragmentContext == NULL);
     }
 
     /// <SecurityNote>
@@ -132,7 +91,11 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         HRESULT hr = S_OK;
         try
         {
-            *fileSize = _fontSourceStream->Length;
+            if (_fontFileView == nullptr)
+            {
+                throw gcnew ObjectDisposedException(nullptr);
+            }
+            *fileSize = _fontFileView->Size;
         }
         catch(System::Exception^ exception)
         {
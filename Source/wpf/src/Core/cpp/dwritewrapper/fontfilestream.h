@@ -4,6 +4,7 @@
 #include "IFontSource.h"
 #include "Common.h"
 #include "DWriteInterfaces.h"
+#include "FontFileView.h"
 
 using namespace System;
 using namespace System::IO;
@@ -20,9 +21,8 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
             /// <SecurityNote>
             /// SecurityCritical : Critical Font file data.
             /// </SecurityNote>
-            Stream^                            _fontSourceStream;
+            FontFileView^                      _fontFileView;
             INT64                              _lastWriteTime;
-            Object^                            _fontSourceStreamLock;
 
         public:
 
@@ -37,7 +37,7 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
             FontFileStream(IFontSource^ fontSource);
 
             /// <summary>
-            /// destructor. Closes the managed Input Stream.
+            /// destructor. Releases the shared view of the font file.
             /// </summary>
             ~FontFileStream();
 
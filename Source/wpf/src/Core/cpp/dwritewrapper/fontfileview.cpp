@@ -0,0 +1,117 @@
+#include "FontFileView.h"
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+    FontFileView::FontFileView(UnmanagedMemoryStream^ fontSourceStream, DateTime lastWriteTime)
+    {
+        // GetUnmanagedStream() returns either a mapping of the font file or a copy of the font
+        // in pinned memory, so the content stays at the same address until the stream is closed.
+        _fontSourceStream = fontSourceStream;
+        _fontSourceStream->Seek(0, System::IO::SeekOrigin::Begin);
+        _fontData         = _fontSourceStream->PositionPointer;
+        _fontDataSize     = _fontSourceStream->Length;
+        _lastWriteTime    = lastWriteTime;
+        _streamCount      = 0;
+    }
+
+    FontFileView^ FontFileView::Acquire(IFontSource^ fontSource)
+    {
+        // Views are shared by every caller in the process, so the caller has to pass the
+        // same demand here that GetUnmanagedStream makes when the view is created.
+        fontSource->DemandFileIOPermission();
+
+        String^  key           = fontSource->Uri->AbsoluteUri;
+        DateTime lastWriteTime = fontSource->GetLastWriteTimeUtc();
+
+        System::Threading::Monitor::Enter(_viewsLock);
+        try
+        {
+            FontFileView^ view = nullptr;
+
+            WeakReference^ weakView;
+            if (_views->TryGetValue(key, weakView))
+            {
+                view = safe_cast<FontFileView^>(weakView->Target);
+            }
+
+            // A font that was written since its view was created gets a new view. Streams
+            // still using the old one keep it alive until they are done with it.
+            if (view == nullptr || view->_lastWriteTime != lastWriteTime)
+            {
+                if (_views->Count >= MaximumViewCount)
+                {
+                    PruneViews();
+                }
+
+                view = gcnew FontFileView(fontSource->GetUnmanagedStream(), lastWriteTime);
+                _views[key] = gcnew WeakReference(view);
+            }
+
+            view->_streamCount++;
+            return view;
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(_viewsLock);
+        }
+    }
+
+    void FontFileView::Release()
+    {
+        System::Threading::Monitor::Enter(_viewsLock);
+        try
+        {
+            Debug::Assert(_streamCount > 0);
+
+            if (--_streamCount == 0)
+            {
+                // Only unregister the entry if it still refers to this view.
+                for each (KeyValuePair<String^, WeakReference^> entry in _views)
+                {
+                    if (entry.Value->Target == this)
+                    {
+                        _views->Remove(entry.Key);
+                        break;
+                    }
+                }
+
+                _fontSourceStream->Close();
+                _fontData     = NULL;
+                _fontDataSize = 0;
+            }
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(_viewsLock);
+        }
+    }
+
+    void FontFileView::PruneViews()
+    {
+        List<String^>^ deadKeys = gcnew List<String^>();
+        for each (KeyValuePair<String^, WeakReference^> entry in _views)
+        {
+            if (!entry.Value->IsAlive)
+            {
+                deadKeys->Add(entry.Key);
+            }
+        }
+
+        for each (String^ key in deadKeys)
+        {
+            _views->Remove(key);
+        }
+    }
+
+    const void* FontFileView::GetFragment(UINT64 fileOffset, UINT64 fragmentSize)
+    {
+        if (   _fontData == NULL
+            || fileOffset > _fontDataSize                   // fragment starts past the end of the file
+            || fragmentSize > _fontDataSize - fileOffset)   // fragment ends past the end of the file
+        {
+            return NULL;
+        }
+
+        return _fontData + fileOffset;
+    }
+}}}}//MS::Internal::Text::TextInterface
@@ -0,0 +1,84 @@
+#ifndef __FONTFILEVIEW_H
+#define __FONTFILEVIEW_H
+
+#include "IFontSource.h"
+#include "Common.h"
+
+using namespace System;
+using namespace System::IO;
+using namespace System::Collections::Generic;
+using namespace System::Diagnostics;
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+    /// <summary>
+    /// An immutable native view of the content of a font file. The content is mapped (or, for
+    /// non file fonts, read) once per font Uri and last write time and shared by every FontFileStream
+    /// opened on it, so fragments are handed out to DWrite as pointers into the view without copying
+    /// or locking.
+    /// </summary>
+    [SecurityCritical(SecurityCriticalScope::Everything)]
+    private ref class FontFileView sealed
+    {
+        private:
+            /// <SecurityNote>
+            /// SecurityCritical : Critical Font file data.
+            /// </SecurityNote>
+            UnmanagedMemoryStream^             _fontSourceStream;
+            const unsigned char*               _fontData;
+            UINT64                             _fontDataSize;
+            DateTime                           _lastWriteTime;
+            int                                _streamCount;
+
+            /// <summary>
+            /// Views that may still be in use, keyed by the absolute Uri of the font. Streams created by DWrite
+            /// are released through COM and are not always disposed, so the views are held weakly and a view
+            /// that is no longer referenced by any stream is left to the finalizer of its underlying stream.
+            /// </summary>
+            static Dictionary<String^, WeakReference^>^ _views     = gcnew Dictionary<String^, WeakReference^>();
+            static Object^                              _viewsLock = gcnew Object();
+
+            /// <summary>
+            /// Number of registered views above which dead entries are pruned before adding another.
+            /// </summary>
+            literal int MaximumViewCount = 64;
+
+            FontFileView(UnmanagedMemoryStream^ fontSourceStream, DateTime lastWriteTime);
+
+            static void PruneViews();
+
+        public:
+
+            /// <summary>
+            /// Returns the shared view of the given font source, creating it if the font is not already in use
+            /// or has been written since its view was created. Demands read access to the font file even when
+            /// the view already exists.
+            /// </summary>
+            static FontFileView^ Acquire(IFontSource^ fontSource);
+
+            /// <summary>
+            /// Releases a reference obtained from Acquire. The font data is unmapped when every reference
+            /// has been released. FontFileStream only calls this from its destructor, which does not run for
+            /// the streams DWrite releases through COM; the views of those streams are cleaned up by the
+            /// garbage collector, which finalizes the underlying stream once no stream references the view.
+            /// </summary>
+            void Release();
+
+            /// <summary>
+            /// Returns a pointer to the fragment at the given offset, or NULL if the fragment
+            /// is not within the bounds of the font file.
+            /// </summary>
+            const void* GetFragment(UINT64 fileOffset, UINT64 fragmentSize);
+
+            property UINT64 Size
+            {
+                UINT64 get()
+                {
+                    return _fontDataSize;
+                }
+            }
+    };
+}}}}//MS::Internal::Text::TextInterface
+
+
+#endif //__FONTFILEVIEW_H
@@ -0,0 +1,21 @@
+#ifndef __GLYPH_BOUNDS_H
+#define __GLYPH_BOUNDS_H
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+
+    /// <summary>
+    /// The black box of a glyph in font design units, relative to the glyph origin
+    /// on the baseline with the Y axis pointing up.
+    /// </summary>
+    private value struct GlyphBounds
+    {
+        INT32 Left;
+        INT32 Top;
+        INT32 Right;
+        INT32 Bottom;
+    };
+
+}}}}//MS::Internal::Text::TextInterface
+
+#endif //__GLYPH_BOUNDS_H
@@ -21,6 +21,7 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
     private interface class IFontSource
     {
         void                                TestFileOpenable();
+        void                                DemandFileIOPermission();
         System::IO::UnmanagedMemoryStream ^ GetUnmanagedStream();
         System::DateTime                    GetLastWriteTimeUtc();
         property System::Uri^ Uri
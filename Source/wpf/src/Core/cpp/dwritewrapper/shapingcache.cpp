@@ -0,0 +1,517 @@
+#include "ShapingCache.h"
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+    inline UINT32 CombineShapingHash(UINT32 hash, UINT32 value)
+    {
+        // FNV-1a, one 32 bit value at a time.
+        return (hash ^ value) * 16777619;
+    }
+
+    // Callers assert unmanaged code permission to allocate the native block.
+    TypographicFeatureRanges* TypographicFeatureRanges::Create(
+        array<array<DWriteFontFeature>^>^ features,
+        array<UINT32>^                    featureRangeLengths
+        )
+    {
+        if (features == nullptr)
+        {
+            return NULL;
+        }
+
+        UINT32 rangeCount   = (UINT32)featureRangeLengths->Length;
+        UINT32 featureCount = 0;
+        for (UINT32 i = 0; i < rangeCount; ++i)
+        {
+            featureCount += (UINT32)features[i]->Length;
+        }
+
+        // The block is laid out in decreasing order of alignment.
+        size_t size = sizeof(TypographicFeatureRanges)
+                    + rangeCount   * sizeof(DWRITE_TYPOGRAPHIC_FEATURES*)
+                    + rangeCount   * sizeof(DWRITE_TYPOGRAPHIC_FEATURES)
+                    + rangeCount   * sizeof(UINT32)
+                    + featureCount * sizeof(DWRITE_FONT_FEATURE);
+
+        BYTE* data = new BYTE[size];
+
+        TypographicFeatureRanges* featureRanges = reinterpret_cast<TypographicFeatureRanges*>(data);
+        featureRanges->RangeCount   = rangeCount;
+        featureRanges->FeatureCount = featureCount;
+        featureRanges->Ranges       = reinterpret_cast<DWRITE_TYPOGRAPHIC_FEATURES**>(featureRanges + 1);
+
+        DWRITE_TYPOGRAPHIC_FEATURES* ranges = reinterpret_cast<DWRITE_TYPOGRAPHIC_FEATURES*>(featureRanges->Ranges + rangeCount);
+        featureRanges->RangeLengths         = reinterpret_cast<UINT32*>(ranges + rangeCount);
+        DWRITE_FONT_FEATURE* fontFeatures   = reinterpret_cast<DWRITE_FONT_FEATURE*>(featureRanges->RangeLengths + rangeCount);
+
+        for (UINT32 i = 0; i < rangeCount; ++i)
+        {
+            array<DWriteFontFeature>^ rangeFeatures = features[i];
+
+            featureRanges->Ranges[i]       = ranges + i;
+            featureRanges->RangeLengths[i] = featureRangeLengths[i];
+            ranges[i].features             = fontFeatures;
+            ranges[i].featureCount         = (UINT32)rangeFeatures->Length;
+
+            for (int j = 0; j < rangeFeatures->Length; ++j)
+            {
+                fontFeatures[j].nameTag   = (DWRITE_FONT_FEATURE_TAG)rangeFeatures[j].nameTag;
+                fontFeatures[j].parameter = rangeFeatures[j].parameter;
+            }
+            fontFeatures += rangeFeatures->Length;
+        }
+
+        return featureRanges;
+    }
+
+    // Callers assert unmanaged code permission to delete the native block.
+    void TypographicFeatureRanges::Destroy(TypographicFeatureRanges* featureRanges)
+    {
+        if (featureRanges != NULL)
+        {
+            delete[] reinterpret_cast<BYTE*>(featureRanges);
+        }
+    }
+
+    UINT32 TypographicFeatureRanges::Hash(
+        array<array<DWriteFontFeature>^>^ features,
+        array<UINT32>^                    featureRangeLengths,
+        UINT32                            hash
+        )
+    {
+        if (features != nullptr)
+        {
+            for (int i = 0; i < featureRangeLengths->Length; ++i)
+            {
+                array<DWriteFontFeature>^ rangeFeatures = features[i];
+
+                hash = CombineShapingHash(hash, featureRangeLengths[i]);
+                hash = CombineShapingHash(hash, (UINT32)rangeFeatures->Length);
+                for (int j = 0; j < rangeFeatures->Length; ++j)
+                {
+                    hash = CombineShapingHash(hash, (UINT32)rangeFeatures[j].nameTag);
+                    hash = CombineShapingHash(hash, rangeFeatures[j].parameter);
+                }
+            }
+        }
+        return hash;
+    }
+
+    bool TypographicFeatureRanges::Matches(
+        array<array<DWriteFontFeature>^>^ features,
+        array<UINT32>^                    featureRangeLengths
+        ) const
+    {
+        if (features == nullptr || RangeCount != (UINT32)featureRangeLengths->Length)
+        {
+            return false;
+        }
+
+        for (UINT32 i = 0; i < RangeCount; ++i)
+        {
+            array<DWriteFontFeature>^ rangeFeatures = features[i];
+            DWRITE_TYPOGRAPHIC_FEATURES* range      = Ranges[i];
+
+            if (   RangeLengths[i] != featureRangeLengths[i]
+                || range->featureCount != (UINT32)rangeFeatures->Length)
+            {
+                return false;
+            }
+
+            for (UINT32 j = 0; j < range->featureCount; ++j)
+            {
+                if (   range->features[j].nameTag   != (DWRITE_FONT_FEATURE_TAG)rangeFeatures[j].nameTag
+                    || range->features[j].parameter != rangeFeatures[j].parameter)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Reads native text through the key.
+    /// </SecurityNote>
+    [SecurityCritical]
+    bool ShapingCache::Entry::Matches(ShapingCacheKey% key)
+    {
+        // Entries are only compared with keys of the same hash.
+        if (   SourceFont    != key.SourceFont
+            || TextLength    != key.TextLength
+            || Script        != key.Script
+            || Shapes        != key.Shapes
+            || IsSideways    != key.IsSideways
+            || IsRightToLeft != key.IsRightToLeft
+            || !String::Equals(LocaleName, key.LocaleName)
+            || memcmp(Text, key.Text, TextLength * sizeof(WCHAR)) != 0)
+        {
+            return false;
+        }
+
+        if (FeatureRanges == NULL)
+        {
+            return key.Features == nullptr;
+        }
+        return FeatureRanges->Matches(key.Features, key.FeatureRangeLengths);
+    }
+
+    /// <SecurityNote>
+    /// Critical - Receives native pointers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    bool ShapingCache::TryCreateKey(
+        __in_ecount(textLength) const WCHAR* text,
+        UINT32                               textLength,
+        Font^                                font,
+        bool                                 isSideways,
+        bool                                 isRightToLeft,
+        String^                              localeName,
+        array<array<DWriteFontFeature>^>^    features,
+        array<UINT32>^                       featureRangeLengths,
+        __in const DWRITE_SCRIPT_ANALYSIS*   scriptAnalysis,
+        void*                                numberSubstitution,
+        [System::Runtime::InteropServices::Out] ShapingCacheKey% key
+        )
+    {
+        if (textLength == 0 || textLength > MaximumTextLength)
+        {
+            return false;
+        }
+
+        UINT32 hash = 2166136261;
+        for (UINT32 i = 0; i < textLength; ++i)
+        {
+            // The glyphs of digits depend on the number substitution, which is not part of the key.
+            if (numberSubstitution != NULL && text[i] >= L'0' && text[i] <= L'9')
+            {
+                return false;
+            }
+            hash = CombineShapingHash(hash, text[i]);
+        }
+
+        hash = CombineShapingHash(hash, (UINT32)System::Runtime::CompilerServices::RuntimeHelpers::GetHashCode(font));
+        hash = CombineShapingHash(hash, (UINT32)localeName->GetHashCode());
+        hash = CombineShapingHash(hash, scriptAnalysis->script);
+        hash = CombineShapingHash(hash, scriptAnalysis->shapes);
+        hash = CombineShapingHash(hash, (isSideways ? 1 : 0) | (isRightToLeft ? 2 : 0));
+        hash = TypographicFeatureRanges::Hash(features, featureRangeLengths, hash);
+
+        key.Text                = text;
+        key.TextLength          = textLength;
+        key.SourceFont          = font;
+        key.LocaleName          = localeName;
+        key.Features            = features;
+        key.FeatureRangeLengths = featureRangeLengths;
+        key.Script              = scriptAnalysis->script;
+        key.Shapes              = scriptAnalysis->shapes;
+        key.IsSideways          = isSideways;
+        key.IsRightToLeft       = isRightToLeft;
+        key.Hash                = hash;
+        return true;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Asserts unmanaged code permission to allocate a native buffer.
+    /// </SecurityNote>
+    [SecurityCritical]
+    [SecurityPermission(SecurityAction::Assert, UnmanagedCode=true)]
+    ShapingCache::Entry^ ShapingCache::CreateEntry(
+        ShapingCacheKey%            key,
+        UINT32                      hash,
+        UINT32                      glyphCount,
+        bool                        hasPlacements,
+        TypographicFeatureRanges*   featureRanges
+        )
+    {
+        // Text, cluster map, text properties, glyph indices and glyph properties are 16 bit values;
+        // the placements that follow them need 32 bit alignment.
+        size_t shortCount = 3 * key.TextLength + 2 * glyphCount;
+        size_t shortSize  = (shortCount * sizeof(UINT16) + 3) & ~(size_t)3;
+        size_t size       = shortSize;
+        if (hasPlacements)
+        {
+            size += glyphCount * (sizeof(FLOAT) + sizeof(DWRITE_GLYPH_OFFSET));
+        }
+
+        Entry^ entry = gcnew Entry();
+        entry->Hash          = hash;
+        entry->SourceFont    = key.SourceFont;
+        entry->LocaleName    = key.LocaleName;
+        entry->Script        = key.Script;
+        entry->Shapes        = key.Shapes;
+        entry->IsSideways    = key.IsSideways;
+        entry->IsRightToLeft = key.IsRightToLeft;
+        entry->TextLength    = key.TextLength;
+        entry->GlyphCount    = glyphCount;
+
+        entry->Data          = new BYTE[size];
+        entry->FeatureRanges = featureRanges;
+        entry->Text          = reinterpret_cast<WCHAR*>(entry->Data);
+        entry->ClusterMap    = reinterpret_cast<UINT16*>(entry->Text + key.TextLength);
+        entry->TextProps     = entry->ClusterMap + key.TextLength;
+        entry->GlyphIndices  = entry->TextProps + key.TextLength;
+        entry->GlyphProps    = entry->GlyphIndices + glyphCount;
+        if (hasPlacements)
+        {
+            entry->GlyphAdvances = reinterpret_cast<FLOAT*>(entry->Data + shortSize);
+            entry->GlyphOffsets  = reinterpret_cast<DWRITE_GLYPH_OFFSET*>(entry->GlyphAdvances + glyphCount);
+        }
+
+        memcpy(entry->Text, key.Text, key.TextLength * sizeof(WCHAR));
+        return entry;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Takes ownership of the native buffers of the entry.
+    /// </SecurityNote>
+    [SecurityCritical]
+    void ShapingCache::AddEntry(Dictionary<UINT32, Entry^>^ entries, Entry^ entry)
+    {
+        // Runs that were shaped once are rarely shaped again much later,
+        // so the cache is simply dropped when it outgrows its limit.
+        if (entries->Count >= MaximumEntryCount)
+        {
+            DeleteEntries(entries);
+        }
+
+        Entry^ next;
+        if (entries->TryGetValue(entry->Hash, next))
+        {
+            entry->Next = next;
+        }
+        entries[entry->Hash] = entry;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Asserts unmanaged code permission to delete native buffers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    [SecurityPermission(SecurityAction::Assert, UnmanagedCode=true)]
+    void ShapingCache::DeleteEntries(Dictionary<UINT32, Entry^>^ entries)
+    {
+        for each (Entry^ entry in entries->Values)
+        {
+            for (; entry != nullptr; entry = entry->Next)
+            {
+                TypographicFeatureRanges::Destroy(entry->FeatureRanges);
+                delete[] entry->Data;
+
+                entry->FeatureRanges = NULL;
+                entry->Data          = NULL;
+            }
+        }
+        entries->Clear();
+    }
+
+    /// <SecurityNote>
+    /// Critical - Receives native pointers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    bool ShapingCache::TryGetGlyphs(
+        ShapingCacheKey%                        key,
+        UINT32                                  maxGlyphCount,
+        __out_ecount(key.TextLength) UINT16*    clusterMap,
+        __out_ecount(key.TextLength) UINT16*    textProps,
+        __out_ecount(maxGlyphCount) UINT16*     glyphIndices,
+        __out_ecount(maxGlyphCount) UINT16*     glyphProps,
+        [System::Runtime::InteropServices::Out] UINT32% glyphCount
+        )
+    {
+        System::Threading::Monitor::Enter(_glyphs);
+        try
+        {
+            Entry^ entry;
+            if (_glyphs->TryGetValue(key.Hash, entry))
+            {
+                for (; entry != nullptr; entry = entry->Next)
+                {
+                    if (entry->Matches(key))
+                    {
+                        glyphCount = entry->GlyphCount;
+                        if (entry->GlyphCount <= maxGlyphCount)
+                        {
+                            memcpy(clusterMap,   entry->ClusterMap,   key.TextLength    * sizeof(UINT16));
+                            memcpy(textProps,    entry->TextProps,    key.TextLength    * sizeof(UINT16));
+                            memcpy(glyphIndices, entry->GlyphIndices, entry->GlyphCount * sizeof(UINT16));
+                            memcpy(glyphProps,   entry->GlyphProps,   entry->GlyphCount * sizeof(UINT16));
+                        }
+                        return true;
+                    }
+                }
+            }
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(_glyphs);
+        }
+        return false;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Receives native pointers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    void ShapingCache::AddGlyphs(
+        ShapingCacheKey%                        key,
+        TypographicFeatureRanges*               featureRanges,
+        __in_ecount(key.TextLength) UINT16 const* clusterMap,
+        __in_ecount(key.TextLength) UINT16 const* textProps,
+        __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+        __in_ecount(glyphCount) UINT16 const*   glyphProps,
+        UINT32                                  glyphCount
+        )
+    {
+        Entry^ entry = CreateEntry(key, key.Hash, glyphCount, false, featureRanges);
+
+        memcpy(entry->ClusterMap,   clusterMap,   key.TextLength * sizeof(UINT16));
+        memcpy(entry->TextProps,    textProps,    key.TextLength * sizeof(UINT16));
+        memcpy(entry->GlyphIndices, glyphIndices, glyphCount     * sizeof(UINT16));
+        memcpy(entry->GlyphProps,   glyphProps,   glyphCount     * sizeof(UINT16));
+
+        System::Threading::Monitor::Enter(_glyphs);
+        try
+        {
+            AddEntry(_glyphs, entry);
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(_glyphs);
+        }
+    }
+
+    [SecurityCritical]
+    UINT32 ShapingCache::HashPlacements(
+        ShapingCacheKey%                        key,
+        __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+        UINT32                                  glyphCount,
+        FLOAT                                   fontEmSize,
+        float                                   pixelsPerDip,
+        TextFormattingMode                      textFormattingMode
+        )
+    {
+        UINT32 hash = key.Hash;
+        for (UINT32 i = 0; i < glyphCount; ++i)
+        {
+            hash = CombineShapingHash(hash, glyphIndices[i]);
+        }
+        hash = CombineShapingHash(hash, *reinterpret_cast<UINT32*>(&fontEmSize));
+        hash = CombineShapingHash(hash, *reinterpret_cast<UINT32*>(&pixelsPerDip));
+        hash = CombineShapingHash(hash, (UINT32)textFormattingMode);
+        return hash;
+    }
+
+    [SecurityCritical]
+    bool ShapingCache::MatchesPlacements(
+        Entry^                                  entry,
+        __in_ecount(entry->TextLength) UINT16 const* clusterMap,
+        __in_ecount(entry->TextLength) UINT16 const* textProps,
+        __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+        __in_ecount(glyphCount) UINT16 const*   glyphProps,
+        UINT32                                  glyphCount,
+        FLOAT                                   fontEmSize,
+        float                                   pixelsPerDip,
+        TextFormattingMode                      textFormattingMode
+        )
+    {
+        return entry->GlyphCount     == glyphCount
+            && entry->FontEmSize     == fontEmSize
+            && entry->PixelsPerDip   == pixelsPerDip
+            && entry->FormattingMode == textFormattingMode
+            && memcmp(entry->GlyphIndices, glyphIndices, glyphCount * sizeof(UINT16)) == 0
+            && memcmp(entry->GlyphProps,   glyphProps,   glyphCount * sizeof(UINT16)) == 0
+            && memcmp(entry->ClusterMap,   clusterMap,   entry->TextLength * sizeof(UINT16)) == 0
+            && memcmp(entry->TextProps,    textProps,    entry->TextLength * sizeof(UINT16)) == 0;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Receives native pointers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    bool ShapingCache::TryGetPlacements(
+        ShapingCacheKey%                        key,
+        __in_ecount(key.TextLength) UINT16 const* clusterMap,
+        __in_ecount(key.TextLength) UINT16 const* textProps,
+        __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+        __in_ecount(glyphCount) UINT16 const*   glyphProps,
+        UINT32                                  glyphCount,
+        FLOAT                                   fontEmSize,
+        float                                   pixelsPerDip,
+        TextFormattingMode                      textFormattingMode,
+        __out_ecount(glyphCount) FLOAT*         glyphAdvances,
+        __out_ecount(glyphCount) DWRITE_GLYPH_OFFSET* glyphOffsets
+        )
+    {
+        UINT32 hash = HashPlacements(key, glyphIndices, glyphCount, fontEmSize, pixelsPerDip, textFormattingMode);
+
+        System::Threading::Monitor::Enter(_placements);
+        try
+        {
+            Entry^ entry;
+            if (_placements->TryGetValue(hash, entry))
+            {
+                for (; entry != nullptr; entry = entry->Next)
+                {
+                    if (   entry->Matches(key)
+                        && MatchesPlacements(entry, clusterMap, textProps, glyphIndices, glyphProps, glyphCount, fontEmSize, pixelsPerDip, textFormattingMode))
+                    {
+                        memcpy(glyphAdvances, entry->GlyphAdvances, glyphCount * sizeof(FLOAT));
+                        memcpy(glyphOffsets,  entry->GlyphOffsets,  glyphCount * sizeof(DWRITE_GLYPH_OFFSET));
+                        return true;
+                    }
+                }
+            }
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(_placements);
+        }
+        return false;
+    }
+
+    /// <SecurityNote>
+    /// Critical - Receives native pointers.
+    /// </SecurityNote>
+    [SecurityCritical]
+    void ShapingCache::AddPlacements(
+        ShapingCacheKey%                        key,
+        TypographicFeatureRanges*               featureRanges,
+        __in_ecount(key.TextLength) UINT16 const* clusterMap,
+        __in_ecount(key.TextLength) UINT16 const* textProps,
+        __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+        __in_ecount(glyphCount) UINT16 const*   glyphProps,
+        UINT32                                  glyphCount,
+        FLOAT                                   fontEmSize,
+        float                                   pixelsPerDip,
+        TextFormattingMode                      textFormattingMode,
+        __in_ecount(glyphCount) FLOAT const*    glyphAdvances,
+        __in_ecount(glyphCount) DWRITE_GLYPH_OFFSET const* glyphOffsets
+        )
+    {
+        UINT32 hash  = HashPlacements(key, glyphIndices, glyphCount, fontEmSize, pixelsPerDip, textFormattingMode);
+        Entry^ entry = CreateEntry(key, hash, glyphCount, true, featureRanges);
+
+        entry->FontEmSize     = fontEmSize;
+        entry->PixelsPerDip   = pixelsPerDip;
+        entry->FormattingMode = textFormattingMode;
+
+        memcpy(entry->ClusterMap,    clusterMap,    key.TextLength * sizeof(UINT16));
+        memcpy(entry->TextProps,     textProps,     key.TextLength * sizeof(UINT16));
+        memcpy(entry->GlyphIndices,  glyphIndices,  glyphCount     * sizeof(UINT16));
+        memcpy(entry->GlyphProps,    glyphProps,    glyphCount     * sizeof(UINT16));
+        memcpy(entry->GlyphAdvances, glyphAdvances, glyphCount     * sizeof(FLOAT));
+        memcpy(entry->GlyphOffsets,  glyphOffsets,  glyphCount     * sizeof(DWRITE_GLYPH_OFFSET));
+
+        System::Threading::Monitor::Enter(_placements);
+        try
+        {
+            AddEntry(_placements, entry);
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(_placements);
+        }
+    }
+
+}}}}//MS::Internal::Text::TextInterface
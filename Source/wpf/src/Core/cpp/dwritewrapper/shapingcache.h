@@ -0,0 +1,266 @@
+//-----------------------------------------------------------------------
+//
+//  Microsoft Windows Client Platform
+//  Copyright (C) Microsoft Corporation
+//
+//  File:      ShapingCache.h
+//
+//  Contents:  Bounded cache of the results of TextAnalyzer::GetGlyphs
+//             and TextAnalyzer::GetGlyphPlacements for short runs,
+//             and the native storage of the typographic features
+//             passed to DWrite.
+//
+//------------------------------------------------------------------------
+
+#ifndef __SHAPING_CACHE_H
+#define __SHAPING_CACHE_H
+
+#include "Common.h"
+#include "Font.h"
+#include "DWriteFontFeature.h"
+#include "TextFormattingMode.h"
+
+using namespace System::Collections::Generic;
+
+namespace MS { namespace Internal { namespace Text { namespace TextInterface
+{
+    /// <summary>
+    /// The DWRITE_TYPOGRAPHIC_FEATURES of a run, copied out of the managed feature arrays into a single
+    /// native block (range pointers, ranges, range lengths and features) so nothing needs to be pinned
+    /// while DWrite shapes the run.
+    /// </summary>
+    private struct TypographicFeatureRanges
+    {
+        UINT32                        RangeCount;
+        UINT32                        FeatureCount;
+        DWRITE_TYPOGRAPHIC_FEATURES** Ranges;
+        UINT32*                       RangeLengths;
+
+        /// <summary>
+        /// Returns NULL if there are no features.
+        /// </summary>
+        static TypographicFeatureRanges* Create(
+            array<array<DWriteFontFeature>^>^ features,
+            array<UINT32>^                    featureRangeLengths
+            );
+
+        static void Destroy(TypographicFeatureRanges* featureRanges);
+
+        static UINT32 Hash(
+            array<array<DWriteFontFeature>^>^ features,
+            array<UINT32>^                    featureRangeLengths,
+            UINT32                            hash
+            );
+
+        bool Matches(
+            array<array<DWriteFontFeature>^>^ features,
+            array<UINT32>^                    featureRangeLengths
+            ) const;
+    };
+
+    /// <summary>
+    /// What GetGlyphs and GetGlyphPlacements results depend on besides the glyphs themselves.
+    /// </summary>
+    private value struct ShapingCacheKey
+    {
+        const WCHAR*                      Text;
+        UINT32                            TextLength;
+        Font^                             SourceFont;
+        String^                           LocaleName;
+        array<array<DWriteFontFeature>^>^ Features;
+        array<UINT32>^                    FeatureRangeLengths;
+        UINT16                            Script;
+        UINT32                            Shapes;
+        bool                              IsSideways;
+        bool                              IsRightToLeft;
+        UINT32                            Hash;
+    };
+
+    /// <summary>
+    /// Results of GetGlyphs and GetGlyphPlacements for short runs. Reports and grids shape the same short
+    /// strings with the same font over and over, so a hit saves the DWrite shaping call entirely.
+    /// </summary>
+    /// <remarks>
+    /// Each entry keeps its text, glyphs, placements and features in one native block. Entries are matched
+    /// by the identity of the Font they were shaped with, which they keep alive.
+    /// </remarks>
+    private ref class ShapingCache sealed
+    {
+    private:
+
+        ref class Entry
+        {
+        public:
+            Entry^                    Next;
+            UINT32                    Hash;
+
+            Font^                     SourceFont;
+            String^                   LocaleName;
+            UINT16                    Script;
+            UINT32                    Shapes;
+            bool                      IsSideways;
+            bool                      IsRightToLeft;
+
+            // Placement entries only.
+            FLOAT                     FontEmSize;
+            float                     PixelsPerDip;
+            TextFormattingMode        FormattingMode;
+
+            BYTE*                     Data;
+            TypographicFeatureRanges* FeatureRanges;
+            UINT32                    TextLength;
+            UINT32                    GlyphCount;
+            WCHAR*                    Text;
+            UINT16*                   ClusterMap;
+            UINT16*                   TextProps;
+            UINT16*                   GlyphIndices;
+            UINT16*                   GlyphProps;
+            FLOAT*                    GlyphAdvances;
+            DWRITE_GLYPH_OFFSET*      GlyphOffsets;
+
+            [SecurityCritical]
+            bool Matches(ShapingCacheKey% key);
+        };
+
+        /// <summary>
+        /// Runs longer than this are not cached.
+        /// </summary>
+        literal UINT32 MaximumTextLength = 64;
+
+        /// <summary>
+        /// Entry count above which a cache is cleared before another entry is added.
+        /// </summary>
+        literal int MaximumEntryCount = 2048;
+
+        static Dictionary<UINT32, Entry^>^ _glyphs     = gcnew Dictionary<UINT32, Entry^>();
+        static Dictionary<UINT32, Entry^>^ _placements = gcnew Dictionary<UINT32, Entry^>();
+
+        [SecurityCritical]
+        static Entry^ CreateEntry(
+            ShapingCacheKey%            key,
+            UINT32                      hash,
+            UINT32                      glyphCount,
+            bool                        hasPlacements,
+            TypographicFeatureRanges*   featureRanges
+            );
+
+        [SecurityCritical]
+        static void AddEntry(Dictionary<UINT32, Entry^>^ entries, Entry^ entry);
+
+        [SecurityCritical]
+        static void DeleteEntries(Dictionary<UINT32, Entry^>^ entries);
+
+        [SecurityCritical]
+        static UINT32 HashPlacements(
+            ShapingCacheKey%                        key,
+            __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+            UINT32                                  glyphCount,
+            FLOAT                                   fontEmSize,
+            float                                   pixelsPerDip,
+            TextFormattingMode                      textFormattingMode
+            );
+
+        [SecurityCritical]
+        static bool MatchesPlacements(
+            Entry^                                  entry,
+            __in_ecount(entry->TextLength) UINT16 const* clusterMap,
+            __in_ecount(entry->TextLength) UINT16 const* textProps,
+            __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+            __in_ecount(glyphCount) UINT16 const*   glyphProps,
+            UINT32                                  glyphCount,
+            FLOAT                                   fontEmSize,
+            float                                   pixelsPerDip,
+            TextFormattingMode                      textFormattingMode
+            );
+
+    internal:
+
+        /// <summary>
+        /// Returns false, leaving key untouched, if the results for the run cannot be cached:
+        /// the run is too long, or its digits are subject to number substitution.
+        /// </summary>
+        [SecurityCritical]
+        static bool TryCreateKey(
+            __in_ecount(textLength) const WCHAR* text,
+            UINT32                               textLength,
+            Font^                                font,
+            bool                                 isSideways,
+            bool                                 isRightToLeft,
+            String^                              localeName,
+            array<array<DWriteFontFeature>^>^    features,
+            array<UINT32>^                       featureRangeLengths,
+            __in const DWRITE_SCRIPT_ANALYSIS*   scriptAnalysis,
+            void*                                numberSubstitution,
+            [System::Runtime::InteropServices::Out] ShapingCacheKey% key
+            );
+
+        /// <summary>
+        /// Copies the cached GetGlyphs results for the run. If the cached glyphs do not fit
+        /// in maxGlyphCount only glyphCount is set, as DWrite would fail the call.
+        /// </summary>
+        [SecurityCritical]
+        static bool TryGetGlyphs(
+            ShapingCacheKey%                        key,
+            UINT32                                  maxGlyphCount,
+            __out_ecount(key.TextLength) UINT16*    clusterMap,
+            __out_ecount(key.TextLength) UINT16*    textProps,
+            __out_ecount(maxGlyphCount) UINT16*     glyphIndices,
+            __out_ecount(maxGlyphCount) UINT16*     glyphProps,
+            [System::Runtime::InteropServices::Out] UINT32% glyphCount
+            );
+
+        /// <summary>
+        /// Adds the GetGlyphs results for the run. Takes ownership of featureRanges.
+        /// </summary>
+        [SecurityCritical]
+        static void AddGlyphs(
+            ShapingCacheKey%                        key,
+            TypographicFeatureRanges*               featureRanges,
+            __in_ecount(key.TextLength) UINT16 const* clusterMap,
+            __in_ecount(key.TextLength) UINT16 const* textProps,
+            __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+            __in_ecount(glyphCount) UINT16 const*   glyphProps,
+            UINT32                                  glyphCount
+            );
+
+        /// <summary>
+        /// Copies the cached DWrite advances and offsets for the shaped run.
+        /// </summary>
+        [SecurityCritical]
+        static bool TryGetPlacements(
+            ShapingCacheKey%                        key,
+            __in_ecount(key.TextLength) UINT16 const* clusterMap,
+            __in_ecount(key.TextLength) UINT16 const* textProps,
+            __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+            __in_ecount(glyphCount) UINT16 const*   glyphProps,
+            UINT32                                  glyphCount,
+            FLOAT                                   fontEmSize,
+            float                                   pixelsPerDip,
+            TextFormattingMode                      textFormattingMode,
+            __out_ecount(glyphCount) FLOAT*         glyphAdvances,
+            __out_ecount(glyphCount) DWRITE_GLYPH_OFFSET* glyphOffsets
+            );
+
+        /// <summary>
+        /// Adds the DWrite advances and offsets for the shaped run. Takes ownership of featureRanges.
+        /// </summary>
+        [SecurityCritical]
+        static void AddPlacements(
+            ShapingCacheKey%                        key,
+            TypographicFeatureRanges*               featureRanges,
+            __in_ecount(key.TextLength) UINT16 const* clusterMap,
+            __in_ecount(key.TextLength) UINT16 const* textProps,
+            __in_ecount(glyphCount) UINT16 const*   glyphIndices,
+            __in_ecount(glyphCount) UINT16 const*   glyphProps,
+            UINT32                                  glyphCount,
+            FLOAT                                   fontEmSize,
+            float                                   pixelsPerDip,
+            TextFormattingMode                      textFormattingMode,
+            __in_ecount(glyphCount) FLOAT const*    glyphAdvances,
+            __in_ecount(glyphCount) DWRITE_GLYPH_OFFSET const* glyphOffsets
+            );
+    };
+
+}}}}//MS::Internal::Text::TextInterface
+
+#endif //__SHAPING_CACHE_H
@@ -2,6 +2,8 @@
 #include "Factory.h"
 #include "DWriteTypeConverter.h"
 #include "ItemizerHelper.h"
+#include "CharAttributeTable.h"
+#include "ShapingCache.h"
 
 namespace MS { namespace Internal { namespace Text { namespace TextInterface
 {
@@ -159,79 +161,9 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         )
     {
         // Text will never be of zero length. This is enforced by Itemize().
-        bool isCombining;
-        bool needsCaretInfo;
-        bool isIndic;
-        bool isDigit;
-        bool isLatin;
-        bool isStrong;
-        bool isExtended;
-
-        classificationUtility->GetCharAttribute(
-            text[0],
-            isCombining,
-            needsCaretInfo,
-            isIndic,
-            isDigit,
-            isLatin,
-            isStrong
-            );
-
-        isExtended = ItemizerHelper::IsExtendedCharacter(text[0]);
-
-        UINT32 isDigitRangeStart = 0;
-        UINT32 isDigitRangeEnd = 0;
-        bool   previousIsDigitValue = (numberCulture == nullptr) ? false : isDigit;
-        bool   currentIsDigitValue;
-
-        // pCharAttribute is assumed to have the same length as text. This is enforced by Itemize().
-        pCharAttribute[0] = (CharAttributeType)
-                            (((isCombining)    ? CharAttribute::IsCombining    : CharAttribute::None)
-                           | ((needsCaretInfo) ? CharAttribute::NeedsCaretInfo : CharAttribute::None)
-                           | ((isLatin)        ? CharAttribute::IsLatin        : CharAttribute::None)
-                           | ((isIndic)        ? CharAttribute::IsIndic        : CharAttribute::None)
-                           | ((isStrong)       ? CharAttribute::IsStrong       : CharAttribute::None)
-                           | ((isExtended)     ? CharAttribute::IsExtended     : CharAttribute::None));
-
-        for (UINT32 i = 1; i < length; ++i)
-        {
-            classificationUtility->GetCharAttribute(
-            text[i],
-            isCombining,
-            needsCaretInfo,
-            isIndic,
-            isDigit,
-            isLatin,
-            isStrong
-            );
-
-            isExtended = ItemizerHelper::IsExtendedCharacter(text[i]);
-            
-
-            pCharAttribute[i] = (CharAttributeType)
-                                (((isCombining)    ? CharAttribute::IsCombining    : CharAttribute::None)
-                               | ((needsCaretInfo) ? CharAttribute::NeedsCaretInfo : CharAttribute::None)
-                               | ((isLatin)        ? CharAttribute::IsLatin        : CharAttribute::None)
-                               | ((isIndic)        ? CharAttribute::IsIndic        : CharAttribute::None)
-                               | ((isStrong)       ? CharAttribute::IsStrong       : CharAttribute::None)
-                               | ((isExtended)     ? CharAttribute::IsExtended     : CharAttribute::None));
-
-
-            currentIsDigitValue = (numberCulture == nullptr) ? false : isDigit;
-            if (previousIsDigitValue != currentIsDigitValue)
-            {
-
-                isDigitRangeEnd = i;
-                textItemizer->SetIsDigit(isDigitRangeStart, isDigitRangeEnd - isDigitRangeStart, previousIsDigitValue);
-
-                isDigitRangeStart = i;
-                previousIsDigitValue = currentIsDigitValue;
-            }
-        }
-
-
-        isDigitRangeEnd = i;
-        textItemizer->SetIsDigit(isDigitRangeStart, isDigitRangeEnd - isDigitRangeStart, previousIsDigitValue);
+        // The classification of the whole run and its digit ranges is done in a single pass over
+        // the native CharAttributeTable instead of calling classificationUtility per code unit.
+        CharAttributeTable::Classify(text, length, classificationUtility, textItemizer, numberCulture, pCharAttribute);
     }
 
     /// <SecurityNote>
@@ -364,53 +296,70 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         else
         {
             String^ localeName = cultureInfo->IetfLanguageTag;
-            pin_ptr<const WCHAR> pLocaleName = Native::Util::GetPtrToStringChars(localeName);
-            pin_ptr<UINT32> pFeatureRangeLengthsPinned;
-            UINT32* pFeatureRangeLengths = NULL;
-
-            UINT32 featureRanges = 0;
-            array<GCHandle>^ dwriteFontFeaturesGCHandles = nullptr;
-            DWRITE_TYPOGRAPHIC_FEATURES** dwriteTypographicFeatures = NULL;
+            DWRITE_SCRIPT_ANALYSIS* scriptAnalysis = (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis);
 
+            // Short runs are often shaped again with the same font, so their glyphs are cached.
+            ShapingCacheKey cacheKey;
+            bool isCacheable = ShapingCache::TryCreateKey(
+                textString,
+                textLength,
+                font,
+                isSideways,
+                isRightToLeft,
+                localeName,
+                features,
+                featureRangeLengths,
+                scriptAnalysis,
+                itemProps->NumberSubstitutionNoAddRef,
+                cacheKey
+                );
 
-            if (features != nullptr)
-            {
-                pFeatureRangeLengthsPinned = &featureRangeLengths[0];
-                pFeatureRangeLengths = reinterpret_cast<UINT32*> (pFeatureRangeLengthsPinned);
-                featureRanges = (UINT32)featureRangeLengths->Length;
-                dwriteFontFeaturesGCHandles = gcnew array<GCHandle>(featureRanges);
-                dwriteTypographicFeatures = new DWRITE_TYPOGRAPHIC_FEATURES*[featureRanges];
-            }
-
-            FontFace^ fontFace = font->GetFontFace();
-            try
+            UINT32 glyphCount = 0;
+            if (isCacheable && ShapingCache::TryGetGlyphs(cacheKey, maxGlyphCount, clusterMap, textProps, glyphIndices, (UINT16*)glyphProps, glyphCount))
             {
-                if (features != nullptr)
+                // If the cached glyphs do not fit the caller retries with glyphCount.
+                if (glyphCount <= maxGlyphCount && pfCanGlyphAlone != NULL)
                 {
-                    for (UINT32 i = 0; i < featureRanges; ++i)
+                    for (UINT32 i = 0; i < textLength; ++i)
                     {
-                        dwriteFontFeaturesGCHandles[i] = GCHandle::Alloc(features[i], GCHandleType::Pinned);
-                        dwriteTypographicFeatures[i] = new DWRITE_TYPOGRAPHIC_FEATURES();
-                        dwriteTypographicFeatures[i]->features = reinterpret_cast<DWRITE_FONT_FEATURE*>(dwriteFontFeaturesGCHandles[i].AddrOfPinnedObject().ToPointer());
-                        dwriteTypographicFeatures[i]->featureCount = features[i]->Length;
+                        pfCanGlyphAlone[i] = (((DWRITE_SHAPING_TEXT_PROPERTIES*)textProps)[i].isShapedAlone > 0) ? 1 : 0;
                     }
                 }
 
+                actualGlyphCount = glyphCount;
+                return;
+            }
+
+            pin_ptr<const WCHAR> pLocaleName = Native::Util::GetPtrToStringChars(localeName);
 
-                UINT32 glyphCount = 0;
+            // The features are copied to a single native block instead of pinning every range.
+            TypographicFeatureRanges* featureRanges = TypographicFeatureRanges::Create(features, featureRangeLengths);
+            DWRITE_TYPOGRAPHIC_FEATURES const** dwriteTypographicFeatures = NULL;
+            UINT32* pFeatureRangeLengths = NULL;
+            UINT32 featureRangeCount = 0;
 
+            if (featureRanges != NULL)
+            {
+                dwriteTypographicFeatures = (DWRITE_TYPOGRAPHIC_FEATURES const**)featureRanges->Ranges;
+                pFeatureRangeLengths      = featureRanges->RangeLengths;
+                featureRangeCount         = featureRanges->RangeCount;
+            }
+
+            FontFace^ fontFace = font->GetFontFace();
+            try
+            {
                 HRESULT hr = _textAnalyzer->Value->GetGlyphs(
                     textString,
                     /*checked*/((UINT32)textLength),
                     fontFace->DWriteFontFaceNoAddRef,
                     isSideways ? TRUE : FALSE,
                     isRightToLeft ? TRUE : FALSE,
-                    (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis),
+                    scriptAnalysis,
                     pLocaleName,
                     (IDWriteNumberSubstitution*)(itemProps->NumberSubstitutionNoAddRef),
-                    (DWRITE_TYPOGRAPHIC_FEATURES const**)dwriteTypographicFeatures,
+                    dwriteTypographicFeatures,
                     pFeatureRangeLengths,
-                    featureRanges,
+                    featureRangeCount,
                     /*checked*/((UINT32)maxGlyphCount),
                     clusterMap,
                     (DWRITE_SHAPING_TEXT_PROPERTIES*)textProps, //The size of DWRITE_SHAPING_TEXT_PROPERTIES is 16 bits which is the same size that LS passes to WPF 
@@ -432,12 +381,12 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                         fontFace->DWriteFontFaceNoAddRef,
                         isSideways ? TRUE : FALSE,
                         isRightToLeft ? TRUE : FALSE,
-                        (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis),
+                        scriptAnalysis,
                         NULL /* default locale mapping */,
                         (IDWriteNumberSubstitution*)(itemProps->NumberSubstitutionNoAddRef),
-                        (DWRITE_TYPOGRAPHIC_FEATURES const**)dwriteTypographicFeatures,
+                        dwriteTypographicFeatures,
                         pFeatureRangeLengths,
-                        featureRanges,
+                        featureRangeCount,
                         /*checked*/((UINT32)maxGlyphCount),
                         clusterMap,
                         (DWRITE_SHAPING_TEXT_PROPERTIES*)textProps, //The size of DWRITE_SHAPING_TEXT_PROPERTIES is 16 bits which is the same size that LS passes to WPF 
@@ -454,15 +403,6 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                 System::GC::KeepAlive(itemProps);
                 System::GC::KeepAlive(_textAnalyzer);
 
-                if (features != nullptr)
-                {
-                    for (UINT32 i = 0; i < featureRanges; ++i)
-                    {
-                        dwriteFontFeaturesGCHandles[i].Free();
-                        delete dwriteTypographicFeatures[i];
-                    }
-                }
-
                 if (hr == HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER))
                 {
                     // Actual glyph count is not returned by DWrite unless the call tp GetGlyphs succeeds.
@@ -490,15 +430,19 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                     }
 
                     actualGlyphCount = glyphCount;
+
+                    if (isCacheable)
+                    {
+                        // The cache takes ownership of the feature block.
+                        ShapingCache::AddGlyphs(cacheKey, featureRanges, clusterMap, textProps, glyphIndices, (UINT16*)glyphProps, glyphCount);
+                        featureRanges = NULL;
+                    }
                 }                
             }
             finally
             {
                 fontFace->Release();
-                if (dwriteTypographicFeatures != NULL)
-                {
-                    delete[] dwriteTypographicFeatures;
-                }
+                TypographicFeatureRanges::Destroy(featureRanges);
             }
         }
     }
@@ -644,70 +588,66 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
         {
             FLOAT*                       dwriteGlyphAdvances       = new FLOAT                      [glyphCount];
             DWRITE_GLYPH_OFFSET*         dwriteGlyphOffsets        = new DWRITE_GLYPH_OFFSET        [glyphCount];
-
-            array<GCHandle>^ dwriteFontFeaturesGCHandles = nullptr;
-            UINT32 featureRanges = 0;
-            DWRITE_TYPOGRAPHIC_FEATURES** dwriteTypographicFeatures = NULL;
-            pin_ptr<UINT32> pFeatureRangeLengthsPinned;
-            UINT32* pFeatureRangeLengths = NULL;
-
-            if (features != nullptr)
-            {
-                featureRanges = (UINT32)featureRangeLengths->Length;
-                dwriteTypographicFeatures = new DWRITE_TYPOGRAPHIC_FEATURES*[featureRanges];
-                pFeatureRangeLengthsPinned = &featureRangeLengths[0];
-                pFeatureRangeLengths = reinterpret_cast<UINT32*> (pFeatureRangeLengthsPinned);
-                dwriteFontFeaturesGCHandles = gcnew array<GCHandle>(featureRanges);
-            }
+            TypographicFeatureRanges*    featureRanges             = NULL;
 
             FontFace^ fontFace = font->GetFontFace();
             try
             {
                 String^ localeName = cultureInfo->IetfLanguageTag;
-                pin_ptr<const WCHAR> pLocaleName = Native::Util::GetPtrToStringChars(localeName);
-                DWRITE_MATRIX transform = Factory::GetIdentityTransform();
+                DWRITE_SCRIPT_ANALYSIS* scriptAnalysis = (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis);
+                FLOAT fontEmSizeFloat = (FLOAT)fontEmSize;
+
+                // The number substitution is already reflected in the glyphs, which are part of the cache key.
+                ShapingCacheKey cacheKey;
+                bool isCacheable = ShapingCache::TryCreateKey(
+                    textString,
+                    textLength,
+                    font,
+                    isSideways,
+                    isRightToLeft,
+                    localeName,
+                    features,
+                    featureRangeLengths,
+                    scriptAnalysis,
+                    NULL,
+                    cacheKey
+                    );
 
-                if (features != nullptr)
+                if (   !isCacheable
+                    || !ShapingCache::TryGetPlacements(
+                            cacheKey,
+                            clusterMap,
+                            textProps,
+                            glyphIndices,
+                            (UINT16*)glyphProps,
+                            glyphCount,
+                            fontEmSizeFloat,
+                            pixelsPerDip,
+                            textFormattingMode,
+                            dwriteGlyphAdvances,
+                            dwriteGlyphOffsets
+                            ))
                 {
-                    for (UINT32 i = 0; i < featureRanges; ++i)
+                    pin_ptr<const WCHAR> pLocaleName = Native::Util::GetPtrToStringChars(localeName);
+                    DWRITE_MATRIX transform = Factory::GetIdentityTransform();
+
+                    // The features are copied to a single native block instead of pinning every range.
+                    featureRanges = TypographicFeatureRanges::Create(features, featureRangeLengths);
+                    DWRITE_TYPOGRAPHIC_FEATURES const** dwriteTypographicFeatures = NULL;
+                    UINT32* pFeatureRangeLengths = NULL;
+                    UINT32 featureRangeCount = 0;
+
+                    if (featureRanges != NULL)
                     {
-                        dwriteFontFeaturesGCHandles[i] = GCHandle::Alloc(features[i], GCHandleType::Pinned);
-                        dwriteTypographicFeatures[i] = new DWRITE_TYPOGRAPHIC_FEATURES();
-                        dwriteTypographicFeatures[i]->features = reinterpret_cast<DWRITE_FONT_FEATURE*>(dwriteFontFeaturesGCHandles[i].AddrOfPinnedObject().ToPointer());
-                        dwriteTypographicFeatures[i]->featureCount = features[i]->Length;
+                        dwriteTypographicFeatures = (DWRITE_TYPOGRAPHIC_FEATURES const**)featureRanges->Ranges;
+                        pFeatureRangeLengths      = featureRanges->RangeLengths;
+                        featureRangeCount         = featureRanges->RangeCount;
                     }
-                }
-
-                FLOAT fontEmSizeFloat = (FLOAT)fontEmSize;
-                HRESULT hr = E_FAIL;
 
-                if (textFormattingMode == TextFormattingMode::Ideal)
-                {   
-                    hr = _textAnalyzer->Value->GetGlyphPlacements(
-                        textString,
-                        clusterMap,
-                        (DWRITE_SHAPING_TEXT_PROPERTIES*)textProps,
-                        textLength,
-                        glyphIndices,
-                        (DWRITE_SHAPING_GLYPH_PROPERTIES*)glyphProps,
-                        glyphCount,
-                        fontFace->DWriteFontFaceNoAddRef,
-                        fontEmSizeFloat,
-                        isSideways ? TRUE : FALSE,
-                        isRightToLeft ? TRUE : FALSE,
-                        (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis),
-                        pLocaleName,
-                        (DWRITE_TYPOGRAPHIC_FEATURES const**)dwriteTypographicFeatures,
-                        pFeatureRangeLengths,
-                        featureRanges,
-                        dwriteGlyphAdvances,
-                        dwriteGlyphOffsets
-                        );
+                    HRESULT hr = E_FAIL;
 
-                    if (E_INVALIDARG == hr)
-                    {
-                        // If pLocaleName is unsupported (e.g. "prs-af"), DWrite returns E_INVALIDARG.
-                        // Try again with the default mapping.
+                    if (textFormattingMode == TextFormattingMode::Ideal)
+                    {   
                         hr = _textAnalyzer->Value->GetGlyphPlacements(
                             textString,
                             clusterMap,
@@ -720,49 +660,46 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                             fontEmSizeFloat,
                             isSideways ? TRUE : FALSE,
                             isRightToLeft ? TRUE : FALSE,
-                            (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis),
-                            NULL /* default locale mapping */,
-                            (DWRITE_TYPOGRAPHIC_FEATURES const**)dwriteTypographicFeatures,
+                            scriptAnalysis,
+                            pLocaleName,
+                            dwriteTypographicFeatures,
                             pFeatureRangeLengths,
-                            featureRanges,
+                            featureRangeCount,
                             dwriteGlyphAdvances,
                             dwriteGlyphOffsets
                             );
-                    }
-                    
-                }
-                else
-                {
-                    assert(textFormattingMode == TextFormattingMode::Display);
 
-                    hr = _textAnalyzer->Value->GetGdiCompatibleGlyphPlacements(
-                        textString,
-                        clusterMap,
-                        (DWRITE_SHAPING_TEXT_PROPERTIES*)textProps,
-                        textLength,
-                        glyphIndices,
-                        (DWRITE_SHAPING_GLYPH_PROPERTIES*)glyphProps,
-                        glyphCount,
-                        fontFace->DWriteFontFaceNoAddRef,
-                        fontEmSizeFloat,
-                        pixelsPerDip,
-                        &transform,
-                        FALSE,  // useGdiNatural
-                        isSideways ? TRUE : FALSE,
-                        isRightToLeft ? TRUE : FALSE,
-                        (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis),
-                        pLocaleName,
-                        (DWRITE_TYPOGRAPHIC_FEATURES const**)dwriteTypographicFeatures,
-                        pFeatureRangeLengths,
-                        featureRanges,
-                        dwriteGlyphAdvances,
-                        dwriteGlyphOffsets
-                        );
-
-                    if (E_INVALIDARG == hr)
+                        if (E_INVALIDARG == hr)
+                        {
+                            // If pLocaleName is unsupported (e.g. "prs-af"), DWrite returns E_INVALIDARG.
+                            // Try again with the default mapping.
+                            hr = _textAnalyzer->Value->GetGlyphPlacements(
+                                textString,
+                                clusterMap,
+                                (DWRITE_SHAPING_TEXT_PROPERTIES*)textProps,
+                                textLength,
+                                glyphIndices,
+                                (DWRITE_SHAPING_GLYPH_PROPERTIES*)glyphProps,
+                                glyphCount,
+                                fontFace->DWriteFontFaceNoAddRef,
+                                fontEmSizeFloat,
+                                isSideways ? TRUE : FALSE,
+                                isRightToLeft ? TRUE : FALSE,
+                                scriptAnalysis,
+                                NULL /* default locale mapping */,
+                                dwriteTypographicFeatures,
+                                pFeatureRangeLengths,
+                                featureRangeCount,
+                                dwriteGlyphAdvances,
+                                dwriteGlyphOffsets
+                                );
+                        }
+                    
+                    }
+                    else
                     {
-                        // If pLocaleName is unsupported (e.g. "prs-af"), DWrite returns E_INVALIDARG.
-                        // Try again with the default mapping.
+                        assert(textFormattingMode == TextFormattingMode::Display);
+
                         hr = _textAnalyzer->Value->GetGdiCompatibleGlyphPlacements(
                             textString,
                             clusterMap,
@@ -778,27 +715,69 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                             FALSE,  // useGdiNatural
                             isSideways ? TRUE : FALSE,
                             isRightToLeft ? TRUE : FALSE,
-                            (DWRITE_SCRIPT_ANALYSIS*)(itemProps->ScriptAnalysis),
-                            NULL /* default locale mapping */,
-                            (DWRITE_TYPOGRAPHIC_FEATURES const**)dwriteTypographicFeatures,
+                            scriptAnalysis,
+                            pLocaleName,
+                            dwriteTypographicFeatures,
                             pFeatureRangeLengths,
-                            featureRanges,
+                            featureRangeCount,
                             dwriteGlyphAdvances,
                             dwriteGlyphOffsets
                             );
+
+                        if (E_INVALIDARG == hr)
+                        {
+                            // If pLocaleName is unsupported (e.g. "prs-af"), DWrite returns E_INVALIDARG.
+                            // Try again with the default mapping.
+                            hr = _textAnalyzer->Value->GetGdiCompatibleGlyphPlacements(
+                                textString,
+                                clusterMap,
+                                (DWRITE_SHAPING_TEXT_PROPERTIES*)textProps,
+                                textLength,
+                                glyphIndices,
+                                (DWRITE_SHAPING_GLYPH_PROPERTIES*)glyphProps,
+                                glyphCount,
+                                fontFace->DWriteFontFaceNoAddRef,
+                                fontEmSizeFloat,
+                                pixelsPerDip,
+                                &transform,
+                                FALSE,  // useGdiNatural
+                                isSideways ? TRUE : FALSE,
+                                isRightToLeft ? TRUE : FALSE,
+                                scriptAnalysis,
+                                NULL /* default locale mapping */,
+                                dwriteTypographicFeatures,
+                                pFeatureRangeLengths,
+                                featureRangeCount,
+                                dwriteGlyphAdvances,
+                                dwriteGlyphOffsets
+                                );
+                        }
                     }
-                }
 
-                System::GC::KeepAlive(fontFace);
-                System::GC::KeepAlive(itemProps);
-                System::GC::KeepAlive(_textAnalyzer);
+                    System::GC::KeepAlive(fontFace);
+                    System::GC::KeepAlive(itemProps);
+                    System::GC::KeepAlive(_textAnalyzer);
 
-                if (features != nullptr)
-                {
-                    for (UINT32 i = 0; i < featureRanges; ++i)
+                    ConvertHresultToException(hr, "void TextAnalyzer::GetGlyphs");
+
+                    if (isCacheable)
                     {
-                        dwriteFontFeaturesGCHandles[i].Free();
-                        delete dwriteTypographicFeatures[i];
+                        // The cache takes ownership of the feature block.
+                        ShapingCache::AddPlacements(
+                            cacheKey,
+                            featureRanges,
+                            clusterMap,
+                            textProps,
+                            glyphIndices,
+                            (UINT16*)glyphProps,
+                            glyphCount,
+                            fontEmSizeFloat,
+                            pixelsPerDip,
+                            textFormattingMode,
+                            dwriteGlyphAdvances,
+                            dwriteGlyphOffsets
+                            );
+                        featureRanges = NULL;
                     }
                 }
 
@@ -820,9 +799,7 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                         glyphOffsets[i].du = (int)(dwriteGlyphOffsets[i].advanceOffset * scalingFactor);
                         glyphOffsets[i].dv = (int)(dwriteGlyphOffsets[i].ascenderOffset * scalingFactor);
                     }
-                }                
-
-                ConvertHresultToException(hr, "void TextAnalyzer::GetGlyphs");
+                }
             }
             finally
             {
@@ -838,10 +815,7 @@ namespace MS { namespace Internal { namespace Text { namespace TextInterface
                     delete[] dwriteGlyphOffsets;
                 }
 
-                if (dwriteTypographicFeatures != NULL)
-                {
-                    delete[] dwriteTypographicFeatures;
-                }
+                TypographicFeatureRanges::Destroy(featureRanges);
             }
         }
     }
@@ -17,9 +17,12 @@
 #include "DWriteWrapper\FontCollectionLoader.cpp"
 #include "DWriteWrapper\FontFileEnumerator.cpp"
 #include "DWriteWrapper\FontFileLoader.cpp"
+#include "DWriteWrapper\FontFileView.cpp"
 #include "DWriteWrapper\FontFileStream.cpp"
 
 #include "DWriteWrapper\TextItemizer.cpp"
+#include "DWriteWrapper\CharAttributeTable.cpp"
+#include "DWriteWrapper\ShapingCache.cpp"
 #include "DWriteWrapper\TextAnalyzer.cpp"
 #include "DWriteWrapper\DWriteFontFeature.h"
 
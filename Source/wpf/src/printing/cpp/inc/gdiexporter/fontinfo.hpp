@@ -15,10 +15,37 @@
 
 ref class FontInfo;
 
+//
+// Content identity of a font stream: its length and a SHA-256 hash of its data.
+//
+// Identities are kept process-wide by FontStreamContext, keyed on font location, so each
+// font is read and hashed once no matter how many jobs use it. Identities of font files
+// also record the file's last write time and are recomputed if the file changes.
+//
+ref class FontIdentity
+{
+public:
+    FontIdentity(int streamLength, DateTime lastWriteTime, array<Byte>^ hash);
+
+    // Length of font stream.
+    initonly int          StreamLength;
+
+    // Last write time (UTC) of font file, or DateTime::MinValue if the font is not a file.
+    initonly DateTime     LastWriteTime;
+
+    initonly array<Byte>^ Hash;
+
+    // Determines if two identities describe the same font data.
+    bool Matches(FontIdentity^ other);
+};
+
 //
 // Wraps a font stream source (file Uri or GlyphTypeface) and allows comparing
 // font streams to determine if two fonts are the same.
 //
+// Streams are compared by FontIdentity where one can be obtained, falling back to
+// comparing the stream data.
+//
 // Stream length is cached to avoid reopening the stream, and is only updated
 // via explicit UpdateStreamLength() call.
 //
@@ -36,6 +63,9 @@ private:
     // We compare font files CompareLength bytes at a time.
     static const int CompareLength = 65535;
 
+    // Number of font identities kept before the identity cache is flushed.
+    static const int MaximumIdentityCount = 1024;
+
 // Constructors
 public:
     FontStreamContext(GlyphTypeface^ source);
@@ -102,10 +132,28 @@ public:
     [SecurityCritical, SecurityTreatAsSafe]
     bool Equals(FontStreamContext %otherContext);
 
+    /// <SecurityNote>
+    /// Critical    - Accesses font stream and font location, asserts file read permission
+    /// TreatAsSafe - Returns only length, timestamp and hash of the font data
+    /// </SecurityNote>
+    /// <Remarks>
+    /// Gets content identity of the font stream from the process-wide identity cache,
+    /// hashing the stream if it is not cached or the font file has changed. Only font
+    /// files are cached; other streams are hashed once per context.
+    /// May return nullptr if the stream can't be opened or is too long.
+    /// </Remarks>
+    [SecurityCritical, SecurityTreatAsSafe]
+    FontIdentity^ GetIdentity();
+
 // Private Fields
 private:
     GlyphTypeface^ _sourceTypeface;
 
+    FontIdentity^ _identity;
+
+    // Font file location (Uri::AbsoluteUri) to FontIdentity
+    static Dictionary<String^, FontIdentity^>^ s_identities = gcnew Dictionary<String^, FontIdentity^>();
+
     /// <SecurityNote>
     /// Critical    - Font location
     /// </SecurityNote>
@@ -15,6 +15,14 @@ typedef enum
     CAP_CharacterStream = 0x2000,  // Is a text only device
 };
 
+enum CachedObjectType
+{
+    CachedBrush,
+    CachedPen,
+    CachedFont,
+    CachedObjectTypeCount
+};
+
 ref class CachedGDIObject
 {
 protected:
@@ -27,7 +35,13 @@ protected:
     GdiSafeHandle ^ m_handle;
     
 public:
-    
+    int                 m_Hash;
+    CachedObjectType    m_Type;
+
+    CachedGDIObject   ^ m_NextInBucket;     // Next object in the same hash bucket
+    CachedGDIObject   ^ m_Newer;            // Neighbours in the LRU list for m_Type
+    CachedGDIObject   ^ m_Older;
+
     property GdiSafeHandle^ Handle
     {
         /// <SecurityNote>
@@ -41,7 +55,7 @@ public:
     ///     Critical : Unmanaged pointer
     /// </SecurityNote>
     [SecurityCritical]
-    CachedGDIObject(const interior_ptr<Byte> pData, int size, GdiSafeHandle ^ handle)
+    CachedGDIObject(const interior_ptr<Byte> pData, int size, int hash, CachedObjectType type, GdiSafeHandle ^ handle)
     {
         m_RawData = gcnew array<Byte>(size);
 
@@ -50,9 +64,28 @@ public:
             m_RawData[i] = pData[i];
         }
 
+        m_Hash   = hash;
+        m_Type   = type;
         m_handle = handle;
     }
 
+    /// <SecurityNote>
+    ///     Critical : Unmanaged pointer
+    /// </SecurityNote>
+    [SecurityCritical]
+    static int Hash(const interior_ptr<Byte> pData, int size)
+    {
+        // FNV-1a
+        unsigned hash = 2166136261;
+
+        for (int i = 0; i < size; i ++)
+        {
+            hash = (hash ^ pData[i]) * 16777619;
+        }
+
+        return (int) (hash & 0x7FFFFFFF);
+    }
+
     /// <SecurityNote>
     ///     Critical : Unmanaged pointer
     /// </SecurityNote>
@@ -97,8 +130,14 @@ protected:
 
     array<Byte>^ m_lastDevmode;
 
+    // GDI objects cached by description: hash buckets, plus a most recently used first
+    // list per CachedObjectType so that each type is evicted in LRU order within its own limit
     array<CachedGDIObject ^> ^ m_Cache;
-    int                             m_CacheFirst;
+    array<CachedGDIObject ^> ^ m_CacheNewest;
+    array<CachedGDIObject ^> ^ m_CacheOldest;
+    array<int>               ^ m_CacheCount;
+    array<int>               ^ m_CacheLookups;
+    array<int>               ^ m_CacheHits;
     
     /// <SecurityNote>
     ///     Critical : Field for critical type
@@ -383,17 +422,40 @@ public:
         return CNativeMethods::ExtEscape(m_hDC, QUERYESCSUPPORT, sizeof(DWORD), (void*)(LPCSTR)& function, 0, NULL) != 0;
     }
 
+    /// <SecurityNote>
+    ///     Critical : Calls native method with critical DC handle
+    /// </SecurityNote>
+    [SecurityCritical]
+    BOOL RectVisible(int left, int top, int right, int bottom)
+    {
+        RECT rect = { left, top, right, bottom };
+
+        return CNativeMethods::RectVisible(m_hDC, & rect);
+    }
+
     /// <SecurityNote>
     ///     Critical : Calls critical method to retrieve cached GDI handle
     /// </SecurityNote>
     [SecurityCritical]
-    GdiSafeHandle^ CacheMatch(const interior_ptr<Byte> pData, int size);
+    GdiSafeHandle^ CacheMatch(CachedObjectType type, const interior_ptr<Byte> pData, int size);
 
     /// <SecurityNote>
     ///     Critical : Calls critical method to cache GDI handle
     /// </SecurityNote>
     [SecurityCritical]
-    void CacheObject(const interior_ptr<Byte> pData, int size, GdiSafeHandle^ handle);
+    void CacheObject(CachedObjectType type, const interior_ptr<Byte> pData, int size, GdiSafeHandle^ handle);
+
+    /// <SecurityNote>
+    ///     Critical : Closes cached GDI handles
+    /// </SecurityNote>
+    [SecurityCritical]
+    void CacheClear();
+
+    /// <SecurityNote>
+    ///     Critical : Modifies the cache of critical GDI handles
+    /// </SecurityNote>
+    [SecurityCritical]
+    void CacheUnlink(CachedGDIObject ^ entry);
 
     /// <SecurityNote>
     /// Critical    - Calls native method to obtain create GDI pen from WPF pen
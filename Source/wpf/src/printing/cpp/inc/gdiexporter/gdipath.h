@@ -44,6 +44,44 @@ public:
         return m_ResolutionScale;
     }
 
+    // Can this fill be emitted in one PolyPolygon together with other fills (see FillMerged)?
+    bool CanMerge()
+    {
+        return m_IsValid && (m_Flags & IsPolygon) && (m_ResolutionScale == 1) && (m_NumPoints > 0);
+    }
+
+    // Bounds of the path points in device space, times GetResolutionScale()
+    Int32Rect GetBounds()
+    {
+        return m_DeviceBounds;
+    }
+
+    /// <SecurityNote>
+    /// Critical    - Calls critical CGDIDevice methods to fill paths
+    /// </SecurityNote>
+    /// <Remarks>
+    /// Fills paths for which CanMerge() is true, with the fill mode of the first one.
+    /// Their polygons must not overlap each other's.
+    /// </Remarks>
+    [SecurityCritical]
+    static HRESULT FillMerged(CGDIDevice ^ dc, GdiSafeHandle^ brush, List<CGDIPath^>^ paths);
+
+    int GetFillMode()
+    {
+        return m_PathFillMode;
+    }
+
+    int GetPointCount()
+    {
+        return m_NumPoints;
+    }
+
+    /// <SecurityNote>
+    /// Critical    - Calls critical CGDIDevice method to query the clip region
+    /// </SecurityNote>
+    [SecurityCritical]
+    bool IsClippedOut(CGDIDevice ^ dc);
+
 /*  void GetBounds(Int32Rect * pRect)
     {
         pRect->X      = m_DeviceBounds.X;
@@ -66,6 +104,7 @@ protected:
 
     void   ProcessCurve(int count, bool ForFill);
     void ProcessPolygon(int count, bool ForFill, int figureCount);
+    void SimplifyPolygons(bool ForFill);
 
 private:
 
@@ -83,6 +122,7 @@ private:
     int                     m_NumPoints;
     int                     m_NumPolygons;
     int                     m_PathFillMode;
+    int                     m_StrokeInflate;    // Extent of the stroke beyond the points, times m_ResolutionScale
 
     unsigned long           m_Flags;
 };
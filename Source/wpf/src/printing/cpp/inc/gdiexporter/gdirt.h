@@ -201,6 +201,22 @@ protected:
 
     System::Collections::Hashtable^ m_cachedUnstyledFontCharsets;
 
+    // Brush rasters from CreateBitmapAndFillWithBrush, keyed by GetBrushRasterKey, so that
+    // fills repeated on later pages (backgrounds, full-bleed gradients) are not rasterized again
+    Dictionary<String^, BitmapSource^>^ m_brushRasterCache;
+    int                                 m_brushRasterCachePixels;
+
+    // Solid polygon fills of one color with disjoint bounds, not yet sent to GDI; see QueueFill
+    List<CGDIPath^>^                    m_pendingFills;
+    COLORREF                            m_pendingFillColor;
+    int                                 m_pendingFillPoints;
+
+    /// <SecurityNote>
+    /// Critical    - Field for critical type
+    /// </SecurityNote>
+    [SecurityCritical]
+    GdiSafeHandle^                      m_pendingFillBrush;
+
     // Throws an exception for an HRESULT if it's a failure.
     // Special case: Throws PrintingCanceledException for ERROR_CANCELLED/ERROR_PRINT_CANCELLED.
 
@@ -262,6 +278,26 @@ protected:
         IN Brush ^pFillBrush
         );
 
+    /// <SecurityNote>
+    /// Critical    - Calls native method to draw to a GDI device
+    /// </SecurityNote>
+    /// <Remarks>
+    /// Adds a solid fill to m_pendingFills, flushing the fills already there first if it
+    /// can't be merged with them. Returns false if the fill can't be merged at all.
+    /// </Remarks>
+    [SecurityCritical]
+    bool QueueFill(CGDIPath ^ path, GdiSafeHandle ^ brush, COLORREF color, HRESULT % hr);
+
+    /// <SecurityNote>
+    /// Critical    - Calls native method to draw to a GDI device
+    /// </SecurityNote>
+    /// <Remarks>
+    /// Sends m_pendingFills to GDI. Must be called before anything else is drawn or
+    /// the clip is changed.
+    /// </Remarks>
+    [SecurityCritical]
+    HRESULT FlushFills();
+
     /// <SecurityNote>
     /// Critical    - Calls native method to draw to a GDI device
     /// </SecurityNote>
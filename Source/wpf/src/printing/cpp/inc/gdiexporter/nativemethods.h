@@ -493,6 +493,23 @@ internal:
         int iMode           // clipping mode
         );
 
+    /// <SecurityNote>
+    ///     Critical: Elevates to unmanagedcode permission
+    /// </SecurityNote>
+    [DllImport(
+            "gdi32.dll",
+            EntryPoint = "RectVisible",
+            SetLastError = true,
+            CallingConvention = CallingConvention::Winapi)]
+    [SecurityCritical]
+    [SuppressUnmanagedCodeSecurity]
+    static
+    BOOL
+    RectVisible(
+        GdiSafeDCHandle^ hdc,   // handle to DC
+        const RECT* lprect      // rectangle
+        );
+
     /// <SecurityNote>
     ///     Critical: Elevates to unmanagedcode permission
     /// </SecurityNote>
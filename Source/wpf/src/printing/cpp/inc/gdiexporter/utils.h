@@ -123,6 +123,12 @@ Geometry^ TransformGeometry(Geometry^ geometry, Matrix transform);
 // Maximum rasterization size in pixels
 const int RasterizeBandPixelLimit = 1600 * 1200;
 
+// Width and height of the tiles in which brushes are rasterized, in rasterization pixels
+const int RasterizeTileSize = 512;
+
+// Maximum total size in pixels of the brush rasters kept by a render target for reuse
+const int RasterCachePixelLimit = 2048 * 2048;
+
 // Proxy for Geometry that caches Geometry conversions and attributes.
 ref struct GeometryProxy
 {
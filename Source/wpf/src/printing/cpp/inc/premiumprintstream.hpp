@@ -27,6 +27,8 @@ namespace System
 {
 namespace Printing
 {
+    ref class WritePrinterAsyncResult;
+
     public ref class PrintQueueStream :
     public Stream
     {
@@ -338,6 +340,16 @@ namespace Printing
             bool abort
             );
 
+        void
+        DrainAsyncWrites(
+            Object^ state
+            );
+
+        void
+        WaitForAsyncWrites(
+            void
+            );
+
         ///<SecurityNote>
         /// Critical    - References type from non-APTCA reachframework.dll
         /// TreatAsSafe - Type is safe Exception type
@@ -399,6 +411,39 @@ namespace Printing
         PrintSystemDispatcherObject^    accessVerifier;
 
         Boolean                             isFinalizer;
+
+        /// <summary>
+        /// Asynchronous writes not yet written, in the order BeginWrite was called.
+        /// A single writer drains the queue on a thread pool thread, so writes reach the
+        /// spool stream in order. Also guards the other asynchronous write fields.
+        /// </summary>
+        System::Collections::Generic::Queue<WritePrinterAsyncResult^>^  pendingWrites;
+
+        /// <summary>
+        /// Number of bytes in pendingWrites. BeginWrite blocks while this is above
+        /// MaximumPendingBytes.
+        /// </summary>
+        Int64                               pendingBytes;
+
+        /// <summary>
+        /// True while a writer is queued to the thread pool or draining pendingWrites.
+        /// </summary>
+        Boolean                             writerScheduled;
+
+        /// <summary>
+        /// Thread draining pendingWrites. User callbacks run on it and must not be blocked
+        /// by back-pressure, since only this thread can make room in the queue.
+        /// </summary>
+        System::Threading::Thread^          writerThread;
+
+        /// <summary>
+        /// Buffer in which consecutive small writes are gathered into a single spool stream write.
+        /// </summary>
+        array<Byte>^                        coalesceBuffer;
+
+        static const Int32                  MaximumPendingBytes = 4 * 1024 * 1024;
+
+        static const Int32                  CoalesceLength = 64 * 1024;
     };
 
     private ref class WritePrinterAsyncResult :
@@ -453,11 +498,36 @@ namespace Printing
 
         internal:
 
+        property
+        Int32
+        Count
+        {
+            Int32 get();
+        }
+
+        property
+        Exception^
+        WriteException
+        {
+            Exception^ get();
+        }
+
         void
         AsyncWrite(
             void
             );
 
+        void
+        CopyTo(
+            array<Byte>^    buffer,
+            Int32           offset
+            );
+
+        void
+        Complete(
+            Exception^      exception
+            );
+
         private:
 
         Stream^                             printStream;
@@ -468,6 +538,7 @@ namespace Printing
         array<Byte>^                        dataArray;
         Int32                               dataOffset;
         Int32                               numberOfBytes;
+        Exception^                          writeException;
     };
 
 
@@ -15,6 +15,34 @@
 *
 **************************************************************************/
 
+// FontIdentity
+FontIdentity::FontIdentity(int streamLength, DateTime lastWriteTime, array<Byte>^ hash)
+{
+    Debug::Assert(hash != nullptr);
+
+    StreamLength  = streamLength;
+    LastWriteTime = lastWriteTime;
+    Hash          = hash;
+}
+
+bool FontIdentity::Matches(FontIdentity^ other)
+{
+    if (StreamLength != other->StreamLength || Hash->Length != other->Hash->Length)
+    {
+        return false;
+    }
+
+    for (int index = 0; index < Hash->Length; index++)
+    {
+        if (Hash[index] != other->Hash[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 // FontStreamContext
 FontStreamContext::FontStreamContext(GlyphTypeface^ source)
 {
@@ -139,8 +167,163 @@ void FontStreamContext::UpdateStreamLength()
     }
 }
 
+FontIdentity^ FontStreamContext::GetIdentity()
+{
+    if (_identity != nullptr)
+    {
+        return _identity;
+    }
+
+    Uri^ uri = _sourceUri;
+
+    if (uri == nullptr)
+    {
+        uri = Microsoft::Internal::AlphaFlattener::Utility::GetFontUri(_sourceTypeface);
+    }
+
+    if (uri == nullptr)
+    {
+        return nullptr;
+    }
+
+    String^ key = uri->AbsoluteUri;
+    DateTime lastWriteTime = DateTime::MinValue;
+    int fileLength = 0;
+
+    if (uri->IsFile)
+    {
+        // identity of a font file is only valid while the file is unchanged
+        FileIOPermission^ fileIOPermission = gcnew FileIOPermission(FileIOPermissionAccess::Read, uri->LocalPath);
+        fileIOPermission->Assert(); // BlessedAssert
+
+        try
+        {
+            FileInfo^ file = gcnew FileInfo(uri->LocalPath);
+
+            if (! file->Exists || file->Length >= MaximumStreamLength)
+            {
+                return nullptr;
+            }
+
+            lastWriteTime = file->LastWriteTimeUtc;
+            fileLength = (int)file->Length;
+
+            if (_streamLength == 0)
+            {
+                _streamLength = fileLength;
+            }
+        }
+        finally
+        {
+            fileIOPermission->RevertAssert();
+        }
+    }
+
+    FontIdentity^ identity = nullptr;
+
+    // Only font files can be checked for changes, so only they are shared through the cache.
+    // A pack or other stream URI may refer to different fonts over the life of the process.
+    if (uri->IsFile)
+    {
+        System::Threading::Monitor::Enter(s_identities);
+        try
+        {
+            if (s_identities->TryGetValue(key, identity) &&
+                (identity->LastWriteTime != lastWriteTime ||
+                 identity->StreamLength != fileLength))
+            {
+                // font file changed since it was hashed
+                identity = nullptr;
+            }
+        }
+        finally
+        {
+            System::Threading::Monitor::Exit(s_identities);
+        }
+    }
+
+    if (identity == nullptr)
+    {
+        UpdateStreamLength();
+
+        Stream^ stream = GetStream();
+
+        if (stream == nullptr || _streamLength >= MaximumStreamLength)
+        {
+            return nullptr;
+        }
+
+        System::Security::Cryptography::SHA256^ sha = nullptr;
+
+        try
+        {
+            sha = System::Security::Cryptography::SHA256::Create();
+        }
+        // With FIPS policy enforced the default SHA-256 implementation is not allowed. Create
+        // reports that by wrapping the InvalidOperationException thrown by its constructor.
+        // Fall back to comparing stream data in every case.
+        catch (InvalidOperationException^)
+        {
+            return nullptr;
+        }
+        catch (System::Reflection::TargetInvocationException^)
+        {
+            return nullptr;
+        }
+        catch (System::Security::Cryptography::CryptographicException^)
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            identity = gcnew FontIdentity(_streamLength, lastWriteTime, sha->ComputeHash(stream));
+        }
+        finally
+        {
+            sha->Clear();
+        }
+
+        if (uri->IsFile)
+        {
+            System::Threading::Monitor::Enter(s_identities);
+            try
+            {
+                if (s_identities->Count >= MaximumIdentityCount)
+                {
+                    s_identities->Clear();
+                }
+
+                s_identities[key] = identity;
+            }
+            finally
+            {
+                System::Threading::Monitor::Exit(s_identities);
+            }
+        }
+    }
+
+    _identity = identity;
+
+    return identity;
+}
+
 bool FontStreamContext::Equals(FontStreamContext% otherContext)
 {
+    // compare content identities when both are available; computing one reads the stream
+    // only the first time the font is seen in this process
+    FontIdentity^ thisIdentity = GetIdentity();
+
+    if (thisIdentity != nullptr)
+    {
+        FontIdentity^ otherIdentity = otherContext.GetIdentity();
+
+        if (otherIdentity != nullptr)
+        {
+            return thisIdentity->Matches(otherIdentity);
+        }
+    }
+
     // make sure stream lengths are valid for comparison
     UpdateStreamLength();
     otherContext.UpdateStreamLength();
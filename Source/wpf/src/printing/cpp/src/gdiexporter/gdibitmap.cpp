@@ -1,130 +1,174 @@
+// Collects the distinct colors of a 24/32bpp bitmap, up to 256 of them, in an
+// open-addressed hash table, and the 8bpp indexed bitmap of the pixels in the
+// same pass.  The caller drops the sorter, and the indices with it, as soon as
+// a scanline does not fit in the palette.
 ref class PaletteSorter
 {
 public:
-    PaletteSorter()
+    PaletteSorter(int width, int height)
     {
-        Size      = 256;
-    //  IndexUsed = 0;
-        ColorTable = gcnew array<COLORREF>(Size);
+        Size        = 256;
+    //  IndexUsed   = 0;
+        ColorTable  = gcnew array<COLORREF>(Size);
+        Slots       = gcnew array<int>(HashSize);
+        IndexStride = GetDIBStride(width, 8);
+        Indices     = gcnew array<BYTE>(IndexStride * height);
     }
 
-    bool AddColor(COLORREF color);
-    
-    int Find(COLORREF color)
-    {
-        int slot = Search(0, IndexUsed - 1, color);
-
-        if (slot >= IndexUsed)
-        {
-            return -1;
-        }
-        else
-        {
-            return slot;
-        }
-    }
+    // Returns the palette index of color, adding it if needed.
+    // Returns -1 if palette is more than 256 colors
+    int AddColor(COLORREF color);
 
-    bool ProcessScanline(array<BYTE>^ scan, int offset, int width, int pixelsize);
+    // Adds the colors of scanline y and stores their palette indices in Indices.
+    bool ProcessScanline(array<BYTE>^ scan, int offset, int width, int pixelsize, int y);
 
 protected:
-    int  Search(int start, int end, COLORREF color);
+    // Twice the palette size keeps probe sequences short.
+    static const int HashSize = 512;
+
+    static int Hash(COLORREF color)
+    {
+        return (int) ((color * 2654435761u) >> 23);
+    }
 
     int      Size;
 
+    // Palette index + 1 of the color hashed to each slot, 0 for empty slots.
+    array<int> ^Slots;
+
 public:
     array<COLORREF> ^ColorTable;
     int      IndexUsed;
+
+    // Top-down 8bpp bitmap of palette indices
+    array<BYTE> ^Indices;
+    int      IndexStride;
 };
 
 
-// Return false if palette is more than 256 colors
-bool PaletteSorter::AddColor(COLORREF color)
+int PaletteSorter::AddColor(COLORREF color)
 {
-    int slot = Search(0, IndexUsed - 1, color);
+    int slot = Hash(color);
 
-    if (slot >= Size)
-    {
-        return false;
-    }
-    else 
+    for (;;)
     {
-        if ((slot >= IndexUsed) || (ColorTable[slot] != color))
+        int entry = Slots[slot];
+
+        if (entry == 0)
         {
-            // Move all the entries above the index specified up by one slot
-            for (int i = IndexUsed; i > slot; i --)
+            if (IndexUsed == Size)
             {
-                ColorTable[i] = ColorTable[i - 1];
+                return -1;
             }
 
-            ColorTable[slot] = color;
-    
+            ColorTable[IndexUsed] = color;
             IndexUsed ++;
+
+            Slots[slot] = IndexUsed;
+
+            return IndexUsed - 1;
         }
 
-        return true;
+        if (ColorTable[entry - 1] == color)
+        {
+            return entry - 1;
+        }
+
+        slot = (slot + 1) & (HashSize - 1);
     }
 }
 
-
-// Binary search using COLORREF
-int PaletteSorter::Search(int start, int end, COLORREF color)
+// Return false if more than 256 colors
+bool PaletteSorter::ProcessScanline(array<BYTE>^ scan, int offset, int width, int pixelsize, int y)
 {
-    for (;;)
+    int dst = IndexStride * y;
+
+    // Scanned and rendered images are mostly runs of identical pixels, so only
+    // look up a pixel whose color differs from the one before it.
+    COLORREF lastColor = 0;
+    int      lastIndex = -1;
+
+    while (width > 0)
     {
-        Debug::Assert((start >= 0) && (end < IndexUsed));
+        COLORREF color = RGB(scan[offset + 2], scan[offset + 1], scan[offset]);
 
-        // Break condition
-        if (start > end)
+        if ((lastIndex < 0) || (color != lastColor))
         {
-            if (IndexUsed == Size) // Missing in full color table
-            {
-                return Size;
-            }
+            lastIndex = AddColor(color);
 
-            // If we are at the end of the table, then we might have to insert
-            // in a position that's after.
-            if ((start == IndexUsed - 1) && ColorTable[start] < color)
-            {
-                return start + 1;
-            }
-            else
+            if (lastIndex < 0)
             {
-                return start;
+                return false;
             }
-        }
 
-        int middle = (start + end) / 2;
-        
-        if (ColorTable[middle] == color)
-        {
-            return middle;
-        }
-        else if (color < ColorTable[middle])
-        {
-            end = middle - 1;
-        }
-        else
-        {
-            start = middle + 1;
+            lastColor = color;
         }
+
+        Indices[dst] = (BYTE) lastIndex;
+
+        offset += pixelsize;
+        dst ++;
+        width --;
     }
+
+    return true;
 }
 
-// Return false if more than 256 colors
-bool PaletteSorter::ProcessScanline(array<BYTE>^ scan, int offset, int width, int pixelsize)
+/// <SecurityNote>
+///  Critical: Unverifiable code dereferences pointer
+/// </SecurityNote>
+[SecurityCritical]
+void PackIndices1bpp(interior_ptr<BYTE> src, interior_ptr<BYTE> dst, int width)
 {
-    while (width > 0)
+    int w = 0;
+
+    // Eight pixels per byte, most significant bit first
+    for (; w + 8 <= width; w += 8)
     {
-        if (! AddColor(RGB(scan[offset + 2], scan[offset + 1], scan[offset])))
+        dst[0] = (BYTE) ((src[0] << 7) | (src[1] << 6) | (src[2] << 5) | (src[3] << 4) |
+                         (src[4] << 3) | (src[5] << 2) | (src[6] << 1) |  src[7]);
+
+        src += 8;
+        dst ++;
+    }
+
+    if (w < width)
+    {
+        BYTE bits = 0;
+        BYTE mask = 0x80;
+
+        for (; w < width; w ++)
         {
-            return false;
+            bits |= mask * src[0];
+            mask >>= 1;
+            src ++;
         }
 
-        offset += pixelsize;
-        width --;
+        dst[0] = bits;
     }
+}
 
-    return true;
+/// <SecurityNote>
+///  Critical: Unverifiable code dereferences pointer
+/// </SecurityNote>
+[SecurityCritical]
+void PackIndices4bpp(interior_ptr<BYTE> src, interior_ptr<BYTE> dst, int width)
+{
+    int w = 0;
+
+    // Two pixels per byte, high nibble first
+    for (; w + 2 <= width; w += 2)
+    {
+        dst[0] = (BYTE) ((src[0] << 4) | src[1]);
+
+        src += 2;
+        dst ++;
+    }
+
+    if (w < width)
+    {
+        dst[0] = (BYTE) (src[0] << 4);
+    }
 }
 
 /// <SecurityNote>
@@ -266,74 +310,32 @@ HRESULT CGDIBitmap::ColorReduction()
     }
 
     // new buffer is top-down
-    int stride = GetDIBStride(m_Width, bpp);
-    array<Byte> ^ nuBuffer = gcnew array<Byte>(stride * m_Height);
+    int stride;
+    array<Byte> ^ nuBuffer;
 
-    int pixelSize = m_PixelFormat.BitsPerPixel / 8;
-    
-    for (int h = 0; h < m_Height; h ++)
+    if (bpp == 8)
+    {
+        // The sorter has already built the 8bpp bitmap
+        stride   = m_pSorter->IndexStride;
+        nuBuffer = m_pSorter->Indices;
+    }
+    else
     {
-        interior_ptr<BYTE> src = & m_Buffer[m_Offset + m_Stride * h];
-        interior_ptr<BYTE> dst = & nuBuffer[           stride   * h];
+        stride   = GetDIBStride(m_Width, bpp);
+        nuBuffer = gcnew array<Byte>(stride * m_Height);
 
-        if (bpp == 1)
+        for (int h = 0; h < m_Height; h ++)
         {
-            Byte mask = 0x80;
+            interior_ptr<BYTE> src = & m_pSorter->Indices[m_pSorter->IndexStride * h];
+            interior_ptr<BYTE> dst = & nuBuffer[stride * h];
 
-            for (int w = 0; w < m_Width; w ++)
+            if (bpp == 1)
             {
-                int index = m_pSorter->Find(RGB(src[2], src[1], src[0]));
-
-                Debug::Assert(index < 2);
-                
-                dst[0] |= mask * index;
-        
-                mask >>= 1;
-
-                if (mask == 0)
-                {
-                    mask = 0x80;
-                    dst ++;
-                }
-
-                src += pixelSize;
+                PackIndices1bpp(src, dst, m_Width);
             }
-        }
-        else if (bpp == 4)
-        {
-            for (int w = 0; w < m_Width; w ++)
-            {
-                int index = m_pSorter->Find(RGB(src[2], src[1], src[0]));
-
-                Debug::Assert(index < 16);
-            
-                if (w & 1)
-                {
-                    dst[0] |= (Byte) index;
-                    dst ++;
-                }
-                else
-                {
-                    dst[0] = (Byte) (index * 16);
-                }
-
-                src += pixelSize;
-            }
-        }
-        else
-        {
-            Debug::Assert(bpp == 8);
-
-            for (int w = 0; w < m_Width; w ++)
+            else
             {
-                int index = m_pSorter->Find(RGB(src[2], src[1], src[0]));
-
-                Debug::Assert(index < 256);
-            
-                dst[0] = (BYTE) index;
-    
-                src += pixelSize;
-                dst ++;
+                PackIndices4bpp(src, dst, m_Width);
             }
         }
     }
@@ -354,6 +356,9 @@ HRESULT CGDIBitmap::ColorReduction()
         SetQuad(bmi, i, GetRValue(c), GetGValue(c), GetBValue(c));
     }
 
+    // The indices are now in m_Buffer, or packed into it
+    m_pSorter = nullptr;
+
     return S_OK;
 }
 
@@ -744,20 +749,18 @@ HRESULT CGDIBitmap::Load(BitmapSource ^ pBitmap, array<Byte>^ buffer, PixelForma
 
         if ((int)((newSize + 256 * sizeof(RGBQUAD))) < orgSize)
         {
-            m_pSorter = gcnew PaletteSorter();
+            m_pSorter = gcnew PaletteSorter(m_Width, m_Height);
 
             for (int y = 0; y < m_Height; y ++)
             {
                 int offset = m_Offset + y * m_Stride;
 
-                if (m_pSorter != nullptr)
+                // m_Buffer is passed to m_pSorter, which is marked as SecurityCritical
+                if (! m_pSorter->ProcessScanline(m_Buffer, offset, m_Width, bpp / 8, y))
                 {
-                    // m_Buffer is passed to m_pSorter, which is marked as SecurityCritical
-                    if (! m_pSorter->ProcessScanline(m_Buffer, offset, m_Width, bpp / 8))
-                    {
-                        // Get rid of palette sorter if more than 256 colors
-                        m_pSorter = nullptr;
-                    }
+                    // Get rid of palette sorter if more than 256 colors
+                    m_pSorter = nullptr;
+                    break;
                 }
             }
         }
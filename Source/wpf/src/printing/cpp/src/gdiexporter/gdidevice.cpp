@@ -456,23 +456,7 @@ HRESULT CGDIDevice::HrEndPage(void)
     m_lastBrush = nullptr;
     m_lastPen   = nullptr;
 
-    if (m_Cache != nullptr)
-    {
-        for (int i = 0; i < m_Cache->Length; i ++)
-        {
-            if (m_Cache[i] != nullptr)
-            {
-                GdiSafeHandle ^old = m_Cache[i]->Handle;
-
-                if(old != nullptr && !old->IsInvalid) 
-                {
-                    old->Close();
-                }
-
-                m_Cache[i] = nullptr;
-            }
-        }
-    }
+    CacheClear();
 
     return hr;
 }
@@ -658,6 +658,7 @@ CGDIPath::CGDIPath(
     m_DeviceBounds.Width  = 0;
     m_DeviceBounds.Height = 0;
     m_ResolutionScale     = 1;
+    m_StrokeInflate       = 0;
 
     // Convert Geometry to GDI point data.
     GdiGeometryConverter^ converter = GdiGeometryConverter::Convert(geometry, matrix, !ForFill);
@@ -677,6 +678,14 @@ CGDIPath::CGDIPath(
     m_Types    = converter->Types;
     m_HasCurve = geometry.MayHaveCurves();
     m_ResolutionScale = converter->ResolutionScale;
+
+    if (! ForFill)
+    {
+        // Half the pen width, extended by the longest miter and scaled to device space
+        double scale = Math::Max(Math::Abs(matrix.M11) + Math::Abs(matrix.M21), Math::Abs(matrix.M12) + Math::Abs(matrix.M22));
+
+        m_StrokeInflate = (int) Math::Ceiling(pPen->Thickness / 2 * Math::Max(pPen->MiterLimit, 1.0) * scale * m_ResolutionScale) + m_ResolutionScale;
+    }
     
     int count = converter->PointCount;
 
@@ -723,9 +732,6 @@ void CGDIPath::ProcessPolygon(int count, bool ForFill, int figureCount)
         
         if (allline)
         {
-            // put transformed points into the Points array and get the device bounds.
-            GetDeviceBounds(m_Points, count);
-            
             m_NumPoints   = count;
             m_NumPolygons = 1;
 
@@ -737,6 +743,11 @@ void CGDIPath::ProcessPolygon(int count, bool ForFill, int figureCount)
             {
                 m_Flags |= IsClosedPolygon;
             }
+
+            SimplifyPolygons(ForFill);
+
+            // get the device bounds of the transformed points.
+            GetDeviceBounds(m_Points, m_NumPoints);
             
             m_IsValid = true;
             return;
@@ -810,15 +821,168 @@ void CGDIPath::ProcessPolygon(int count, bool ForFill, int figureCount)
     
     m_PolyCounts[iPolygon] = count - iStartPoint;
     m_NumPolygons = iPolygon + 1;
+    m_NumPoints = count;
+
+    SimplifyPolygons(ForFill);
 
     // Get the device bounds.
-    GetDeviceBounds(m_Points, count);
-    m_NumPoints = count;
+    GetDeviceBounds(m_Points, m_NumPoints);
     
     m_IsValid = true;
 }
 
 
+// Polygons with fewer points are left alone
+const int c_SIMPLIFYMINPOINTS = 8;
+
+// Longest run of points replaced by a single segment, to keep the cost linear
+const int c_SIMPLIFYMAXRUN    = 64;
+
+// Is point p within tolerance of the segment from a to b?
+inline bool NearSegment(PointI% p, PointI% a, PointI% b, double tolerance)
+{
+    double dx  = b.x - a.x;
+    double dy  = b.y - a.y;
+    double px  = p.x - a.x;
+    double py  = p.y - a.y;
+    double len = dx * dx + dy * dy;
+
+    if (len == 0)
+    {
+        return (px * px + py * py) <= tolerance * tolerance;
+    }
+
+    // p must project onto the segment, so that collinear spikes are kept
+    double dot = px * dx + py * dy;
+
+    if ((dot < 0) || (dot > len))
+    {
+        return false;
+    }
+
+    double cross = dx * py - dy * px;
+
+    return (cross * cross) <= (tolerance * tolerance * len);
+}
+
+
+// Removes polygon points that are within half a device pixel of the line through their
+// neighbours. Map and CAD geometry often has thousands of such points per figure, which
+// GDI and the printer driver would otherwise have to process one by one.
+void CGDIPath::SimplifyPolygons(bool ForFill)
+{
+    if (m_NumPoints < c_SIMPLIFYMINPOINTS)
+    {
+        return;
+    }
+
+    int total = 0;
+
+    for (int iPolygon = 0; iPolygon < m_NumPolygons; iPolygon++)
+    {
+        total += m_PolyCounts[iPolygon];
+    }
+
+    if (total != m_NumPoints)
+    {
+        // polygons are not laid out back to back
+        return;
+    }
+
+    double tolerance = 0.5 * m_ResolutionScale;
+
+    array<int>^ keep = gcnew array<int>(m_NumPoints);
+
+    int read  = 0;      // start of current polygon in the original points
+    int write = 0;      // start of current polygon in the simplified points
+
+    for (int iPolygon = 0; iPolygon < m_NumPolygons; iPolygon++)
+    {
+        int count = m_PolyCounts[iPolygon];
+        int kept  = 0;
+
+        if (count < c_SIMPLIFYMINPOINTS)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                keep[kept++] = read + i;
+            }
+        }
+        else
+        {
+            int anchor = read;          // last point kept
+            int last   = read + count - 1;
+
+            keep[kept++] = anchor;
+
+            for (int i = read + 1; i < last; i++)
+            {
+                // Drop point i if it, and every point dropped since the anchor, is close to
+                // the segment from the anchor to point i + 1.
+                bool drop = (i - anchor) < c_SIMPLIFYMAXRUN;
+
+                for (int j = anchor + 1; drop && (j <= i); j++)
+                {
+                    drop = NearSegment(m_Points[j], m_Points[anchor], m_Points[i + 1], tolerance);
+                }
+
+                if (! drop)
+                {
+                    keep[kept++] = i;
+                    anchor = i;
+                }
+            }
+
+            keep[kept++] = last;
+
+            // Don't let small closed shapes (dots, markers) collapse to a line
+            if ((kept < 3) && (ForFill || (m_Flags & IsClosedPolygon)))
+            {
+                kept = 0;
+
+                for (int i = 0; i < count; i++)
+                {
+                    keep[kept++] = read + i;
+                }
+            }
+        }
+
+        // Compact in place; write never passes the points still to be read.
+        for (int i = 0; i < kept; i++)
+        {
+            m_Points[write + i] = m_Points[keep[i]];
+            m_Types[write + i]  = m_Types[keep[i]];
+        }
+
+        m_PolyCounts[iPolygon] = kept;
+
+        read  += count;
+        write += kept;
+    }
+
+    m_NumPoints = write;
+}
+
+
+// Is the path entirely outside the current clip region?
+bool CGDIPath::IsClippedOut(CGDIDevice ^ dc)
+{
+    if (! dc->HasDC)
+    {
+        return false;
+    }
+
+    int scale = m_ResolutionScale;
+
+    int left   = (m_DeviceBounds.X - m_StrokeInflate) / scale - 1;
+    int top    = (m_DeviceBounds.Y - m_StrokeInflate) / scale - 1;
+    int right  = (m_DeviceBounds.X + m_DeviceBounds.Width  + m_StrokeInflate) / scale + 1;
+    int bottom = (m_DeviceBounds.Y + m_DeviceBounds.Height + m_StrokeInflate) / scale + 1;
+
+    return ! dc->RectVisible(left, top, right, bottom);
+}
+
+
 void CGDIPath::ProcessCurve(int count, bool ForFill)
 {
     // Getthe device bounds.
@@ -898,7 +1062,7 @@ HRESULT CGDIPath::Fill(CGDIDevice ^ dc, GdiSafeHandle^ brush)
 
     HRESULT hr = S_OK;
 
-    if (m_NumPoints > 0)
+    if ((m_NumPoints > 0) && ! IsClippedOut(dc))
     {
         XFORM oldTransform;
         dc->SetupForIncreasedResolution(m_ResolutionScale, OUT oldTransform);
@@ -987,7 +1151,7 @@ HRESULT CGDIPath::Draw(CGDIDevice ^ dc, GdiSafeHandle ^ pen)
 
     HRESULT hr = S_OK;
 
-    if (m_NumPoints > 0)
+    if ((m_NumPoints > 0) && ! IsClippedOut(dc))
     {
         XFORM oldTransform;
         dc->SetupForIncreasedResolution(m_ResolutionScale, OUT oldTransform);
@@ -1084,6 +1248,70 @@ HRESULT CGDIPath::Draw(CGDIDevice ^ dc, GdiSafeHandle ^ pen)
 }
 
 
+HRESULT CGDIPath::FillMerged(CGDIDevice ^ dc, GdiSafeHandle^ brush, List<CGDIPath^>^ paths)
+{
+    Debug::Assert(brush != nullptr);
+    Debug::Assert(paths->Count > 0);
+
+    if (paths->Count == 1)
+    {
+        return paths[0]->Fill(dc, brush);
+    }
+
+    int numPoints   = 0;
+    int numPolygons = 0;
+
+    for each (CGDIPath^ path in paths)
+    {
+        Debug::Assert(path->CanMerge());
+
+        numPoints   += path->m_NumPoints;
+        numPolygons += path->m_NumPolygons;
+    }
+
+    array<PointI>^       points = gcnew array<PointI>(numPoints);
+    array<unsigned int>^ counts = gcnew array<unsigned int>(numPolygons);
+
+    numPoints   = 0;
+    numPolygons = 0;
+
+    for each (CGDIPath^ path in paths)
+    {
+        Array::Copy(path->m_Points, 0, points, numPoints, path->m_NumPoints);
+        Array::Copy(path->m_PolyCounts, 0, counts, numPolygons, path->m_NumPolygons);
+
+        numPoints   += path->m_NumPoints;
+        numPolygons += path->m_NumPolygons;
+    }
+
+    HRESULT hr = S_OK;
+
+    dc->SelectObject(brush, OBJ_BRUSH);
+    dc->SelectObject(dc->m_nullPen, OBJ_PEN);
+    dc->SetPolyFillMode(paths[0]->m_PathFillMode);
+
+    if (! (dc->GetCaps() & CAP_PolyPolygon))
+    {
+        int offset = 0;
+
+        for (int i = 0; i < numPolygons && SUCCEEDED(hr); i ++)
+        {
+            hr = dc->Polygon(points, offset, counts[i]);
+            offset += counts[i];
+        }
+    }
+    else
+    {
+        CPolyPolygon poly;
+
+        poly.Set(points, 0, counts, 0, numPolygons);
+        hr = poly.Draw(dc);
+    }
+
+    return hr;
+}
+
+
 HRESULT CGDIPath::SelectClip(CGDIDevice ^ dc, int mode)
 {
     Debug::Assert(IsValid());
@@ -1404,7 +1632,7 @@ void CPolyPolygon::Divide(
             num = m_cPolygons - n * part;
         }
 
-        pPolygons[n]->Set(m_rgptVertex, m_offsetP + offsetP, m_rgcPoly, n * part, num);
+        pPolygons[n]->Set(m_rgptVertex, m_offsetP + offsetP, m_rgcPoly, m_offsetC + n * part, num);
         pPolygons[n]->GetBounds();
 
         if (n != (cGroup - 1))
@@ -1517,6 +1745,16 @@ CPolyPolygon::Draw(
 
             for (int i = 0; i < c_GROUPS && SUCCEEDED(hr); i++) // recursive for each group
             {
+                // skip groups entirely outside the clip region
+                if (dc->HasDC &&
+                    ! dc->RectVisible(rgRegion[i]->m_topleft.x,
+                                      rgRegion[i]->m_topleft.y,
+                                      rgRegion[i]->m_bottomright.x + 1,
+                                      rgRegion[i]->m_bottomright.y + 1))
+                {
+                    continue;
+                }
+
                 hr = rgRegion[i]->Draw(dc);
             }
 
@@ -312,6 +312,8 @@ void CGDIRenderTarget::EndPage()
 
     Debug::Assert(m_startPage, "StartPage has not been called yet (EndPage).");
 
+    ThrowOnFailure(FlushFills());
+
     PopTransform();
 
     m_startPage = false;
@@ -358,6 +360,8 @@ void CGDIRenderTarget::PopClip()
 
     Debug::Assert(m_startPage, "StartPage has not been called yet (Pop).");
 
+    ThrowOnFailure(FlushFills());
+
     if (m_state->Count <= 0)
     {
         throw gcnew InvalidOperationException();
@@ -476,6 +480,8 @@ void CGDIRenderTarget::DrawGlyphRun(Brush ^pBrush, GlyphRun^ glyphRun)
         return;
     }
 
+    ThrowOnFailure(FlushFills());
+
     HRESULT hr = RenderTextThroughGDI(glyphRun, pBrush);
 
     if (hr == E_NOTIMPL)
@@ -524,6 +530,8 @@ void CGDIRenderTarget::Comment(String ^ comment)
 
     if (comment != nullptr)
     {
+        ThrowOnFailure(FlushFills());
+
         IntPtr pComment = Marshal::StringToCoTaskMemAnsi(comment);
 
         try
@@ -36,21 +36,45 @@ void GenerateGradientBandTriangles(
     int vertexOffset
     );
 
-GdiSafeHandle^ CGDIDevice::CacheMatch(const interior_ptr<Byte> pData, int size)
+// Maximum number of cached GDI objects of each CachedObjectType, indexed by type.
+// Brushes and pens are small solid-color objects; fonts cost the most to keep alive.
+static const int CacheCapacity[CachedObjectTypeCount] = { 64, 64, 16 };
+
+static const int CacheBucketCount = 256;
+
+
+GdiSafeHandle^ CGDIDevice::CacheMatch(CachedObjectType type, const interior_ptr<Byte> pData, int size)
 {
     if (m_Cache == nullptr)
     {
         return nullptr;
     }
 
-    for (int i = 0; i < m_Cache->Length; i ++)
+    m_CacheLookups[type] ++;
+
+    int hash = CachedGDIObject::Hash(pData, size);
+
+    for (CachedGDIObject ^ entry = m_Cache[hash % CacheBucketCount]; entry != nullptr; entry = entry->m_NextInBucket)
     {
-        if (m_Cache[i] != nullptr)
+        if ((entry->m_Hash == hash) && (entry->m_Type == type))
         {
-            GdiSafeHandle^ result = m_Cache[i]->Match(pData, size);
+            GdiSafeHandle^ result = entry->Match(pData, size);
 
             if (result != nullptr)
             {
+                m_CacheHits[type] ++;
+
+                // Move to the front of the LRU list
+                if (m_CacheNewest[type] != entry)
+                {
+                    CacheUnlink(entry);
+
+                    entry->m_Older = m_CacheNewest[type];
+                    m_CacheNewest[type]->m_Newer = entry;
+                    m_CacheNewest[type] = entry;
+                    m_CacheCount[type] ++;
+                }
+
                 return result;
             }
         }
@@ -60,30 +84,150 @@ GdiSafeHandle^ CGDIDevice::CacheMatch(const interior_ptr<Byte> pData, int size)
 }
 
 
-void CGDIDevice::CacheObject(interior_ptr<Byte> pData, int size, GdiSafeHandle^ handle)
+// Removes an entry from the LRU list of its type. The bucket chain is left alone.
+void CGDIDevice::CacheUnlink(CachedGDIObject ^ entry)
+{
+    CachedObjectType type = entry->m_Type;
+
+    if (entry->m_Newer != nullptr)
+    {
+        entry->m_Newer->m_Older = entry->m_Older;
+    }
+    else
+    {
+        m_CacheNewest[type] = entry->m_Older;
+    }
+
+    if (entry->m_Older != nullptr)
+    {
+        entry->m_Older->m_Newer = entry->m_Newer;
+    }
+    else
+    {
+        m_CacheOldest[type] = entry->m_Newer;
+    }
+
+    entry->m_Newer = nullptr;
+    entry->m_Older = nullptr;
+
+    m_CacheCount[type] --;
+}
+
+
+void CGDIDevice::CacheObject(CachedObjectType type, interior_ptr<Byte> pData, int size, GdiSafeHandle^ handle)
 {
     if (m_Cache != nullptr)
     {
-        // Find an empty slot
-        while (m_Cache[m_CacheFirst] != nullptr)
+        if (m_CacheCount[type] >= CacheCapacity[type])
         {
-            GdiSafeHandle ^old = m_Cache[m_CacheFirst]->Handle;
+            // Evict the least recently used object of this type that is not selected into the DC
+            CachedGDIObject ^ victim = m_CacheOldest[type];
 
-            if ((old != m_lastFont) && (old != m_lastBrush) && (old != m_lastPen))
+            while (victim != nullptr)
             {
+                GdiSafeHandle ^old = victim->Handle;
+
+                if ((old != m_lastFont) && (old != m_lastBrush) && (old != m_lastPen))
+                {
+                    break;
+                }
+
+                victim = victim->m_Newer;
+            }
+
+            if (victim != nullptr)
+            {
+                CacheUnlink(victim);
+
+                int bucket = victim->m_Hash % CacheBucketCount;
+
+                if (m_Cache[bucket] == victim)
+                {
+                    m_Cache[bucket] = victim->m_NextInBucket;
+                }
+                else
+                {
+                    CachedGDIObject ^ prev = m_Cache[bucket];
+
+                    while (prev->m_NextInBucket != victim)
+                    {
+                        prev = prev->m_NextInBucket;
+                    }
+
+                    prev->m_NextInBucket = victim->m_NextInBucket;
+                }
+
                 // Release corresponding GDI object ASAP if it's not needed to reduce active GDI object count
-            
+                victim->Handle->Close();
+            }
+        }
+
+        int hash = CachedGDIObject::Hash(pData, size);
+        int bucket = hash % CacheBucketCount;
+
+        CachedGDIObject ^ entry = gcnew CachedGDIObject(pData, size, hash, type, handle);
+
+        entry->m_NextInBucket = m_Cache[bucket];
+        m_Cache[bucket] = entry;
+
+        entry->m_Older = m_CacheNewest[type];
+
+        if (m_CacheNewest[type] != nullptr)
+        {
+            m_CacheNewest[type]->m_Newer = entry;
+        }
+        else
+        {
+            m_CacheOldest[type] = entry;
+        }
+
+        m_CacheNewest[type] = entry;
+        m_CacheCount[type] ++;
+    }
+}
+
+
+void CGDIDevice::CacheClear()
+{
+    if (m_Cache == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < m_Cache->Length; i ++)
+    {
+        for (CachedGDIObject ^ entry = m_Cache[i]; entry != nullptr; entry = entry->m_NextInBucket)
+        {
+            GdiSafeHandle ^old = entry->Handle;
+
+            if(old != nullptr && !old->IsInvalid) 
+            {
                 old->Close();
-                m_Cache[m_CacheFirst] = nullptr;
-                break;
             }
+        }
+
+        m_Cache[i] = nullptr;
+    }
 
-            // Try next one
-            m_CacheFirst = (m_CacheFirst + 1) % m_Cache->Length;
+    for (int type = 0; type < CachedObjectTypeCount; type ++)
+    {
+#ifdef DBG
+        if (m_CacheLookups[type] != 0)
+        {
+            Debug::WriteLine(String::Format(
+                "GDI object cache type {0}: {1} hits in {2} lookups",
+                type,
+                m_CacheHits[type],
+                m_CacheLookups[type]
+                ));
         }
+#endif
 
-        m_Cache[m_CacheFirst] = gcnew CachedGDIObject(pData, size, handle);
-        m_CacheFirst = (m_CacheFirst + 1) % m_Cache->Length;
+        m_CacheNewest[type]  = nullptr;
+        m_CacheOldest[type]  = nullptr;
+        m_CacheCount[type]   = 0;
+        m_CacheLookups[type] = 0;
+        m_CacheHits[type]    = 0;
     }
 }
 
@@ -149,9 +293,13 @@ HRESULT CGDIRenderTarget::Initialize()
         // Page dimensions filled in StartPage.
         m_nWidth = m_nHeight = 0;
 
-        // Caching 32 GDI objects
-        m_Cache      = gcnew array<CachedGDIObject^>(32);
-        m_CacheFirst = 0;
+        // Caching up to CacheCapacity GDI objects of each type
+        m_Cache        = gcnew array<CachedGDIObject^>(CacheBucketCount);
+        m_CacheNewest  = gcnew array<CachedGDIObject^>(CachedObjectTypeCount);
+        m_CacheOldest  = gcnew array<CachedGDIObject^>(CachedObjectTypeCount);
+        m_CacheCount   = gcnew array<int>(CachedObjectTypeCount);
+        m_CacheLookups = gcnew array<int>(CachedObjectTypeCount);
+        m_CacheHits    = gcnew array<int>(CachedObjectTypeCount);
     }
 
     m_state = gcnew System::Collections::Stack();
@@ -162,6 +310,12 @@ HRESULT CGDIRenderTarget::Initialize()
 
     m_cachedUnstyledFontCharsets = gcnew System::Collections::Hashtable();
 
+    m_brushRasterCache       = gcnew Dictionary<String^, BitmapSource^>();
+    m_brushRasterCachePixels = 0;
+
+    m_pendingFills     = gcnew List<CGDIPath^>();
+    m_pendingFillColor = CLR_INVALID;
+
     return hr;
 }
 
@@ -415,6 +569,13 @@ HRESULT  CGDIRenderTarget::DrawBitmap(BitmapSource ^ pImage, array<Byte>^ buffer
     Debug::Assert(pImage != nullptr);
     Debug::Assert(!rectDest.IsEmpty);
 
+    HRESULT hr = FlushFills();
+
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
     // Compute destination bounding rectangle in measure units, then transform to device units.
     // Afterwards clip.
 
@@ -443,7 +604,7 @@ HRESULT  CGDIRenderTarget::DrawBitmap(BitmapSource ^ pImage, array<Byte>^ buffer
 //      return S_OK;
 //  }
 
-    HRESULT hr = E_NOTIMPL;
+    hr = E_NOTIMPL;
     
     if (buffer == nullptr)
     {
@@ -577,6 +738,8 @@ void CGDIRenderTarget::PushClipProxy(GeometryProxy% geometry)
     }
 
     Debug::Assert(m_startPage, "StartPage has not been called yet (PushClip).");
+
+    ThrowOnFailure(FlushFills());
     
     // remember devicetransform goes from avalon -> gdi coordinate space, hence the negative
     int physicalOffsetX =  -(int) m_DeviceTransform.OffsetX;
@@ -1131,7 +1294,14 @@ HRESULT CGDIRenderTarget::StrokePath(
         return S_OK;
     }
 
-    HRESULT hr = E_NOTIMPL;
+    HRESULT hr = FlushFills();
+
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    hr = E_NOTIMPL;
 
     CGDIPath ^ gdiPath = CGDIPath::CreateStrokePath(geometry, m_transform, pPen);
 
@@ -1272,19 +1442,53 @@ HRESULT CGDIRenderTarget::FillPath(
     // Quit if the drawbounds are outside the clip region
 //  if (! Invisible(m_clip, & drawbounds))
     {
-        hr = E_NOTIMPL;
+        // Solid fills may be merged with the pending ones, which must be flushed
+        // before anything of another color is drawn.
+        SolidColorBrush^ solid = dynamic_cast<SolidColorBrush^>(pFillBrush);
+        COLORREF color = (solid != nullptr) ? ToCOLORREF(solid) : 0;
+
+        if ((solid == nullptr) || (color != m_pendingFillColor))
+        {
+            hr = FlushFills();
+
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
 
         GdiSafeHandle^ brush = ConvertBrush(pFillBrush);
 
+        if (brush == nullptr)
+        {
+            // drawn below some other way
+            hr = FlushFills();
+
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        hr = E_NOTIMPL;
+
         if (brush != nullptr)
         {
             CGDIPath ^ gdiPath = CGDIPath::CreateFillPath(geometry, m_transform);
 
             Debug::Assert(gdiPath->IsValid(), "Invalid CGDIPath");
 
-            hr = gdiPath->Fill(this, brush);
-            
-            delete gdiPath;
+            if ((solid == nullptr) || ! QueueFill(gdiPath, brush, color, hr))
+            {
+                hr = FlushFills();
+
+                if (SUCCEEDED(hr))
+                {
+                    hr = gdiPath->Fill(this, brush);
+                }
+
+                delete gdiPath;
+            }
         }
         else if (GetCaps() & CAP_GradientRect)
         {
@@ -1302,6 +1506,84 @@ HRESULT CGDIRenderTarget::FillPath(
     return hr;
 }
 
+// Pending fills are merged into one PolyPolygon while they are disjoint, up to these limits
+const int c_MAXPENDINGFILLS      = 64;
+const int c_MAXPENDINGFILLPOINTS = 16 * 1024;
+
+bool CGDIRenderTarget::QueueFill(CGDIPath ^ path, GdiSafeHandle ^ brush, COLORREF color, HRESULT % hr)
+{
+    hr = S_OK;
+
+    if (! path->CanMerge())
+    {
+        return false;
+    }
+
+    if (path->IsClippedOut(this))
+    {
+        // nothing to draw
+        delete path;
+        return true;
+    }
+
+    Int32Rect bounds = path->GetBounds();
+
+    bool merge = (m_pendingFills->Count < c_MAXPENDINGFILLS) &&
+                 (m_pendingFillPoints + path->GetPointCount() <= c_MAXPENDINGFILLPOINTS) &&
+                 (m_pendingFills->Count == 0 || path->GetFillMode() == m_pendingFills[0]->GetFillMode());
+
+    for (int i = 0; merge && (i < m_pendingFills->Count); i++)
+    {
+        Int32Rect other = m_pendingFills[i]->GetBounds();
+
+        // Only disjoint fills can share a PolyPolygon; overlaps would be subject to its fill mode
+        merge = (bounds.X + bounds.Width  <= other.X) ||
+                (bounds.Y + bounds.Height <= other.Y) ||
+                (other.X  + other.Width   <= bounds.X) ||
+                (other.Y  + other.Height  <= bounds.Y);
+    }
+
+    if (! merge)
+    {
+        hr = FlushFills();
+
+        if (FAILED(hr))
+        {
+            return true;
+        }
+    }
+
+    m_pendingFills->Add(path);
+    m_pendingFillBrush   = brush;
+    m_pendingFillColor   = color;
+    m_pendingFillPoints += path->GetPointCount();
+
+    return true;
+}
+
+HRESULT CGDIRenderTarget::FlushFills()
+{
+    HRESULT hr = S_OK;
+
+    if ((m_pendingFills != nullptr) && (m_pendingFills->Count > 0))
+    {
+        hr = CGDIPath::FillMerged(this, m_pendingFillBrush, m_pendingFills);
+
+        for each (CGDIPath^ path in m_pendingFills)
+        {
+            delete path;
+        }
+
+        m_pendingFills->Clear();
+    }
+
+    m_pendingFillBrush  = nullptr;
+    m_pendingFillColor  = CLR_INVALID;
+    m_pendingFillPoints = 0;
+
+    return hr;
+}
+
 HRESULT CGDIRenderTarget::FillImage(
     IN GeometryProxy% geometry,
     IN ImageBrush^ brush
@@ -1810,6 +2092,82 @@ HRESULT CGDIRenderTarget::GetBrushScale(
     return S_OK;
 }
 
+void AppendMatrix(StringBuilder^ key, Transform^ transform)
+{
+    if (transform != nullptr)
+    {
+        Matrix mat = transform->Value;
+
+        key->AppendFormat("[{0:R},{1:R},{2:R},{3:R},{4:R},{5:R}]", mat.M11, mat.M12, mat.M21, mat.M22, mat.OffsetX, mat.OffsetY);
+    }
+}
+
+// Describes everything that determines the raster CreateBitmapAndFillWithBrush produces for a gradient brush.
+// Returns nullptr for other brushes, whose content (images, drawings, visuals) can't be described cheaply.
+String^ GetBrushRasterKey(
+    Brush ^ brush,
+    Rect    geometryBounds,
+    Matrix  transform,
+    int     bmpWidth,
+    int     bmpHeight
+    )
+{
+    GradientBrush^ gradient = dynamic_cast<GradientBrush^>(brush);
+
+    if ((gradient == nullptr) || (gradient->GradientStops == nullptr))
+    {
+        return nullptr;
+    }
+
+    StringBuilder^ key = gcnew StringBuilder();
+
+    key->AppendFormat("{0} {1}x{2} {3:R} {4} {5} {6}",
+        brush->GetType()->Name,
+        bmpWidth,
+        bmpHeight,
+        brush->Opacity,
+        (int) gradient->MappingMode,
+        (int) gradient->SpreadMethod,
+        (int) gradient->ColorInterpolationMode
+        );
+
+    key->AppendFormat(" {0:R},{1:R},{2:R},{3:R}", geometryBounds.X, geometryBounds.Y, geometryBounds.Width, geometryBounds.Height);
+    key->AppendFormat(" [{0:R},{1:R},{2:R},{3:R},{4:R},{5:R}]", transform.M11, transform.M12, transform.M21, transform.M22, transform.OffsetX, transform.OffsetY);
+
+    AppendMatrix(key, brush->Transform);
+    AppendMatrix(key, brush->RelativeTransform);
+
+    LinearGradientBrush^ linear = dynamic_cast<LinearGradientBrush^>(brush);
+    RadialGradientBrush^ radial = dynamic_cast<RadialGradientBrush^>(brush);
+
+    if (linear != nullptr)
+    {
+        key->AppendFormat(" {0:R},{1:R} {2:R},{3:R}", linear->StartPoint.X, linear->StartPoint.Y, linear->EndPoint.X, linear->EndPoint.Y);
+    }
+    else if (radial != nullptr)
+    {
+        key->AppendFormat(" {0:R},{1:R} {2:R},{3:R} {4:R} {5:R}",
+            radial->Center.X,
+            radial->Center.Y,
+            radial->GradientOrigin.X,
+            radial->GradientOrigin.Y,
+            radial->RadiusX,
+            radial->RadiusY
+            );
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    for each (GradientStop^ stop in gradient->GradientStops)
+    {
+        key->AppendFormat(" {0}@{1:R}", stop->Color, stop->Offset);
+    }
+
+    return key->ToString();
+}
+
 // Rasterize brush for area specified by pBounds, load into bmpdata
 HRESULT CGDIRenderTarget::RasterizeBrush(
     CGDIBitmap         % bmpdata,
@@ -1867,15 +2225,36 @@ HRESULT CGDIRenderTarget::RasterizeBrush(
     transform.Translate(-box.X, -box.Y);
     transform.Scale(bmpWidth / box.Width, bmpHeight / box.Height);
 
-    // rasterize
-    BitmapSource ^ pBrushRaster = 
-        CreateBitmapAndFillWithBrush(
-            bmpWidth,
-            bmpHeight,
-            pFillBrush,
-            geometryBounds,
-            gcnew MatrixTransform(transform),
-            PixelFormats::Pbgra32);
+    // rasterize, or reuse an identical raster made earlier in this job
+    String^ key = GetBrushRasterKey(pFillBrush, geometryBounds, transform, bmpWidth, bmpHeight);
+
+    BitmapSource ^ pBrushRaster = nullptr;
+
+    if ((key == nullptr) || ! m_brushRasterCache->TryGetValue(key, pBrushRaster))
+    {
+        pBrushRaster = 
+            CreateBitmapAndFillWithBrush(
+                bmpWidth,
+                bmpHeight,
+                pFillBrush,
+                geometryBounds,
+                gcnew MatrixTransform(transform),
+                PixelFormats::Pbgra32);
+
+        int pixels = bmpWidth * bmpHeight;
+
+        if ((key != nullptr) && (pixels <= RasterCachePixelLimit))
+        {
+            if (m_brushRasterCachePixels + pixels > RasterCachePixelLimit)
+            {
+                m_brushRasterCache->Clear();
+                m_brushRasterCachePixels = 0;
+            }
+
+            m_brushRasterCache[key]   = pBrushRaster;
+            m_brushRasterCachePixels += pixels;
+        }
+    }
 
     hr = bmpdata.Load(pBrushRaster, nullptr, PixelFormats::Bgr24);
 
@@ -1986,60 +2365,53 @@ HRESULT CGDIRenderTarget::RasterizeShape(
                 clipPushed = true;
             }
 
-            Int32Rect bandBounds = clippedBounds;
-
-            int bmpWidth  = (int) Math::Round(bandBounds.Width  / ScaleX);
-            int bmpHeight = (int) Math::Round(bandBounds.Height / ScaleY);
-
-            // Divide whole area into bands if the whole is too big (1600x1200 pixels)
-            int pixelLimit = RasterizeBandPixelLimit;
-
-            pixelLimit = (pixelLimit + bmpWidth - 1) / bmpWidth;
-
-            int nBands = (bmpHeight + pixelLimit - 1) / pixelLimit;
-
-            int nBandHeight = bandBounds.Height / nBands + 1;
-            int nRemain     = bandBounds.Height;
+            //
+            // Rasterize in tiles of RasterizeTileSize x RasterizeTileSize rasterization pixels.
+            // Tiles entirely outside the current clip region (including the clip just pushed
+            // for this geometry) are never rasterized.
+            //
+            // Tiny scales round the tile size down to 0, which would never advance the loops.
+            //
+            int tileWidth  = Math::Max(1, (int) Math::Round(RasterizeTileSize * ScaleX));
+            int tileHeight = Math::Max(1, (int) Math::Round(RasterizeTileSize * ScaleY));
 
-            bandBounds.Height = nBandHeight;
+            int right  = clippedBounds.X + clippedBounds.Width;
+            int bottom = clippedBounds.Y + clippedBounds.Height;
 
-            while (SUCCEEDED(hr) && nRemain)
+            for (int y = clippedBounds.Y; SUCCEEDED(hr) && (y < bottom); y += tileHeight)
             {
-                if (bandBounds.Height > nRemain)
-                {
-                    bandBounds.Height = nRemain;
-                }
-
-                hr = RasterizeBrush(
-                        bitmapdata,
-                        bandBounds,
-                        bounds,
-                        geometryBounds,
-                        pFillBrush,
-                        false,
-                        false,
-                        ScaleX,
-                        ScaleY
-                        );
-
-                if (SUCCEEDED(hr))
+                for (int x = clippedBounds.X; SUCCEEDED(hr) && (x < right); x += tileWidth)
                 {
-                    CGDIBitmap gdiBitmap(bitmapdata);
+                    Int32Rect tileBounds(x, y, Math::Min(tileWidth, right - x), Math::Min(tileHeight, bottom - y));
 
-                    if (gdiBitmap.IsValid())
+                    if (HasDC && ! RectVisible(x, y, x + tileBounds.Width, y + tileBounds.Height))
                     {
-                        // Perform StretchDIBits of bitmap
-                        hr = gdiBitmap.StretchBlt(this, bandBounds, false, false);
+                        continue;
                     }
-                }
 
-                nRemain -= bandBounds.Height;
-                bandBounds.Y += bandBounds.Height; // move to the next band
-            }
+                    hr = RasterizeBrush(
+                            bitmapdata,
+                            tileBounds,
+                            bounds,
+                            geometryBounds,
+                            pFillBrush,
+                            false,
+                            false,
+                            ScaleX,
+                            ScaleY
+                            );
+
+                    if (SUCCEEDED(hr))
+                    {
+                        CGDIBitmap gdiBitmap(bitmapdata);
 
-            if (SUCCEEDED(hr))
-            {
-                Debug::Assert(nRemain == 0);
+                        if (gdiBitmap.IsValid())
+                        {
+                            // Perform StretchDIBits of bitmap
+                            hr = gdiBitmap.StretchBlt(this, tileBounds, false, false);
+                        }
+                    }
+                }
             }
 
             if (clipPushed)
@@ -811,7 +811,7 @@ GdiSafeHandle^ CGDIRenderTarget::CreateFont(
 // Creates or retrieves a cached font, and caches it if needed.
 GdiSafeHandle^ CGDIRenderTarget::CreateFontCached(interior_ptr<ENUMLOGFONTEXDV> logfontdv)
 {
-    GdiSafeHandle^ result = CacheMatch((interior_ptr<Byte>) logfontdv, sizeof(ENUMLOGFONTEXDV));
+    GdiSafeHandle^ result = CacheMatch(CachedFont, (interior_ptr<Byte>) logfontdv, sizeof(ENUMLOGFONTEXDV));
     GdiSafeHandle^ firstAttempt = nullptr;
 
     if (result != nullptr)
@@ -892,7 +892,7 @@ GdiSafeHandle^ CGDIRenderTarget::CreateFontCached(interior_ptr<ENUMLOGFONTEXDV>
     {
         Debug::Assert(!result->IsClosed, "CreateFontCached must never return a closed handle");
         Debug::Assert(!result->IsInvalid, "CreateFontCached must never return an invalide handle");
-        CacheObject((interior_ptr<Byte>)&originalLogfontDv, sizeof(ENUMLOGFONTEXDV), result);
+        CacheObject(CachedFont, (interior_ptr<Byte>)&originalLogfontDv, sizeof(ENUMLOGFONTEXDV), result);
     }
 
     Debug::Assert(result != nullptr, "CreateFontCached must never return null");
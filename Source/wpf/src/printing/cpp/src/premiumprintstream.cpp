@@ -170,6 +170,7 @@ InitializePrintStream(
     // to succeed, which is considered Safe in PArtial Trust, once the dialog was opened.
     //
     accessVerifier = gcnew PrintSystemDispatcherObject();
+    pendingWrites = gcnew System::Collections::Generic::Queue<WritePrinterAsyncResult^>();
 
     if (printQueue->InPartialTrust)
     {
@@ -362,16 +363,177 @@ BeginWrite(
                                                           userCallBack,
                                                           stateObject);
 
-        Thread^ asyncWriteThread = gcnew Thread(gcnew ThreadStart(writeAsyncResult,
-                                                                &WritePrinterAsyncResult::AsyncWrite));
+        System::Threading::Monitor::Enter(pendingWrites);
 
-        asyncWriteThread->Start();
+        try
+        {
+            //
+            // Hold the caller while too much data is waiting to be written. The writer thread
+            // is never held, since it may be issuing the write from a completion callback.
+            //
+            while (pendingBytes >= MaximumPendingBytes &&
+                   writerScheduled &&
+                   Thread::CurrentThread != writerThread)
+            {
+                System::Threading::Monitor::Wait(pendingWrites);
+            }
+
+            pendingWrites->Enqueue(writeAsyncResult);
+            pendingBytes += numBytes;
+
+            if (!writerScheduled)
+            {
+                writerScheduled = true;
 
+                ThreadPool::QueueUserWorkItem(gcnew WaitCallback(this,
+                                                                 &PrintQueueStream::DrainAsyncWrites));
+            }
+        }
+        __finally
+        {
+            System::Threading::Monitor::Exit(pendingWrites);
+        }
     }
 
     return writeAsyncResult;
 }
 
+void
+PrintQueueStream::
+DrainAsyncWrites(
+    Object^ state
+    )
+{
+    System::Collections::Generic::List<WritePrinterAsyncResult^>^ batch =
+        gcnew System::Collections::Generic::List<WritePrinterAsyncResult^>();
+
+    for (;;)
+    {
+        Int32 batchBytes = 0;
+
+        System::Threading::Monitor::Enter(pendingWrites);
+
+        try
+        {
+            if (pendingWrites->Count == 0)
+            {
+                writerScheduled = false;
+                writerThread = nullptr;
+
+                System::Threading::Monitor::PulseAll(pendingWrites);
+
+                return;
+            }
+
+            writerThread = Thread::CurrentThread;
+
+            //
+            // Take the next write, along with the small writes following it that
+            // fit in coalesceBuffer with it.
+            //
+            batch->Add(pendingWrites->Dequeue());
+            batchBytes = batch[0]->Count;
+
+            while (pendingWrites->Count > 0 &&
+                   batchBytes + pendingWrites->Peek()->Count <= CoalesceLength)
+            {
+                WritePrinterAsyncResult^ next = pendingWrites->Dequeue();
+
+                batch->Add(next);
+                batchBytes += next->Count;
+            }
+        }
+        __finally
+        {
+            System::Threading::Monitor::Exit(pendingWrites);
+        }
+
+        Exception^ writeException = nullptr;
+
+        try
+        {
+            if (batch->Count == 1)
+            {
+                batch[0]->AsyncWrite();
+            }
+            else
+            {
+                if (coalesceBuffer == nullptr)
+                {
+                    coalesceBuffer = gcnew array<Byte>(CoalesceLength);
+                }
+
+                Int32 coalesced = 0;
+
+                for each (WritePrinterAsyncResult^ writeAsyncResult in batch)
+                {
+                    writeAsyncResult->CopyTo(coalesceBuffer, coalesced);
+                    coalesced += writeAsyncResult->Count;
+                }
+
+                //
+                // Written through Stream, as WritePrinterAsyncResult::AsyncWrite does.
+                //
+                Stream^ stream = this;
+
+                stream->Write(coalesceBuffer, 0, coalesced);
+            }
+        }
+        catch (Exception^ exception)
+        {
+            //
+            // Reported to the caller by EndWrite
+            //
+            writeException = exception;
+        }
+
+        System::Threading::Monitor::Enter(pendingWrites);
+
+        try
+        {
+            pendingBytes -= batchBytes;
+
+            System::Threading::Monitor::PulseAll(pendingWrites);
+        }
+        __finally
+        {
+            System::Threading::Monitor::Exit(pendingWrites);
+        }
+
+        for each (WritePrinterAsyncResult^ writeAsyncResult in batch)
+        {
+            writeAsyncResult->Complete(writeException);
+        }
+
+        batch->Clear();
+    }
+}
+
+void
+PrintQueueStream::
+WaitForAsyncWrites(
+    void
+    )
+{
+    if (pendingWrites != nullptr)
+    {
+        System::Threading::Monitor::Enter(pendingWrites);
+
+        try
+        {
+            while (writerScheduled &&
+                   Thread::CurrentThread != writerThread)
+            {
+                System::Threading::Monitor::Wait(pendingWrites);
+            }
+        }
+        __finally
+        {
+            System::Threading::Monitor::Exit(pendingWrites);
+        }
+    }
+}
+
 void
 PrintQueueStream::
 EndWrite(
@@ -390,6 +552,14 @@ EndWrite(
     else
     {
         asyncResult->AsyncWaitHandle->WaitOne();
+
+        WritePrinterAsyncResult^ writeAsyncResult = dynamic_cast<WritePrinterAsyncResult^>(asyncResult);
+
+        if (writeAsyncResult != nullptr &&
+            writeAsyncResult->WriteException != nullptr)
+        {
+            throw writeAsyncResult->WriteException;
+        }
     }
 }
 
@@ -418,6 +588,8 @@ Close(
     void
     )
 {
+    WaitForAsyncWrites();
+
     AbortOrCancel( streamAborted );
 }
 
@@ -611,6 +783,8 @@ PrintQueueStream::
 Flush(
     )
 {
+    WaitForAsyncWrites();
+
     if (!streamAborted)
     {
         printerThunkHandler->SpoolStream->Flush();
@@ -634,6 +808,8 @@ HandlePackagingProgressEvent(
     if (e->Action == PackagingAction::FixedPageCompleted &&
         commitStreamDataOnClose == false)
     {
+        WaitForAsyncWrites();
+
         CommitDataToPrinter();
     }
 
@@ -839,6 +1015,24 @@ get(
     return userCallBack;
 }
 
+Int32
+WritePrinterAsyncResult::Count::
+get(
+    void
+    )
+{
+    return numberOfBytes;
+}
+
+Exception^
+WritePrinterAsyncResult::WriteException::
+get(
+    void
+    )
+{
+    return writeException;
+}
+
 void
 WritePrinterAsyncResult::
 AsyncWrite(
@@ -848,6 +1042,29 @@ AsyncWrite(
     printStream->Write(this->dataArray,
                        this->dataOffset,
                        this->numberOfBytes);
+}
+
+void
+WritePrinterAsyncResult::
+CopyTo(
+    array<Byte>^    buffer,
+    Int32           offset
+    )
+{
+    Array::Copy(this->dataArray,
+                this->dataOffset,
+                buffer,
+                offset,
+                this->numberOfBytes);
+}
+
+void
+WritePrinterAsyncResult::
+Complete(
+    Exception^      exception
+    )
+{
+    this->writeException = exception;
 
     this->IsCompleted = true;
 